@@ -0,0 +1,14 @@
+# 检测/关闭延迟基准测试（仅 Linux）：jiyu-bench --sizes 100,1000,10000 --output result.json
+# 启动一批以目标映像名命名的占位进程，测量快照、匹配、终止到确认退出、整轮关闭的耗时以及守护模式轮询的稳态开销
+QT       = core
+CONFIG  += c++17 console
+CONFIG  -= app_bundle
+
+TARGET = jiyu-bench
+
+include(../engine.pri)
+
+SOURCES += \
+    main.cpp
+
+!linux: warning("jiyu-bench 目前只支持 Linux，其他平台运行时会直接退出")
@@ -0,0 +1,387 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QDeadlineTimer>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStandardPaths>
+#include <QSysInfo>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include "killprocessthread.h"
+#include "processsnapshot.h"
+#include "processterminator.h"
+#include "processwatchdog.h"
+#include "processwaiter.h"
+#include "targetcatalog.h"
+
+#if defined(Q_OS_LINUX)
+#include <cerrno>
+#include <csignal>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char **environ;
+
+namespace {
+
+void writeLog(const QString &log)
+{
+    QTextStream err(stderr);
+    err << log << Qt::endl;
+}
+
+// 占位进程：以目标映像名命名的 sleep 符号链接（comm 取自可执行文件名，超过 15 字符的部分由 cmdline 还原）
+class DummyProcessPool
+{
+public:
+    bool initialize(const QStringList &targetNames)
+    {
+        m_sleepPath = QStandardPaths::findExecutable("sleep");
+        if (m_sleepPath.isEmpty() || !m_directory.isValid()) {
+            return false;
+        }
+        for (const QString &name : targetNames + QStringList{kFillerName}) {
+            if (!QFile::link(m_sleepPath, m_directory.filePath(name))) {
+                return false;
+            }
+        }
+        m_reaper = std::thread([this]() { reap(); });
+        return true;
+    }
+
+    ~DummyProcessPool()
+    {
+        killAll(m_fillers);
+        killAll(m_targets);
+        m_stopping.store(true);
+        if (m_reaper.joinable()) {
+            m_reaper.join();
+        }
+    }
+
+    // 补充填充进程，使进程表达到 tableSize（已有的系统进程计入在内）
+    int fillTo(int tableSize)
+    {
+        const int missing = tableSize - ProcessSnapshot::capture().size();
+        for (int i = 0; i < missing; ++i) {
+            const pid_t pid = spawn(kFillerName);
+            if (pid <= 0) {
+                writeLog(QString("填充进程创建失败（已创建 %1 个）：%2").arg(i).arg(qt_error_string(errno)));
+                break;
+            }
+            m_fillers.append(pid);
+        }
+        return ProcessSnapshot::capture().size();
+    }
+
+    void clearFillers()
+    {
+        killAll(m_fillers);
+    }
+
+    // 按目标映像名轮流启动 count 个占位进程
+    int spawnTargets(const QStringList &targetNames, int count)
+    {
+        int spawned = 0;
+        for (int i = 0; i < count; ++i) {
+            const pid_t pid = spawn(targetNames.at(i % targetNames.size()));
+            if (pid > 0) {
+                m_targets.append(pid);
+                ++spawned;
+            }
+        }
+        // 等待 execve 完成，确保快照中看到的是目标映像名而不是本程序
+        QThread::msleep(50);
+        return spawned;
+    }
+
+    void forgetTargets()
+    {
+        m_targets.clear();
+    }
+
+private:
+    static constexpr const char *kFillerName = "bench-filler";
+
+    QTemporaryDir m_directory;
+    QString m_sleepPath;
+    QList<pid_t> m_fillers;
+    QList<pid_t> m_targets;
+    std::thread m_reaper;
+    std::atomic<bool> m_stopping{false};
+
+    pid_t spawn(const QString &name)
+    {
+        const QByteArray path = QFile::encodeName(m_directory.filePath(name));
+        char seconds[] = "3600";
+        char *argv[] = {const_cast<char *>(path.constData()), seconds, nullptr};
+        pid_t pid = 0;
+        if (posix_spawn(&pid, path.constData(), nullptr, nullptr, argv, environ) != 0) {
+            return -1;
+        }
+        return pid;
+    }
+
+    static void killAll(QList<pid_t> &pids)
+    {
+        for (const pid_t pid : pids) {
+            ::kill(pid, SIGKILL);
+        }
+        pids.clear();
+    }
+
+    // 及时回收退出的子进程，避免僵尸进程留在进程表中干扰测量
+    void reap()
+    {
+        for (;;) {
+            const pid_t pid = ::waitpid(-1, nullptr, 0);
+            if (pid > 0) {
+                continue;
+            }
+            if (errno == ECHILD && m_stopping.load()) {
+                return;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+    }
+};
+
+// 单项指标的统计（微秒）
+QJsonObject summarize(QList<double> samples)
+{
+    QJsonObject object;
+    object.insert("samples", int(samples.size()));
+    if (samples.isEmpty()) {
+        return object;
+    }
+    std::sort(samples.begin(), samples.end());
+    double sum = 0;
+    for (const double sample : samples) {
+        sum += sample;
+    }
+    auto percentile = [&samples](double p) {
+        return samples.at(qMin(int(samples.size()) - 1, int(p * (samples.size() - 1) + 0.5)));
+    };
+    object.insert("minUs", samples.first());
+    object.insert("medianUs", percentile(0.5));
+    object.insert("p95Us", percentile(0.95));
+    object.insert("maxUs", samples.last());
+    object.insert("meanUs", sum / samples.size());
+    return object;
+}
+
+double elapsedUs(const QElapsedTimer &timer)
+{
+    return timer.nsecsElapsed() / 1000.0;
+}
+
+double medianOf(QList<double> samples)
+{
+    if (samples.isEmpty()) {
+        return 0;
+    }
+    std::sort(samples.begin(), samples.end());
+    return samples.at(samples.size() / 2);
+}
+
+// 守护模式增量比对的稳态开销：进程表无变化时每次刷新只读一次目录，已知进程的慢节奏复核按复核间隔摊入，
+// 折算为按常规/高频间隔轮询时的单核占用百分比（预算 0.5%）
+QJsonObject measurePolling(int iterations)
+{
+    constexpr double kBudgetPercent = 0.5;
+    ProcessTableCache cache;
+    cache.refresh();
+    QList<double> refreshSamples, revalidateSamples;
+    QElapsedTimer timer;
+    for (int i = 0; i < iterations * 5; ++i) {
+        timer.restart();
+        cache.refresh();
+        refreshSamples.append(elapsedUs(timer));
+    }
+    cache.setRevalidateInterval(0);
+    for (int i = 0; i < iterations; ++i) {
+        timer.restart();
+        cache.refresh();
+        revalidateSamples.append(elapsedUs(timer));
+    }
+
+    const double revalidatePercent = medianOf(revalidateSamples) / (ProcessTableCache::kDefaultRevalidateIntervalMs * 10.0);
+    const double steadyPercent = medianOf(refreshSamples) / (ProcessWatchdog::kPollIntervalMs * 10.0) + revalidatePercent;
+    const double fastPercent = medianOf(refreshSamples) / (ProcessWatchdog::kFastPollIntervalMs * 10.0) + revalidatePercent;
+    QJsonObject object;
+    object.insert("refresh", summarize(refreshSamples));
+    object.insert("revalidate", summarize(revalidateSamples));
+    object.insert("steadyCpuPercent", steadyPercent);
+    object.insert("fastWindowCpuPercent", fastPercent);
+    object.insert("withinBudget", steadyPercent < kBudgetPercent);
+    if (steadyPercent >= kBudgetPercent) {
+        writeLog(QString("守护模式轮询稳态开销 %1% 超出预算 %2%").arg(steadyPercent, 0, 'f', 3).arg(kBudgetPercent));
+    }
+    return object;
+}
+
+QJsonObject runSize(DummyProcessPool &pool, const TargetCatalog &catalog, const QStringList &targetNames,
+                    int tableSize, int targetCount, int iterations)
+{
+    const int actualSize = pool.fillTo(tableSize);
+    writeLog(QString("进程表规模 %1（实际 %2）").arg(tableSize).arg(actualSize));
+
+    const TargetMatcher matcher(catalog);
+    NativeProcessTerminator terminator;
+    QList<double> captureSamples, refreshSamples, matchSamples, killSamples, killPerProcessSamples, sweepSamples;
+    int survivors = 0;
+
+    for (int iteration = 0; iteration < iterations; ++iteration) {
+        pool.spawnTargets(targetNames, targetCount);
+
+        QElapsedTimer timer;
+        timer.start();
+        const ProcessSnapshot snapshot = ProcessSnapshot::capture();
+        captureSamples.append(elapsedUs(timer));
+
+        // 增量刷新：先建立缓存，再测量进程表无变化时的刷新开销
+        ProcessTableCache cache;
+        cache.refresh();
+        timer.restart();
+        cache.refresh();
+        refreshSamples.append(elapsedUs(timer));
+
+        timer.restart();
+        const QList<TargetMatch> matches = matcher.matchAll(snapshot);
+        matchSamples.append(elapsedUs(timer));
+
+        // 终止到确认退出：整批发送终止信号并等待全部退出
+        QList<ProcessEntry> processes;
+        for (const TargetMatch &match : matches) {
+            processes.append(match.process);
+        }
+        timer.restart();
+        for (const ProcessEntry &process : processes) {
+            terminator.terminate(process);
+        }
+        survivors += int(ProcessWaiter::waitForExit(processes, QDeadlineTimer(5000)).size());
+        const double killUs = elapsedUs(timer);
+        killSamples.append(killUs);
+        if (!processes.isEmpty()) {
+            killPerProcessSamples.append(killUs / processes.size());
+        }
+        pool.forgetTargets();
+    }
+
+    const QJsonObject polling = measurePolling(iterations);
+
+    // 整轮关闭：与图形界面强制执行相同的 KillProcessThread
+    // 占位进程没有守护进程拉起，静默期设为 0，只测量扫描与关闭本身
+    SweepPolicy policy;
+    policy.quietPeriodMs = 0;
+    for (int iteration = 0; iteration < iterations; ++iteration) {
+        pool.spawnTargets(targetNames, targetCount);
+        KillProcessThread thread(catalog);
+        thread.setMode(KillProcessThread::ForceSweep);
+        thread.setSweepPolicy(policy);
+        QElapsedTimer timer;
+        timer.start();
+        thread.start();
+        thread.wait();
+        sweepSamples.append(elapsedUs(timer));
+        pool.forgetTargets();
+    }
+
+    QJsonObject object;
+    object.insert("requestedTableSize", tableSize);
+    object.insert("tableSize", actualSize);
+    object.insert("targets", targetCount);
+    object.insert("snapshotCapture", summarize(captureSamples));
+    object.insert("snapshotRefresh", summarize(refreshSamples));
+    object.insert("match", summarize(matchSamples));
+    object.insert("killToExit", summarize(killSamples));
+    object.insert("killToExitPerProcess", summarize(killPerProcessSamples));
+    object.insert("fullSweep", summarize(sweepSamples));
+    object.insert("watchdogPolling", polling);
+    object.insert("survivors", survivors);
+    return object;
+}
+
+} // namespace
+#endif
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("jiyu-bench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("检测/关闭延迟基准测试（仅 Linux），结果以 JSON 输出");
+    parser.addHelpOption();
+    QCommandLineOption sizesOption("sizes", "进程表规模列表（默认 100,1000,10000）", "list", "100,1000,10000");
+    QCommandLineOption targetsOption("targets", "每次迭代启动的目标占位进程数（默认 20）", "n", "20");
+    QCommandLineOption iterationsOption("iterations", "每个规模的迭代次数（默认 10）", "n", "10");
+    QCommandLineOption outputOption("output", "结果写入文件（默认标准输出）", "path");
+    parser.addOptions({sizesOption, targetsOption, iterationsOption, outputOption});
+    parser.process(app);
+
+#if defined(Q_OS_LINUX)
+    QList<int> sizes;
+    for (const QString &size : parser.value(sizesOption).split(',', Qt::SkipEmptyParts)) {
+        sizes.append(size.trimmed().toInt());
+    }
+    const int targetCount = qMax(1, parser.value(targetsOption).toInt());
+    const int iterations = qMax(1, parser.value(iterationsOption).toInt());
+
+    // 使用内置目录，结果不受程序目录下 targets.json 的影响
+    const TargetCatalog catalog = TargetCatalog::builtin();
+    QStringList targetNames;
+    for (const TargetRule &rule : catalog.rules()) {
+        targetNames.append(rule.names);
+    }
+
+    DummyProcessPool pool;
+    if (!pool.initialize(targetNames)) {
+        writeLog("无法创建占位进程（需要 sleep 命令和可写的临时目录）");
+        return 1;
+    }
+
+    QJsonArray results;
+    std::sort(sizes.begin(), sizes.end());
+    for (const int size : sizes) {
+        if (size > 0) {
+            results.append(runSize(pool, catalog, targetNames, size, targetCount, iterations));
+        }
+    }
+    pool.clearFillers();
+
+    QJsonObject report;
+    report.insert("benchmark", "jiyu-bench");
+    report.insert("timestamp", QDateTime::currentDateTimeUtc().toString(Qt::ISODate));
+    report.insert("kernel", QSysInfo::kernelVersion());
+    report.insert("cpu", QSysInfo::currentCpuArchitecture());
+    report.insert("qt", QString(qVersion()));
+    report.insert("iterations", iterations);
+    report.insert("results", results);
+
+    const QByteArray json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+    if (parser.isSet(outputOption)) {
+        QFile file(parser.value(outputOption));
+        if (!file.open(QIODevice::WriteOnly)) {
+            writeLog(QString("无法写入结果文件：%1").arg(file.errorString()));
+            return 1;
+        }
+        file.write(json);
+    } else {
+        QTextStream(stdout) << json;
+    }
+    return 0;
+#else
+    QTextStream(stderr) << "jiyu-bench 目前只支持 Linux" << Qt::endl;
+    return 1;
+#endif
+}
@@ -0,0 +1,119 @@
+#include "cancellationtoken.h"
+#include <QThread>
+#include <QDeadlineTimer>
+#include <atomic>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#else
+#include <cerrno>
+#include <poll.h>
+#include <unistd.h>
+#if defined(Q_OS_LINUX)
+#include <sys/eventfd.h>
+#endif
+#endif
+
+namespace {
+
+// 没有可等待对象时的轮询粒度
+constexpr int kCancelPollIntervalMs = 5;
+
+} // namespace
+
+struct CancellationToken::State
+{
+    std::atomic<bool> cancelled{false};
+#if defined(Q_OS_WIN)
+    HANDLE event = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    ~State()
+    {
+        if (event) {
+            CloseHandle(event);
+        }
+    }
+#elif defined(Q_OS_LINUX)
+    int descriptor = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    ~State()
+    {
+        if (descriptor >= 0) {
+            ::close(descriptor);
+        }
+    }
+#else
+    int descriptor = -1;
+#endif
+};
+
+CancellationToken CancellationToken::create()
+{
+    CancellationToken token;
+    token.m_state = std::make_shared<State>();
+    return token;
+}
+
+void CancellationToken::cancel() const
+{
+    if (!m_state || m_state->cancelled.exchange(true)) {
+        return;
+    }
+#if defined(Q_OS_WIN)
+    if (m_state->event) {
+        SetEvent(m_state->event);
+    }
+#else
+    if (m_state->descriptor >= 0) {
+        const quint64 one = 1;
+        [[maybe_unused]] const ssize_t written = ::write(m_state->descriptor, &one, sizeof(one));
+    }
+#endif
+}
+
+bool CancellationToken::isCancelled() const
+{
+    return m_state && m_state->cancelled.load(std::memory_order_acquire);
+}
+
+bool CancellationToken::sleep(int msecs) const
+{
+    if (msecs <= 0) {
+        return !isCancelled();
+    }
+    if (!m_state) {
+        QThread::msleep(quint64(msecs));
+        return true;
+    }
+#if defined(Q_OS_WIN)
+    if (m_state->event) {
+        return WaitForSingleObject(m_state->event, DWORD(msecs)) == WAIT_TIMEOUT;
+    }
+#else
+    if (m_state->descriptor >= 0) {
+        const QDeadlineTimer deadline(msecs);
+        while (!isCancelled() && !deadline.hasExpired()) {
+            pollfd entry{m_state->descriptor, POLLIN, 0};
+            if (::poll(&entry, 1, int(qMax<qint64>(0, deadline.remainingTime()))) < 0 && errno != EINTR) {
+                break;
+            }
+        }
+        return !isCancelled();
+    }
+#endif
+    const QDeadlineTimer deadline(msecs);
+    while (!isCancelled() && !deadline.hasExpired()) {
+        QThread::msleep(quint64(qMin<qint64>(kCancelPollIntervalMs, deadline.remainingTime())));
+    }
+    return !isCancelled();
+}
+
+#if defined(Q_OS_WIN)
+void *CancellationToken::waitHandle() const
+{
+    return m_state ? m_state->event : nullptr;
+}
+#else
+int CancellationToken::waitDescriptor() const
+{
+    return m_state ? m_state->descriptor : -1;
+}
+#endif
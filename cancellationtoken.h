@@ -0,0 +1,34 @@
+#ifndef CANCELLATIONTOKEN_H
+#define CANCELLATIONTOKEN_H
+
+#include <QtGlobal>
+#include <memory>
+
+// 关闭任务的取消令牌：可复制，副本共享同一状态；cancel() 后所有可取消的等待立即返回
+// 默认构造的令牌为空令牌（永不取消），需要取消能力时用 create() 创建
+class CancellationToken
+{
+public:
+    CancellationToken() = default;
+    static CancellationToken create();
+
+    // 任意线程调用
+    void cancel() const;
+    bool isCancelled() const;
+    // 可取消的休眠：完整睡满返回 true，被取消时提前返回 false
+    bool sleep(int msecs) const;
+
+#if defined(Q_OS_WIN)
+    // 手动复位事件：取消后为有信号状态（空令牌返回 nullptr）
+    void *waitHandle() const;
+#else
+    // eventfd：取消后可读（空令牌或系统不支持时返回 -1）
+    int waitDescriptor() const;
+#endif
+
+private:
+    struct State;
+    std::shared_ptr<State> m_state;
+};
+
+#endif // CANCELLATIONTOKEN_H
@@ -0,0 +1,17 @@
+# 命令行/无界面版本：jiyu-cli --detect | --kill-all | --watch | --node | --fleet <action>
+# 基于 QCoreApplication，不依赖 QtWidgets，启动时不加载样式表、壁纸与网络检查
+QT       = core
+CONFIG  += c++17 console
+CONFIG  -= app_bundle
+
+TARGET = jiyu-cli
+
+include(../engine.pri)
+
+SOURCES += \
+    main.cpp
+
+# Default rules for deployment.
+qnx: target.path = /tmp/$${TARGET}/bin
+else: unix:!android: target.path = /opt/$${TARGET}/bin
+!isEmpty(target.path): INSTALLS += target
@@ -0,0 +1,618 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QTextStream>
+#include <QTimer>
+#include <atomic>
+#include <csignal>
+#include "elevatedhelper.h"
+#include "fleet.h"
+#include "killprocessthread.h"
+#include "killtrace.h"
+#include "processsnapshot.h"
+#include "processwatchdog.h"
+#include "sweepjournal.h"
+#include "targetcatalog.h"
+
+namespace {
+
+// 退出码（供登录脚本、计划任务判断结果）
+enum ExitCode {
+    ExitOk = 0,             // 成功：--detect 未检测到目标；--kill-all 已无目标在运行；--watch 正常退出
+    ExitTargetsFound = 1,   // --detect 检测到运行中的目标
+    ExitTargetsSurvived = 2,// --kill-all 结束后仍有目标在运行；--freeze/--thaw 有进程未能挂起/恢复
+    ExitNodesFailed = 3,    // --fleet 有节点无法连接、超时或拒绝了命令
+    ExitUsage = 64,         // 参数错误
+    ExitCatalogError = 66,  // 目标目录无法加载
+    ExitJournalError = 74   // 持久化日志无法打开或读取
+};
+
+std::atomic<bool> stopRequested{false};
+
+void handleStopSignal(int)
+{
+    stopRequested.store(true);
+}
+
+void writeJson(const QJsonObject &object)
+{
+    QTextStream out(stdout);
+    out << QJsonDocument(object).toJson(QJsonDocument::Compact) << Qt::endl;
+}
+
+void writeLog(const QString &log)
+{
+    QTextStream err(stderr);
+    err << log << Qt::endl;
+}
+
+QJsonObject processToJson(const ProcessEntry &process)
+{
+    QJsonObject object;
+    object.insert("pid", process.pid);
+    object.insert("parentPid", process.parentPid);
+    object.insert("name", process.name);
+    return object;
+}
+
+QJsonArray matchesToJson(const TargetMatcher &matcher, const QList<TargetMatch> &matches)
+{
+    QJsonArray array;
+    for (const TargetMatch &match : matches) {
+        QJsonObject object = processToJson(match.process);
+        object.insert("product", matcher.rule(match.rule).product);
+        array.append(object);
+    }
+    return array;
+}
+
+QJsonObject targetToJson(const KillTarget &target, int round)
+{
+    QJsonObject object;
+    object.insert("round", round);
+    object.insert("product", target.className);
+    object.insert("processName", target.processName);
+    object.insert("guardian", target.guardian);
+    static const QHash<int, QString> kActionNames = {
+        {KillTarget::Terminate, "terminate"},
+        {KillTarget::Suspend, "suspend"},
+        {KillTarget::Resume, "resume"}
+    };
+    object.insert("action", kActionNames.value(target.action));
+    object.insert("stage", target.stage);
+    object.insert("attempts", target.attempts);
+    object.insert("timedOut", target.timedOut);
+    object.insert("succeeded", target.succeeded());
+    QJsonArray results;
+    for (int i = 0; i < target.results.size(); ++i) {
+        const KillResult &result = target.results.at(i);
+        QJsonObject item;
+        item.insert("pid", result.pid);
+        item.insert("name", target.processes.at(i).name);
+        item.insert("exited", result.exited);
+        item.insert("signalled", result.success);
+        item.insert("exitStatus", result.exitStatus);
+        item.insert("errorCode", result.errorCode);
+        if (!result.success) {
+            item.insert("error", result.errorString());
+        }
+        results.append(item);
+    }
+    object.insert("results", results);
+    return object;
+}
+
+int runDetect(const TargetMatcher &matcher)
+{
+    ProcessTableCache cache;
+    const QList<TargetMatch> matches = matcher.matchAll(cache.refresh());
+    QJsonObject object;
+    object.insert("command", "detect");
+    object.insert("found", !matches.isEmpty());
+    object.insert("matches", matchesToJson(matcher, matches));
+    writeJson(object);
+    return matches.isEmpty() ? ExitOk : ExitTargetsFound;
+}
+
+int runJournalStats(const QString &path, int hotspotCount)
+{
+    QList<SweepJournal::Record> records;
+    QHash<quint32, SweepJournal::Name> names;
+    QString errorString;
+    if (!SweepJournal::readAll(path, records, names, &errorString)) {
+        writeLog(QString("日志读取失败：%1").arg(errorString));
+        return ExitJournalError;
+    }
+    QJsonObject object = SweepJournal::summarize(records, names, hotspotCount);
+    object.insert("command", "journal-stats");
+    writeJson(object);
+    return ExitOk;
+}
+
+int runKillAll(const TargetCatalog &catalog, const SweepPolicy &policy, ProcessTerminator::Backend backend, bool verbose)
+{
+    QMutex resultsMutex;
+    QJsonArray targets;
+
+    KillProcessThread thread(catalog);
+    thread.setMode(KillProcessThread::ForceSweep);
+    thread.setSweepPolicy(policy);
+    thread.setTerminatorBackend(backend);
+    // 线程内串行发出；直接连接，结果在工作线程中收集，线程结束后再读取
+    QObject::connect(&thread, &KillProcessThread::targetFinished, &thread, [&](const KillTarget &target, int round) {
+        if (target.processes.isEmpty()) {
+            return;
+        }
+        QMutexLocker locker(&resultsMutex);
+        targets.append(targetToJson(target, round));
+    }, Qt::DirectConnection);
+    if (verbose) {
+        QObject::connect(&thread, &KillProcessThread::logUpdated, &thread, &writeLog, Qt::DirectConnection);
+    }
+    std::signal(SIGINT, handleStopSignal);
+    std::signal(SIGTERM, handleStopSignal);
+    thread.start();
+    // Ctrl+C 时取消任务：正在进行的等待立即返回，随后照常输出已有结果
+    while (!thread.wait(50)) {
+        if (stopRequested.load()) {
+            thread.cancel();
+        }
+    }
+
+    // 结束后重新确认一次：守护进程重新拉起的目标也计为失败
+    TargetMatcher matcher(catalog);
+    ProcessTableCache cache;
+    const QList<TargetMatch> survivors = matcher.matchAll(cache.refresh());
+
+    QJsonObject object;
+    object.insert("command", "kill-all");
+    object.insert("rounds", thread.roundsExecuted());
+    object.insert("cancelled", thread.isCancelled());
+    object.insert("backend", ProcessTerminator::create(backend)->backendName());
+    object.insert("targets", targets);
+    object.insert("survivors", matchesToJson(matcher, survivors));
+    writeJson(object);
+    return survivors.isEmpty() ? ExitOk : ExitTargetsSurvived;
+}
+
+// 冻结/解冻：输出每个目标的结果与整体耗时（从开始检测到最后一个进程挂起/恢复）
+int runFreeze(const TargetCatalog &catalog, KillProcessThread::Mode mode, const SweepPolicy &policy,
+              ProcessTerminator::Backend backend, bool verbose)
+{
+    QMutex resultsMutex;
+    QJsonArray targets;
+    int succeeded = 0;
+    int failed = 0;
+
+    KillProcessThread thread(catalog);
+    thread.setMode(mode);
+    thread.setSweepPolicy(policy);
+    thread.setTerminatorBackend(backend);
+    QObject::connect(&thread, &KillProcessThread::targetFinished, &thread, [&](const KillTarget &target, int round) {
+        if (target.processes.isEmpty()) {
+            return;
+        }
+        QMutexLocker locker(&resultsMutex);
+        targets.append(targetToJson(target, round));
+        for (const KillResult &result : target.results) {
+            if (result.success) {
+                ++succeeded;
+            } else {
+                ++failed;
+            }
+        }
+    }, Qt::DirectConnection);
+    if (verbose) {
+        QObject::connect(&thread, &KillProcessThread::logUpdated, &thread, &writeLog, Qt::DirectConnection);
+    }
+    std::signal(SIGINT, handleStopSignal);
+    std::signal(SIGTERM, handleStopSignal);
+    thread.start();
+    while (!thread.wait(50)) {
+        if (stopRequested.load()) {
+            thread.cancel();
+        }
+    }
+
+    const bool freeze = mode == KillProcessThread::Freeze;
+    QJsonObject object;
+    object.insert("command", freeze ? "freeze" : "thaw");
+    object.insert("passes", thread.roundsExecuted());
+    object.insert("latencyMs", thread.freezeLatencyMs());
+    object.insert("cancelled", thread.isCancelled());
+    object.insert("backend", ProcessTerminator::create(backend)->backendName());
+    object.insert(freeze ? "frozen" : "resumed", succeeded);
+    object.insert("failed", failed);
+    object.insert("targets", targets);
+    writeJson(object);
+    return failed == 0 ? ExitOk : ExitTargetsSurvived;
+}
+
+int runWatch(QCoreApplication &app, const TargetCatalog &catalog, bool verbose)
+{
+    std::signal(SIGINT, handleStopSignal);
+    std::signal(SIGTERM, handleStopSignal);
+
+    ProcessWatchdog watchdog(catalog);
+    // 每次终止输出一行 JSON（JSON Lines），便于日志采集
+    QObject::connect(&watchdog, &ProcessWatchdog::targetKilled, &app,
+                     [](const QString &className, const QString &processName, qint64 pid) {
+        QJsonObject object;
+        object.insert("event", "killed");
+        object.insert("time", QDateTime::currentDateTime().toString(Qt::ISODateWithMs));
+        object.insert("product", className);
+        object.insert("name", processName);
+        object.insert("pid", pid);
+        writeJson(object);
+    });
+    if (verbose) {
+        QObject::connect(&watchdog, &ProcessWatchdog::logUpdated, &app, &writeLog);
+    }
+
+    // 信号处理函数中只置位标志，由事件循环定时检查后退出
+    QTimer stopTimer;
+    QObject::connect(&stopTimer, &QTimer::timeout, &app, [&app]() {
+        if (stopRequested.load()) {
+            app.quit();
+        }
+    });
+    stopTimer.start(200);
+
+    watchdog.start();
+    const int code = app.exec();
+    watchdog.stop();
+    return code == 0 ? ExitOk : code;
+}
+
+QJsonObject fleetResultToJson(const FleetNodeResult &result)
+{
+    static const char *const kStates[] = {"", "running", "finished", "rejected", "busy"};
+    QJsonObject object;
+    object.insert("node", result.endpoint.toString());
+    object.insert("hostName", result.hostName);
+    object.insert("completed", result.completed);
+    object.insert("latencyMs", result.latencyMs);
+    if (!result.error.isEmpty()) {
+        object.insert("error", result.error);
+    }
+    object.insert("state", kStates[result.status.state]);
+    object.insert("watching", result.status.watching);
+    object.insert("rounds", int(result.status.round));
+    object.insert("found", qint64(result.status.found));
+    object.insert("signalled", qint64(result.status.signalled));
+    object.insert("exited", qint64(result.status.exited));
+    object.insert("failed", qint64(result.status.failed));
+    object.insert("survivors", qint64(result.status.survivors));
+    object.insert("nodeElapsedMs", qint64(result.status.elapsedMs));
+    return object;
+}
+
+// 节点列表："host[:port]"，逗号分隔；文件中每行一个，# 开头为注释
+bool parseFleetNodes(const QString &list, const QString &file, QList<FleetEndpoint> &nodes)
+{
+    QStringList entries = list.split(',', Qt::SkipEmptyParts);
+    if (!file.isEmpty()) {
+        QFile nodesFile(file);
+        if (!nodesFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            writeLog(QString("节点列表读取失败：%1").arg(nodesFile.errorString()));
+            return false;
+        }
+        for (const QString &line : QString::fromUtf8(nodesFile.readAll()).split('\n')) {
+            const QString entry = line.section('#', 0, 0).trimmed();
+            if (!entry.isEmpty()) {
+                entries.append(entry);
+            }
+        }
+    }
+    for (const QString &entry : entries) {
+        FleetEndpoint endpoint;
+        if (!FleetEndpoint::parse(entry, endpoint)) {
+            writeLog(QString("无效的节点地址：%1").arg(entry));
+            return false;
+        }
+        nodes.append(endpoint);
+    }
+    if (nodes.isEmpty()) {
+        writeLog("--fleet 需要用 --nodes 或 --nodes-file 指定至少一个节点");
+        return false;
+    }
+    return true;
+}
+
+int runFleet(QCoreApplication &app, const QList<FleetEndpoint> &nodes, FleetCommand command, const QString &action,
+             const FleetCommandOptions &options, const QByteArray &key, int timeoutMs, bool verbose)
+{
+    std::signal(SIGINT, handleStopSignal);
+    std::signal(SIGTERM, handleStopSignal);
+
+    FleetCoordinator coordinator;
+    coordinator.setKey(key);
+    coordinator.setTimeout(timeoutMs);
+    if (verbose) {
+        QObject::connect(&coordinator, &FleetCoordinator::statusReceived, &app, [&coordinator](int node, const FleetStatus &status) {
+            writeLog(QString("%1：第%2轮，已排入 %3，已退出 %4，失败 %5")
+                         .arg(coordinator.results().at(node).endpoint.toString())
+                         .arg(status.round)
+                         .arg(status.found)
+                         .arg(status.exited)
+                         .arg(status.failed));
+        });
+    }
+    QObject::connect(&coordinator, &FleetCoordinator::finished, &app, &QCoreApplication::quit);
+
+    // Ctrl+C 时不再等待未完成的节点，照常输出已有结果
+    QTimer stopTimer;
+    QObject::connect(&stopTimer, &QTimer::timeout, &app, [&app]() {
+        if (stopRequested.load()) {
+            app.quit();
+        }
+    });
+    stopTimer.start(200);
+
+    QElapsedTimer elapsed;
+    elapsed.start();
+    coordinator.run(nodes, command, options);
+    app.exec();
+
+    QJsonArray results;
+    int completed = 0;
+    bool nodesFailed = false;
+    quint64 found = 0;
+    quint64 exited = 0;
+    quint64 failed = 0;
+    quint64 survivors = 0;
+    for (const FleetNodeResult &result : coordinator.results()) {
+        results.append(fleetResultToJson(result));
+        completed += result.completed ? 1 : 0;
+        nodesFailed = nodesFailed || !result.completed || !result.error.isEmpty();
+        found += result.status.found;
+        exited += result.status.exited;
+        failed += result.status.failed;
+        survivors += result.status.survivors;
+    }
+
+    QJsonObject totals;
+    totals.insert("found", qint64(found));
+    totals.insert("exited", qint64(exited));
+    totals.insert("failed", qint64(failed));
+    totals.insert("survivors", qint64(survivors));
+    QJsonObject object;
+    object.insert("command", "fleet");
+    object.insert("action", action);
+    object.insert("nodes", int(nodes.size()));
+    object.insert("completed", completed);
+    object.insert("elapsedMs", elapsed.elapsed());
+    object.insert("totals", totals);
+    object.insert("results", results);
+    writeJson(object);
+
+    if (nodesFailed) {
+        return ExitNodesFailed;
+    }
+    if (survivors > 0) {
+        return command == FleetCommand::Detect ? ExitTargetsFound : ExitTargetsSurvived;
+    }
+    return ExitOk;
+}
+
+int runNode(QCoreApplication &app, const TargetCatalog &catalog, const FleetEndpoint &listenAddress, const QByteArray &key,
+            bool insecure, bool verbose)
+{
+    std::signal(SIGINT, handleStopSignal);
+    std::signal(SIGTERM, handleStopSignal);
+
+    FleetNode node(catalog);
+    node.setKey(key);
+    node.setInsecure(insecure);
+    if (verbose) {
+        QObject::connect(&node, &FleetNode::logUpdated, &app, &writeLog);
+    }
+    QString errorString;
+    if (!node.listen(listenAddress.host, listenAddress.port, &errorString)) {
+        writeLog(QString("节点监听失败：%1").arg(errorString));
+        if (key.isEmpty() && !insecure) {
+            writeLog("请设置 --fleet-key，或用 --listen 127.0.0.1 只接受本机连接（隔离的测试环境可加 --fleet-insecure）");
+        }
+        return ExitUsage;
+    }
+    if (key.isEmpty()) {
+        writeLog("警告：未设置 --fleet-key，任何能连接到本机的人都可以下发命令");
+    }
+    writeLog(QString("协同节点已启动（%1:%2）").arg(listenAddress.host).arg(node.port()));
+
+    QTimer stopTimer;
+    QObject::connect(&stopTimer, &QTimer::timeout, &app, [&app]() {
+        if (stopRequested.load()) {
+            app.quit();
+        }
+    });
+    stopTimer.start(200);
+    const int code = app.exec();
+    return code == 0 ? ExitOk : code;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("jiyu-cli");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("电子教室关闭工具（命令行版本）。结果以 JSON 输出到标准输出，日志输出到标准错误。\n"
+                                     "退出码：0 成功，1 检测到目标，2 仍有目标未能关闭（或未能挂起/恢复），3 有协同节点未完成命令，64 参数错误，66 目标目录无法加载，"
+                                     "74 日志无法打开或读取");
+    parser.addHelpOption();
+    QCommandLineOption detectOption("detect", "检测运行中的电子教室进程");
+    QCommandLineOption killAllOption("kill-all", "多轮关闭所有电子教室进程");
+    QCommandLineOption freezeOption("freeze", "挂起所有电子教室进程而不关闭（守护进程先于客户端、父进程先于子进程；已冻结的进程不再重复挂起），输出冻结耗时");
+    QCommandLineOption thawOption("thaw", "按冻结的逆序恢复此前冻结的进程与 --kill-all 挂起的守护进程（只恢复记录过且仍在运行的进程）");
+    QCommandLineOption watchOption("watch", "常驻运行，自动关闭新启动的电子教室进程（Ctrl+C 退出）");
+    QCommandLineOption nodeOption("node", "作为机房协同节点常驻运行，执行协调端下发的命令（Ctrl+C 退出）");
+    QCommandLineOption fleetOption("fleet", "作为协调端向所有节点同时下发命令：detect、sweep、watch 或 unwatch", "action");
+    QCommandLineOption nodesOption("nodes", "--fleet 的节点列表，逗号分隔的 host[:port]", "list");
+    QCommandLineOption nodesFileOption("nodes-file", "--fleet 的节点列表文件，每行一个 host[:port]", "path");
+    QCommandLineOption listenOption("listen", QString("--node 的监听地址（默认 0.0.0.0:%1）").arg(FleetProtocol::kDefaultPort), "host:port",
+                                    QString("0.0.0.0:%1").arg(FleetProtocol::kDefaultPort));
+    QCommandLineOption fleetKeyOption("fleet-key", "协调端与节点共用的密钥（默认读取环境变量 JIYU_FLEET_KEY）；--node 未设置密钥时只能监听回环地址", "key");
+    QCommandLineOption fleetInsecureOption("fleet-insecure", "允许 --node 不设置密钥而监听非回环地址（任何能连接到本机的人都可以下发命令，仅限隔离的测试环境）");
+    QCommandLineOption fleetTimeoutOption("fleet-timeout", "--fleet 等待所有节点完成的上限（默认 30000 毫秒）", "ms", "30000");
+    QCommandLineOption catalogOption("catalog", "目标目录文件（默认程序目录下的 targets.json，缺失时使用内置列表）", "path");
+    QCommandLineOption roundsOption("rounds", "--kill-all 的轮次上限（默认 10，实际轮次按是否被重新拉起自适应）", "n", "10");
+    QCommandLineOption quietOption("quiet-ms", "--kill-all 关闭后观察重新拉起的静默期（默认 300 毫秒）", "ms", "300");
+    QCommandLineOption keepGuardiansOption("keep-guardians", "--kill-all、--freeze 不处理目录中声明的守护进程（默认先挂起/终止守护进程，再关闭其拉起的进程）");
+    QCommandLineOption backendOption("backend", "终止后端：native（默认）、helper（权限不足时转交特权助手）或 shell", "name", "native");
+    QCommandLineOption helperOption("helper", "特权助手程序路径（默认程序目录下的 jiyu-helper）", "path");
+    QCommandLineOption verboseOption(QStringList() << "v" << "verbose", "输出详细日志到标准错误");
+    QCommandLineOption traceOption("trace", "记录分阶段计时并在结束时写入文件（.csv 为 CSV，其余为 Chrome trace-event JSON）", "path");
+    QCommandLineOption journalOption("journal", "把 --kill-all、--freeze、--thaw、--watch、--node 的每个检测/关闭事件追加到二进制日志文件（写满后轮转）", "path");
+    QCommandLineOption journalStatsOption("journal-stats", "统计日志文件：各产品被重新拉起的频率、平均关闭耗时与失败最多的进程", "path");
+    QCommandLineOption hotspotsOption("hotspots", "--journal-stats 列出的失败进程数（默认 10）", "n", "10");
+    parser.addOptions({detectOption, killAllOption, freezeOption, thawOption, watchOption, nodeOption, fleetOption, journalStatsOption, nodesOption, nodesFileOption,
+                       listenOption, fleetKeyOption, fleetInsecureOption, fleetTimeoutOption, catalogOption, roundsOption, quietOption, keepGuardiansOption, backendOption, helperOption,
+                       verboseOption, traceOption, journalOption, hotspotsOption});
+    parser.process(app);
+
+    const int commandCount = int(parser.isSet(detectOption)) + int(parser.isSet(killAllOption)) + int(parser.isSet(freezeOption))
+                             + int(parser.isSet(thawOption)) + int(parser.isSet(watchOption)) + int(parser.isSet(nodeOption))
+                             + int(parser.isSet(fleetOption)) + int(parser.isSet(journalStatsOption));
+    if (commandCount != 1) {
+        writeLog("必须且只能指定 --detect、--kill-all、--freeze、--thaw、--watch、--node、--fleet、--journal-stats 中的一个");
+        return ExitUsage;
+    }
+    if (parser.isSet(journalStatsOption)) {
+        bool hotspotsOk = false;
+        const int hotspots = parser.value(hotspotsOption).toInt(&hotspotsOk);
+        if (!hotspotsOk || hotspots < 0) {
+            writeLog("--hotspots 必须为非负整数");
+            return ExitUsage;
+        }
+        return runJournalStats(parser.value(journalStatsOption), hotspots);
+    }
+
+    bool roundsOk = false;
+    const int rounds = parser.value(roundsOption).toInt(&roundsOk);
+    if (!roundsOk || rounds < 1) {
+        writeLog("--rounds 必须为正整数");
+        return ExitUsage;
+    }
+    bool quietOk = false;
+    const int quietMs = parser.value(quietOption).toInt(&quietOk);
+    if (!quietOk || quietMs < 0) {
+        writeLog("--quiet-ms 必须为非负整数");
+        return ExitUsage;
+    }
+    SweepPolicy policy;
+    policy.maxRounds = rounds;
+    policy.quietPeriodMs = quietMs;
+    policy.neutralizeGuardians = !parser.isSet(keepGuardiansOption);
+    const QString backendName = parser.value(backendOption);
+    if (backendName != "native" && backendName != "helper" && backendName != "shell") {
+        writeLog("--backend 只能为 native、helper 或 shell");
+        return ExitUsage;
+    }
+    ProcessTerminator::Backend backend = ProcessTerminator::Native;
+    if (backendName == "helper") {
+        backend = ProcessTerminator::Helper;
+    } else if (backendName == "shell") {
+        backend = ProcessTerminator::Shell;
+    }
+    if (parser.isSet(helperOption)) {
+        ElevatedHelper::setProgram(parser.value(helperOption));
+    }
+
+    const QByteArray fleetKey = parser.isSet(fleetKeyOption) ? parser.value(fleetKeyOption).toUtf8() : qgetenv("JIYU_FLEET_KEY");
+    QList<FleetEndpoint> fleetNodes;
+    FleetCommand fleetCommand = FleetCommand::Detect;
+    FleetCommandOptions fleetOptions;
+    fleetOptions.maxRounds = quint16(qMin(rounds, 0xFFFF));
+    fleetOptions.quietPeriodMs = quint16(qMin(quietMs, 0xFFFF));
+    bool fleetTimeoutOk = false;
+    const int fleetTimeoutMs = parser.value(fleetTimeoutOption).toInt(&fleetTimeoutOk);
+    if (parser.isSet(fleetOption)) {
+        static const QHash<QString, FleetCommand> kActions = {
+            {"detect", FleetCommand::Detect},
+            {"sweep", FleetCommand::Sweep},
+            {"watch", FleetCommand::Watch},
+            {"unwatch", FleetCommand::Unwatch}
+        };
+        if (!kActions.contains(parser.value(fleetOption))) {
+            writeLog("--fleet 只能为 detect、sweep、watch 或 unwatch");
+            return ExitUsage;
+        }
+        fleetCommand = kActions.value(parser.value(fleetOption));
+        if (!fleetTimeoutOk || fleetTimeoutMs < 1) {
+            writeLog("--fleet-timeout 必须为正整数");
+            return ExitUsage;
+        }
+        if (!parseFleetNodes(parser.value(nodesOption), parser.value(nodesFileOption), fleetNodes)) {
+            return ExitUsage;
+        }
+    }
+    FleetEndpoint listenAddress;
+    if (parser.isSet(nodeOption) && !FleetEndpoint::parse(parser.value(listenOption), listenAddress)) {
+        writeLog("--listen 格式应为 host:port");
+        return ExitUsage;
+    }
+
+    TargetCatalog catalog;
+    if (parser.isSet(catalogOption)) {
+        QString errorString;
+        catalog = TargetCatalog::load(parser.value(catalogOption), &errorString);
+        if (catalog.isEmpty()) {
+            writeLog(QString("目标目录加载失败：%1").arg(errorString));
+            return ExitCatalogError;
+        }
+    } else {
+        catalog = TargetCatalog::loadDefault();
+    }
+
+    const bool verbose = parser.isSet(verboseOption);
+    KillTrace::setEnabled(parser.isSet(traceOption));
+    if (parser.isSet(journalOption)) {
+        QString errorString;
+        if (!SweepJournal::open(parser.value(journalOption), SweepJournal::Options(), &errorString)) {
+            writeLog(QString("日志打开失败：%1").arg(errorString));
+            return ExitJournalError;
+        }
+    }
+    int code = ExitOk;
+    if (parser.isSet(detectOption)) {
+        code = runDetect(TargetMatcher(catalog));
+    } else if (parser.isSet(killAllOption)) {
+        code = runKillAll(catalog, policy, backend, verbose);
+    } else if (parser.isSet(freezeOption)) {
+        code = runFreeze(catalog, KillProcessThread::Freeze, policy, backend, verbose);
+    } else if (parser.isSet(thawOption)) {
+        code = runFreeze(catalog, KillProcessThread::Thaw, policy, backend, verbose);
+    } else if (parser.isSet(nodeOption)) {
+        code = runNode(app, catalog, listenAddress, fleetKey, parser.isSet(fleetInsecureOption), verbose);
+    } else if (parser.isSet(fleetOption)) {
+        code = runFleet(app, fleetNodes, fleetCommand, parser.value(fleetOption), fleetOptions, fleetKey, fleetTimeoutMs, verbose);
+    } else {
+        code = runWatch(app, catalog, verbose);
+    }
+
+    if (SweepJournal::isEnabled()) {
+        SweepJournal::close();
+        if (SweepJournal::droppedCount() > 0) {
+            writeLog(QString("日志队列已满，丢弃了 %1 条记录").arg(SweepJournal::droppedCount()));
+        }
+    }
+
+    if (KillTrace::isEnabled()) {
+        QString errorString;
+        if (!KillTrace::exportToFile(parser.value(traceOption), &errorString)) {
+            writeLog(QString("计时记录写入失败：%1").arg(errorString));
+        }
+    }
+    return code;
+}
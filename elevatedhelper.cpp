@@ -0,0 +1,718 @@
+#include "elevatedhelper.h"
+#include "messageframe.h"
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QDeadlineTimer>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QProcess>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#include <sddl.h>
+#include <shellapi.h>
+#else
+#include <cerrno>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr quint32 kMagic = 0x4A594850;   // "JYHP"
+constexpr quint16 kProtocolVersion = 1;
+constexpr QDataStream::Version kStreamVersion = QDataStream::Qt_6_0;
+constexpr quint32 kMaxBatchSize = 65536;
+
+// 本地连接在助手未运行时立即失败，这里只是兜底
+constexpr int kConnectTimeoutMs = 200;
+// 等待用户确认提权窗口并等助手开始监听的上限
+constexpr int kLaunchTimeoutMs = 10000;
+constexpr int kLaunchPollIntervalMs = 50;
+// 阻塞读写分片，每片之间检查取消
+constexpr int kWaitSliceMs = 20;
+// 单批请求的往返上限（助手内只做系统调用，不等待退出）
+constexpr int kRequestTimeoutMs = 2000;
+// 助手空闲退出时间
+constexpr int kDefaultIdleTimeoutMs = 15 * 60 * 1000;
+// 祖先链检查的深度上限（Windows 的父 PID 可能已被复用而形成环）
+constexpr int kMaxAncestorDepth = 64;
+
+// 一次助手启动。Windows 上 ShellExecuteExW 会一直阻塞到用户答复提权确认，因此在独立线程中执行；
+// 等待方不持有 launchMutex，按各自的取消令牌随时放弃等待
+struct HelperLaunch
+{
+    std::atomic<bool> finished{false};
+    // 以下字段在 finished 置位后只读
+    bool succeeded = false;
+    QString errorString;
+    QElapsedTimer sinceFinished;
+#if defined(Q_OS_WIN)
+    HANDLE process = nullptr;  // 助手进程句柄：用于发现助手启动后立即退出
+
+    ~HelperLaunch()
+    {
+        if (process) {
+            CloseHandle(process);
+        }
+    }
+#endif
+
+    bool hasExited() const
+    {
+#if defined(Q_OS_WIN)
+        return finished.load(std::memory_order_acquire) && process && WaitForSingleObject(process, 0) == WAIT_OBJECT_0;
+#else
+        return false;
+#endif
+    }
+};
+
+QMutex launchMutex;
+bool launchFailed = false;  // 提权被拒绝或助手无法启动：本会话内不再重复尝试
+QString helperProgram;
+std::shared_ptr<HelperLaunch> currentLaunch;  // 最近一次启动（受 launchMutex 保护）
+QMutex serverNameMutex;
+QString customServerName;
+
+#if defined(Q_OS_WIN)
+constexpr int kNoSuchProcess = ERROR_INVALID_PARAMETER;
+constexpr int kAccessDenied = ERROR_ACCESS_DENIED;
+#else
+constexpr int kNoSuchProcess = ESRCH;
+constexpr int kAccessDenied = EPERM;
+#endif
+
+bool canConnect()
+{
+    QLocalSocket socket;
+    socket.connectToServer(ElevatedHelper::serverName());
+    return socket.waitForConnected(kConnectTimeoutMs);
+}
+
+// 启动助手（不等待其就绪）；在启动线程中调用，Windows 上会阻塞到用户答复提权确认
+bool launch(const QString &program, HelperLaunch &state)
+{
+    if (!QFileInfo::exists(program)) {
+        state.errorString = QString("特权助手程序不存在：%1").arg(program);
+        return false;
+    }
+    const QStringList arguments{QStringLiteral("--server"), ElevatedHelper::serverName()};
+#if defined(Q_OS_WIN)
+    const std::wstring file = QDir::toNativeSeparators(program).toStdWString();
+    const std::wstring parameters = QString("%1 \"%2\"").arg(arguments.at(0), arguments.at(1)).toStdWString();
+    SHELLEXECUTEINFOW info = {};
+    info.cbSize = sizeof(info);
+    info.fMask = SEE_MASK_NOASYNC | SEE_MASK_NOCLOSEPROCESS;
+    info.lpVerb = L"runas";
+    info.lpFile = file.c_str();
+    info.lpParameters = parameters.c_str();
+    info.nShow = SW_HIDE;
+    if (!ShellExecuteExW(&info)) {
+        // ERROR_CANCELLED：用户拒绝了提权
+        const DWORD error = GetLastError();
+        state.errorString = error == ERROR_CANCELLED ? QString("用户拒绝了提权")
+                                                     : QString("特权助手启动失败：%1").arg(qt_error_string(int(error)));
+        return false;
+    }
+    state.process = info.hProcess;
+    return true;
+#else
+    // Linux/macOS 不做提权：以当前用户启动（需要 root 时由管理员以 root 预先启动同名助手）
+    if (!QProcess::startDetached(program, arguments)) {
+        state.errorString = QString("特权助手启动失败：%1").arg(program);
+        return false;
+    }
+    return true;
+#endif
+}
+
+// 在独立线程中启动助手；调用方需持有 launchMutex
+std::shared_ptr<HelperLaunch> startLaunch(const QString &program)
+{
+    auto state = std::make_shared<HelperLaunch>();
+    std::thread([state, program]() {
+        state->succeeded = launch(program, *state);
+        state->sinceFinished.start();
+        if (!state->succeeded) {
+            QMutexLocker locker(&launchMutex);
+            launchFailed = true;
+        }
+        state->finished.store(true, std::memory_order_release);
+    }).detach();
+    return state;
+}
+
+// 可取消的等待：助手进程句柄可用时一并等待，助手退出即返回；被取消时返回 false
+bool waitLaunch(const HelperLaunch &state, const CancellationToken &cancellation, int msecs)
+{
+#if defined(Q_OS_WIN)
+    HANDLE cancelEvent = HANDLE(cancellation.waitHandle());
+    if (state.finished.load(std::memory_order_acquire) && state.process && cancelEvent) {
+        const HANDLE handles[] = {state.process, cancelEvent};
+        WaitForMultipleObjects(2, handles, FALSE, DWORD(msecs));
+        return !cancellation.isCancelled();
+    }
+#else
+    Q_UNUSED(state);
+#endif
+    return cancellation.sleep(msecs);
+}
+
+#if defined(Q_OS_WIN)
+// 当前用户的 SID 字符串（如 S-1-5-21-...），失败时返回空串
+QString currentUserSid()
+{
+    HANDLE token = nullptr;
+    if (!OpenProcessToken(GetCurrentProcess(), TOKEN_QUERY, &token)) {
+        return QString();
+    }
+    QString sid;
+    DWORD size = 0;
+    GetTokenInformation(token, TokenUser, nullptr, 0, &size);
+    QByteArray buffer(int(size), 0);
+    if (size > 0 && GetTokenInformation(token, TokenUser, buffer.data(), size, &size)) {
+        LPWSTR text = nullptr;
+        if (ConvertSidToStringSidW(reinterpret_cast<TOKEN_USER *>(buffer.data())->User.Sid, &text)) {
+            sid = QString::fromWCharArray(text);
+            LocalFree(text);
+        }
+    }
+    CloseHandle(token);
+    return sid;
+}
+#endif
+
+// 确认连接的对端确实是特权助手，而不是抢先占用了同名管道/套接字的其他程序
+// Windows：服务端进程的映像必须是助手程序本身；Linux/macOS：对端必须属于当前用户或 root
+bool verifyServer(QLocalSocket &socket, QString *errorString)
+{
+#if defined(Q_OS_WIN)
+    ULONG serverPid = 0;
+    if (!GetNamedPipeServerProcessId(HANDLE(socket.socketDescriptor()), &serverPid)) {
+        *errorString = QString("无法确认特权助手的身份：%1").arg(qt_error_string(int(GetLastError())));
+        return false;
+    }
+    HANDLE process = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, serverPid);
+    if (!process) {
+        *errorString = QString("无法确认特权助手的身份：%1").arg(qt_error_string(int(GetLastError())));
+        return false;
+    }
+    wchar_t path[MAX_PATH * 4];
+    DWORD length = DWORD(sizeof(path) / sizeof(path[0]));
+    const bool queried = QueryFullProcessImageNameW(process, 0, path, &length);
+    CloseHandle(process);
+    const QString image = queried ? QFileInfo(QString::fromWCharArray(path, int(length))).canonicalFilePath() : QString();
+    const QString expected = QFileInfo(ElevatedHelper::program()).canonicalFilePath();
+    if (image.isEmpty() || image.compare(expected, Qt::CaseInsensitive) != 0) {
+        *errorString = QString("管道 %1 的服务端（PID %2）不是特权助手").arg(ElevatedHelper::serverName()).arg(serverPid);
+        return false;
+    }
+    return true;
+#else
+    uid_t peerUid = uid_t(-1);
+#if defined(Q_OS_LINUX)
+    ucred credentials = {};
+    socklen_t length = sizeof(credentials);
+    if (::getsockopt(int(socket.socketDescriptor()), SOL_SOCKET, SO_PEERCRED, &credentials, &length) == 0) {
+        peerUid = credentials.uid;
+    }
+#else
+    gid_t peerGid = 0;
+    if (::getpeereid(int(socket.socketDescriptor()), &peerUid, &peerGid) != 0) {
+        peerUid = uid_t(-1);
+    }
+#endif
+    if (peerUid != ::getuid() && peerUid != 0) {
+        *errorString = QString("套接字 %1 的服务端不属于当前用户").arg(ElevatedHelper::serverName());
+        return false;
+    }
+    return true;
+#endif
+}
+
+} // namespace
+
+QString ElevatedHelper::serverName()
+{
+    {
+        QMutexLocker locker(&serverNameMutex);
+        if (!customServerName.isEmpty()) {
+            return customServerName;
+        }
+    }
+#if defined(Q_OS_WIN)
+    // 以 SID 而非可被他人猜到并抢注的用户名区分；连接后仍会校验服务端身份
+    const QString sid = currentUserSid();
+    return QString("jiyu-helper-%1").arg(sid.isEmpty() ? qEnvironmentVariable("USERNAME") : sid);
+#else
+    // 优先放在只有本用户可写的运行时目录，避免其他用户在 /tmp 下抢先创建同名套接字
+    const QString runtimeDirectory = qEnvironmentVariable("XDG_RUNTIME_DIR");
+    if (!runtimeDirectory.isEmpty() && QFileInfo(runtimeDirectory).isDir()) {
+        return QDir(runtimeDirectory).filePath("jiyu-helper");
+    }
+    return QString("jiyu-helper-%1").arg(::getuid());
+#endif
+}
+
+void ElevatedHelper::setServerName(const QString &name)
+{
+    QMutexLocker locker(&serverNameMutex);
+    customServerName = name;
+}
+
+QString ElevatedHelper::program()
+{
+    QMutexLocker locker(&launchMutex);
+    if (!helperProgram.isEmpty()) {
+        return helperProgram;
+    }
+#if defined(Q_OS_WIN)
+    return QDir(QCoreApplication::applicationDirPath()).filePath("jiyu-helper.exe");
+#else
+    return QDir(QCoreApplication::applicationDirPath()).filePath("jiyu-helper");
+#endif
+}
+
+void ElevatedHelper::setProgram(const QString &path)
+{
+    QMutexLocker locker(&launchMutex);
+    helperProgram = path;
+    launchFailed = false;
+    currentLaunch.reset();
+}
+
+bool ElevatedHelper::ensureRunning(int timeoutMs, const CancellationToken &cancellation, QString *errorString)
+{
+    auto fail = [errorString](const QString &message) {
+        if (errorString) {
+            *errorString = message;
+        }
+        return false;
+    };
+
+    if (canConnect()) {
+        return true;
+    }
+    const QString path = program();
+    // 并发的工作线程共享同一次启动：只有第一个发起启动，其余等同一次启动就绪
+    // 已结束的启动在助手退出或启动后超时仍未就绪时才重新发起（助手空闲退出后需要再次启动）
+    std::shared_ptr<HelperLaunch> state;
+    {
+        QMutexLocker locker(&launchMutex);
+        if (launchFailed) {
+            return fail("特权助手此前启动失败，本会话内不再重试");
+        }
+        if (cancellation.isCancelled()) {
+            return fail("已取消");
+        }
+        const bool stale = currentLaunch && currentLaunch->finished.load(std::memory_order_acquire)
+                           && (currentLaunch->hasExited() || currentLaunch->sinceFinished.hasExpired(kLaunchTimeoutMs));
+        if (!currentLaunch || stale) {
+            currentLaunch = startLaunch(path);
+        }
+        state = currentLaunch;
+    }
+
+    const QDeadlineTimer deadline(timeoutMs);
+    while (!deadline.hasExpired()) {
+        if (canConnect()) {
+            return true;
+        }
+        if (state->finished.load(std::memory_order_acquire)) {
+            if (!state->succeeded) {
+                return fail(state->errorString);
+            }
+            if (state->hasExited()) {
+                return fail(QString("特权助手启动后立即退出：%1").arg(path));
+            }
+        }
+        if (!waitLaunch(*state, cancellation, kLaunchPollIntervalMs)) {
+            return fail("已取消");
+        }
+    }
+    return fail(QString("特权助手未在 %1 毫秒内就绪：%2").arg(timeoutMs).arg(path));
+}
+
+QList<KillResult> ElevatedHelper::request(Operation operation, const QList<ProcessEntry> &processes, int timeoutMs,
+                                          const CancellationToken &cancellation, QString *errorString)
+{
+    auto fail = [errorString](const QString &message) {
+        if (errorString) {
+            *errorString = message;
+        }
+        return QList<KillResult>();
+    };
+
+    QLocalSocket socket;
+    socket.connectToServer(serverName());
+    if (!socket.waitForConnected(kConnectTimeoutMs)) {
+        QString launchError;
+        if (!ensureRunning(kLaunchTimeoutMs, cancellation, &launchError)) {
+            return fail(QString("特权助手未运行且无法启动：%1").arg(launchError));
+        }
+        socket.connectToServer(serverName());
+        if (!socket.waitForConnected(kConnectTimeoutMs)) {
+            return fail(socket.errorString());
+        }
+    }
+    QString identityError;
+    if (!verifyServer(socket, &identityError)) {
+        return fail(identityError);
+    }
+
+    const QDeadlineTimer deadline(timeoutMs);
+    socket.write(MessageFrame::wrap(encodeRequest(operation, processes)));
+    while (socket.bytesToWrite() > 0) {
+        if (cancellation.isCancelled() || deadline.hasExpired()) {
+            return fail("请求已取消或超时");
+        }
+        if (!socket.waitForBytesWritten(kWaitSliceMs) && socket.state() != QLocalSocket::ConnectedState) {
+            return fail(socket.errorString());
+        }
+    }
+
+    QByteArray buffer;
+    QByteArray payload;
+    bool invalid = false;
+    while (!MessageFrame::take(buffer, payload, invalid)) {
+        if (invalid) {
+            return fail("特权助手返回了无效的数据");
+        }
+        if (cancellation.isCancelled() || deadline.hasExpired()) {
+            return fail("请求已取消或超时");
+        }
+        if (!socket.waitForReadyRead(kWaitSliceMs) && socket.state() != QLocalSocket::ConnectedState) {
+            return fail(socket.errorString());
+        }
+        buffer += socket.readAll();
+    }
+
+    QList<KillResult> results;
+    if (!decodeResponse(payload, results) || results.size() != processes.size()) {
+        return fail("特权助手返回了无效的数据");
+    }
+    return results;
+}
+
+QByteArray ElevatedHelper::encodeRequest(Operation operation, const QList<ProcessEntry> &processes)
+{
+    QByteArray payload;
+    QDataStream stream(&payload, QIODevice::WriteOnly);
+    stream.setVersion(kStreamVersion);
+    stream << kMagic << kProtocolVersion << quint8(operation) << quint32(processes.size());
+    for (const ProcessEntry &process : processes) {
+        stream << qint64(process.pid) << quint64(process.startTime);
+    }
+    return payload;
+}
+
+bool ElevatedHelper::decodeRequest(const QByteArray &payload, Operation &operation, QList<ProcessEntry> &processes)
+{
+    QDataStream stream(payload);
+    stream.setVersion(kStreamVersion);
+    quint32 magic = 0;
+    quint16 version = 0;
+    quint8 code = 0;
+    quint32 count = 0;
+    stream >> magic >> version >> code >> count;
+    if (stream.status() != QDataStream::Ok || magic != kMagic || version != kProtocolVersion
+        || code < Terminate || code > Resume || count > kMaxBatchSize) {
+        return false;
+    }
+    operation = Operation(code);
+    processes.clear();
+    processes.reserve(count);
+    for (quint32 i = 0; i < count; ++i) {
+        ProcessEntry process;
+        qint64 pid = 0;
+        quint64 startTime = 0;
+        stream >> pid >> startTime;
+        process.pid = pid;
+        process.startTime = startTime;
+        processes.append(process);
+    }
+    return stream.status() == QDataStream::Ok && stream.atEnd();
+}
+
+QByteArray ElevatedHelper::encodeResponse(const QList<KillResult> &results)
+{
+    QByteArray payload;
+    QDataStream stream(&payload, QIODevice::WriteOnly);
+    stream.setVersion(kStreamVersion);
+    stream << kMagic << kProtocolVersion << quint32(results.size());
+    for (const KillResult &result : results) {
+        stream << qint64(result.pid) << result.success << qint32(result.exitStatus) << qint32(result.errorCode);
+    }
+    return payload;
+}
+
+bool ElevatedHelper::decodeResponse(const QByteArray &payload, QList<KillResult> &results)
+{
+    QDataStream stream(payload);
+    stream.setVersion(kStreamVersion);
+    quint32 magic = 0;
+    quint16 version = 0;
+    quint32 count = 0;
+    stream >> magic >> version >> count;
+    if (stream.status() != QDataStream::Ok || magic != kMagic || version != kProtocolVersion || count > kMaxBatchSize) {
+        return false;
+    }
+    results.clear();
+    results.reserve(count);
+    for (quint32 i = 0; i < count; ++i) {
+        KillResult result;
+        qint64 pid = 0;
+        qint32 exitStatus = 0;
+        qint32 errorCode = 0;
+        stream >> pid >> result.success >> exitStatus >> errorCode;
+        result.pid = pid;
+        result.exitStatus = exitStatus;
+        result.errorCode = errorCode;
+        results.append(result);
+    }
+    return stream.status() == QDataStream::Ok && stream.atEnd();
+}
+
+bool ElevatedHelper::isPermissionError(const KillResult &result)
+{
+    return !result.success && result.errorCode == kAccessDenied;
+}
+
+KillResult HelperProcessTerminator::terminate(const ProcessEntry &process)
+{
+    return terminateAll(QList<ProcessEntry>{process}).first();
+}
+
+QList<KillResult> HelperProcessTerminator::terminateAll(const QList<ProcessEntry> &processes)
+{
+    return runBatch(ElevatedHelper::Terminate, processes);
+}
+
+KillResult HelperProcessTerminator::suspend(const ProcessEntry &process)
+{
+    return suspendAll(QList<ProcessEntry>{process}).first();
+}
+
+QList<KillResult> HelperProcessTerminator::suspendAll(const QList<ProcessEntry> &processes)
+{
+    return runBatch(ElevatedHelper::Suspend, processes);
+}
+
+KillResult HelperProcessTerminator::resume(const ProcessEntry &process)
+{
+    return resumeAll(QList<ProcessEntry>{process}).first();
+}
+
+QList<KillResult> HelperProcessTerminator::resumeAll(const QList<ProcessEntry> &processes)
+{
+    return runBatch(ElevatedHelper::Resume, processes);
+}
+
+QList<KillResult> HelperProcessTerminator::runBatch(ElevatedHelper::Operation operation, const QList<ProcessEntry> &processes)
+{
+    QList<KillResult> results;
+    results.reserve(processes.size());
+    QList<int> denied;
+    QList<ProcessEntry> deniedProcesses;
+    for (const ProcessEntry &process : processes) {
+        switch (operation) {
+        case ElevatedHelper::Terminate:
+            results.append(m_native.terminate(process));
+            break;
+        case ElevatedHelper::Suspend:
+            results.append(m_native.suspend(process));
+            break;
+        case ElevatedHelper::Resume:
+            results.append(m_native.resume(process));
+            break;
+        }
+        if (ElevatedHelper::isPermissionError(results.last())) {
+            denied.append(int(results.size()) - 1);
+            deniedProcesses.append(process);
+        }
+    }
+    if (denied.isEmpty() || m_cancellation.isCancelled()) {
+        return results;
+    }
+
+    // 权限不足的进程整批转交助手；助手不可用时保留原生后端的结果
+    QString errorString;
+    const QList<KillResult> elevated = ElevatedHelper::request(operation, deniedProcesses,
+                                                               kRequestTimeoutMs, m_cancellation, &errorString);
+    if (elevated.isEmpty()) {
+        log(QString("特权助手请求失败（%1个进程保留权限不足的结果）：%2").arg(denied.size()).arg(errorString));
+        return results;
+    }
+    for (int i = 0; i < denied.size(); ++i) {
+        results[denied.at(i)] = elevated.at(i);
+    }
+    return results;
+}
+
+ElevatedHelperServer::ElevatedHelperServer(const TargetCatalog &catalog, QObject *parent)
+    : QObject(parent)
+    , m_matcher(catalog)
+    , m_server(new QLocalServer(this))
+{
+    // 只接受同一用户的连接
+    m_server->setSocketOptions(QLocalServer::UserAccessOption);
+    connect(m_server, &QLocalServer::newConnection, this, &ElevatedHelperServer::onNewConnection);
+    m_idleTimer.setSingleShot(true);
+    m_idleTimer.setInterval(kDefaultIdleTimeoutMs);
+    connect(&m_idleTimer, &QTimer::timeout, this, [this]() {
+        if (m_buffers.isEmpty()) {
+            emit idleTimeout();
+        } else {
+            m_idleTimer.start();
+        }
+    });
+}
+
+ElevatedHelperServer::~ElevatedHelperServer() = default;
+
+void ElevatedHelperServer::setIdleTimeout(int msecs)
+{
+    m_idleTimer.setInterval(msecs);
+}
+
+ElevatedHelperServer::ListenResult ElevatedHelperServer::listen(const QString &name, QString *errorString)
+{
+    if (!m_server->listen(name)) {
+        // 名称被占用：已有助手在运行则让出，否则是上次异常退出遗留的套接字文件
+        QLocalSocket probe;
+        probe.connectToServer(name);
+        if (probe.waitForConnected(kConnectTimeoutMs)) {
+            return AlreadyRunning;
+        }
+        QLocalServer::removeServer(name);
+        if (!m_server->listen(name)) {
+            if (errorString) {
+                *errorString = m_server->errorString();
+            }
+            return ListenFailed;
+        }
+    }
+    m_idleTimer.start();
+    return Listening;
+}
+
+void ElevatedHelperServer::onNewConnection()
+{
+    while (QLocalSocket *socket = m_server->nextPendingConnection()) {
+        m_idleTimer.stop();
+        m_buffers.insert(socket, QByteArray());
+        connect(socket, &QLocalSocket::readyRead, this, [this, socket]() {
+            onReadyRead(socket);
+        });
+        connect(socket, &QLocalSocket::disconnected, this, [this, socket]() {
+            m_buffers.remove(socket);
+            socket->deleteLater();
+            if (m_buffers.isEmpty()) {
+                m_idleTimer.start();
+            }
+        });
+    }
+}
+
+void ElevatedHelperServer::onReadyRead(QLocalSocket *socket)
+{
+    auto buffer = m_buffers.find(socket);
+    if (buffer == m_buffers.end()) {
+        return;
+    }
+    buffer.value() += socket->readAll();
+
+    QByteArray payload;
+    bool invalid = false;
+    while (MessageFrame::take(buffer.value(), payload, invalid)) {
+        ElevatedHelper::Operation operation;
+        QList<ProcessEntry> processes;
+        if (!ElevatedHelper::decodeRequest(payload, operation, processes)) {
+            invalid = true;
+            break;
+        }
+        socket->write(MessageFrame::wrap(ElevatedHelper::encodeResponse(handle(operation, processes))));
+    }
+    if (invalid) {
+        emit logUpdated("收到无效请求，断开连接");
+        socket->disconnectFromServer();
+    }
+}
+
+QList<KillResult> ElevatedHelperServer::handle(ElevatedHelper::Operation operation, const QList<ProcessEntry> &processes)
+{
+    static const QHash<int, QString> kOperationNames = {
+        {ElevatedHelper::Terminate, QStringLiteral("终止")},
+        {ElevatedHelper::Suspend, QStringLiteral("挂起")},
+        {ElevatedHelper::Resume, QStringLiteral("恢复")}
+    };
+    const QString operationName = kOperationNames.value(operation);
+    QList<KillResult> results;
+    results.reserve(processes.size());
+    const ProcessSnapshot snapshot = m_processCache.refresh();
+    for (const ProcessEntry &requested : processes) {
+        KillResult result;
+        result.pid = requested.pid;
+        const ProcessEntry *current = snapshot.process(requested.pid);
+#if defined(Q_OS_LINUX)
+        // 缓存只按慢节奏复核已知进程的映像名，授权以实时读取的进程为准（exec 之后 PID 与启动时间都不变）
+        ProcessEntry live;
+        if (current) {
+            current = ProcessSnapshot::readProcess(requested.pid, live) ? &live : nullptr;
+        }
+#endif
+        if (!current || (requested.startTime != 0 && current->startTime != requested.startTime)) {
+            // 已退出或 PID 已被复用：与原生后端对不存在进程的处理一致
+            result.errorCode = kNoSuchProcess;
+            result.success = true;
+        } else if (!isAllowed(snapshot, *current)) {
+            result.errorCode = kAccessDenied;
+            emit logUpdated(QString("拒绝%1非目标进程（进程：%2，PID：%3）").arg(operationName, current->name).arg(current->pid));
+        } else {
+            switch (operation) {
+            case ElevatedHelper::Terminate:
+                result = m_terminator.terminate(*current);
+                break;
+            case ElevatedHelper::Suspend:
+                result = m_terminator.suspend(*current);
+                break;
+            case ElevatedHelper::Resume:
+                result = m_terminator.resume(*current);
+                break;
+            }
+            emit logUpdated(QString("%1 %2（PID：%3）：%4")
+                                .arg(operationName, current->name)
+                                .arg(current->pid)
+                                .arg(result.success ? QString("成功") : result.errorString()));
+        }
+        results.append(result);
+    }
+    return results;
+}
+
+bool ElevatedHelperServer::isAllowed(const ProcessSnapshot &snapshot, const ProcessEntry &process) const
+{
+    if (m_matcher.matchGuardian(process) >= 0) {
+        return true;
+    }
+    const ProcessEntry *current = &process;
+    for (int depth = 0; current && depth < kMaxAncestorDepth; ++depth) {
+        // 只沿核实过启动时间的父子关系上溯：过期的 PPID 不能让无关进程借用目标的祖先身份
+        const ProcessEntry *parent = snapshot.parentOf(*current);
+        if (m_matcher.match(*current, parent ? parent->name : QString()) >= 0) {
+            return true;
+        }
+        current = parent;
+    }
+    return false;
+}
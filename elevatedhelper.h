@@ -0,0 +1,116 @@
+#ifndef ELEVATEDHELPER_H
+#define ELEVATEDHELPER_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include "processsnapshot.h"
+#include "processterminator.h"
+#include "targetcatalog.h"
+#include "cancellationtoken.h"
+
+class QLocalServer;
+class QLocalSocket;
+
+// 常驻的特权助手进程（jiyu-helper）：每个会话只提权启动一次，之后通过本地套接字按批接收终止请求
+// 不再为每个目标、每一轮各启动一次管理员 PowerShell
+// 帧格式：quint32 负载长度 + 负载（QDataStream，大端）；每批请求使用独立连接，可在任意线程中调用
+class ElevatedHelper
+{
+public:
+    enum Operation : quint8 {
+        Terminate = 1,
+        Suspend = 2,   // 冻结模式与守护进程挂起
+        Resume = 3
+    };
+
+    // 按用户区分的本地套接字名（Windows 为含用户 SID 的命名管道，Linux 为 $XDG_RUNTIME_DIR 或 /tmp 下的 Unix 域套接字）
+    static QString serverName();
+    // 改用其他套接字名（测试用）；空串恢复默认
+    static void setServerName(const QString &name);
+    // 助手程序路径（默认程序目录下的 jiyu-helper）
+    static QString program();
+    static void setProgram(const QString &path);
+
+    // 助手可连接时直接返回；否则启动助手（Windows 弹出一次提权确认，Linux 以当前用户启动）并等待其就绪
+    // 启动在后台线程进行，等待可被取消，未答复的提权确认由后续调用继续等待；
+    // 用户拒绝提权后本会话内不再重复弹出；失败时 errorString 给出原因
+    static bool ensureRunning(int timeoutMs, const CancellationToken &cancellation = CancellationToken(),
+                              QString *errorString = nullptr);
+
+    // 发送一批请求并等待逐 PID 的结果（阻塞）；失败时返回空列表
+    static QList<KillResult> request(Operation operation, const QList<ProcessEntry> &processes, int timeoutMs,
+                                     const CancellationToken &cancellation = CancellationToken(),
+                                     QString *errorString = nullptr);
+
+    // 编解码（服务端与客户端共用）
+    static QByteArray encodeRequest(Operation operation, const QList<ProcessEntry> &processes);
+    static bool decodeRequest(const QByteArray &payload, Operation &operation, QList<ProcessEntry> &processes);
+    static QByteArray encodeResponse(const QList<KillResult> &results);
+    static bool decodeResponse(const QByteArray &payload, QList<KillResult> &results);
+
+    // 失败原因是否为权限不足（Linux EPERM，Windows ERROR_ACCESS_DENIED）
+    static bool isPermissionError(const KillResult &result);
+};
+
+// 助手后端：先在本进程内直接终止（挂起/恢复），只有权限不足的进程才整批转交特权助手
+// 不需要提权的场景与原生后端开销相同，需要提权时每批目标只有一次本地往返
+class HelperProcessTerminator : public ProcessTerminator
+{
+public:
+    QString backendName() const override { return QStringLiteral("helper"); }
+    KillResult terminate(const ProcessEntry &process) override;
+    QList<KillResult> terminateAll(const QList<ProcessEntry> &processes) override;
+    KillResult suspend(const ProcessEntry &process) override;
+    QList<KillResult> suspendAll(const QList<ProcessEntry> &processes) override;
+    KillResult resume(const ProcessEntry &process) override;
+    QList<KillResult> resumeAll(const QList<ProcessEntry> &processes) override;
+
+private:
+    NativeProcessTerminator m_native;
+
+    QList<KillResult> runBatch(ElevatedHelper::Operation operation, const QList<ProcessEntry> &processes);
+};
+
+// 助手进程的服务端：只处理目标目录命中的进程及其子孙进程、目录声明的守护进程，其余请求一律拒绝
+// 没有连接且持续 idleTimeoutMs 无请求时退出
+class ElevatedHelperServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum ListenResult {
+        Listening,
+        AlreadyRunning,  // 已有助手在监听该名称，调用方应直接退出
+        ListenFailed
+    };
+
+    explicit ElevatedHelperServer(const TargetCatalog &catalog, QObject *parent = nullptr);
+    ~ElevatedHelperServer() override;
+
+    void setIdleTimeout(int msecs);
+    ListenResult listen(const QString &name, QString *errorString = nullptr);
+
+signals:
+    void logUpdated(const QString &log);
+    void idleTimeout();
+
+private:
+    TargetMatcher m_matcher;
+    NativeProcessTerminator m_terminator;
+    ProcessTableCache m_processCache;
+    QLocalServer *m_server;
+    QTimer m_idleTimer;
+    QHash<QLocalSocket *, QByteArray> m_buffers;  // 每个连接未处理完的字节
+
+    void onNewConnection();
+    void onReadyRead(QLocalSocket *socket);
+    QList<KillResult> handle(ElevatedHelper::Operation operation, const QList<ProcessEntry> &processes);
+    // 进程自身或任一祖先命中目标目录，或进程为目录声明的守护进程
+    bool isAllowed(const ProcessSnapshot &snapshot, const ProcessEntry &process) const;
+};
+
+#endif // ELEVATEDHELPER_H
@@ -0,0 +1,48 @@
+# 检测/关闭引擎：进程快照、目标目录匹配、终止后端与调度、守护线程、持久化日志、特权助手通信、机房协同
+# 只依赖 QtCore 与 QtNetwork（特权助手的本地套接字、机房协同的 TCP 连接），图形界面（jiyu.pro）、命令行版本（cli/cli.pro）
+# 与特权助手（helper/helper.pro）共用同一份源码
+
+QT *= network
+win32: LIBS += -lshell32 -ladvapi32
+
+INCLUDEPATH += $$PWD
+
+SOURCES += \
+    $$PWD/cancellationtoken.cpp \
+    $$PWD/elevatedhelper.cpp \
+    $$PWD/fleet.cpp \
+    $$PWD/frozenset.cpp \
+    $$PWD/guardiangraph.cpp \
+    $$PWD/killprocessthread.cpp \
+    $$PWD/killprogress.cpp \
+    $$PWD/killscheduler.cpp \
+    $$PWD/killtrace.cpp \
+    $$PWD/logchannel.cpp \
+    $$PWD/messageframe.cpp \
+    $$PWD/processsnapshot.cpp \
+    $$PWD/processterminator.cpp \
+    $$PWD/processwatchdog.cpp \
+    $$PWD/processwaiter.cpp \
+    $$PWD/respawnpredictor.cpp \
+    $$PWD/sweepjournal.cpp \
+    $$PWD/targetcatalog.cpp
+
+HEADERS += \
+    $$PWD/cancellationtoken.h \
+    $$PWD/elevatedhelper.h \
+    $$PWD/fleet.h \
+    $$PWD/frozenset.h \
+    $$PWD/guardiangraph.h \
+    $$PWD/killprocessthread.h \
+    $$PWD/killprogress.h \
+    $$PWD/killscheduler.h \
+    $$PWD/killtrace.h \
+    $$PWD/logchannel.h \
+    $$PWD/messageframe.h \
+    $$PWD/processsnapshot.h \
+    $$PWD/processterminator.h \
+    $$PWD/processwatchdog.h \
+    $$PWD/processwaiter.h \
+    $$PWD/respawnpredictor.h \
+    $$PWD/sweepjournal.h \
+    $$PWD/targetcatalog.h
@@ -0,0 +1,611 @@
+#include "fleet.h"
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QHostAddress>
+#include <QMessageAuthenticationCode>
+#include <QRandomGenerator>
+#include <QSysInfo>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include "killprocessthread.h"
+#include "messageframe.h"
+#include "processsnapshot.h"
+#include "processwatchdog.h"
+
+namespace {
+
+constexpr quint32 kMagic = 0x4A59464C;   // "JYFL"
+constexpr quint16 kProtocolVersion = 1;
+constexpr QDataStream::Version kStreamVersion = QDataStream::Qt_6_0;
+// 协同消息都很小，超过此长度视为非法数据
+constexpr quint32 kMaxMessageSize = 4096;
+constexpr int kNonceSize = 16;
+// 关闭进行中回传进度的间隔（只在计数变化时发送）
+constexpr int kProgressIntervalMs = 100;
+// 节点同时保持的连接上限；协调端每次命令只建一条连接，超出的多为扫描或滥用
+constexpr int kMaxConnections = 64;
+// 连接建立后须在此时限内下发命令，否则断开
+constexpr int kIdleTimeoutMs = 10000;
+constexpr int kIdleCheckIntervalMs = 1000;
+
+void writeHeader(QDataStream &stream, FleetProtocol::MessageType type)
+{
+    stream.setVersion(kStreamVersion);
+    stream << kMagic << kProtocolVersion << quint8(type);
+}
+
+bool readHeader(QDataStream &stream, FleetProtocol::MessageType expected)
+{
+    stream.setVersion(kStreamVersion);
+    quint32 magic = 0;
+    quint16 version = 0;
+    quint8 type = 0;
+    stream >> magic >> version >> type;
+    return stream.status() == QDataStream::Ok && magic == kMagic && version == kProtocolVersion && type == quint8(expected);
+}
+
+bool isValidCommand(quint8 command)
+{
+    return command >= quint8(FleetCommand::Detect) && command <= quint8(FleetCommand::Unwatch);
+}
+
+// 计数是否相同（不含耗时）：相同则不必再回传进度
+bool sameCounters(const FleetStatus &left, const FleetStatus &right)
+{
+    return left.state == right.state && left.round == right.round && left.found == right.found
+           && left.signalled == right.signalled && left.exited == right.exited && left.failed == right.failed;
+}
+
+} // namespace
+
+bool FleetEndpoint::parse(const QString &text, FleetEndpoint &endpoint)
+{
+    const QString trimmed = text.trimmed();
+    endpoint.host = trimmed;
+    endpoint.port = FleetProtocol::kDefaultPort;
+    // 只有一个冒号时视为 host:port（不带端口的 IPv6 地址原样作为主机）
+    const int separator = trimmed.lastIndexOf(':');
+    if (separator >= 0 && trimmed.indexOf(':') == separator) {
+        bool ok = false;
+        const uint port = trimmed.mid(separator + 1).toUInt(&ok);
+        if (!ok || port == 0 || port > 65535) {
+            return false;
+        }
+        endpoint.host = trimmed.left(separator);
+        endpoint.port = quint16(port);
+    }
+    return !endpoint.host.isEmpty();
+}
+
+QByteArray FleetProtocol::encodeHello(const QByteArray &nonce, const QString &hostName)
+{
+    QByteArray payload;
+    QDataStream stream(&payload, QIODevice::WriteOnly);
+    writeHeader(stream, Hello);
+    stream << nonce << hostName;
+    return payload;
+}
+
+QByteArray FleetProtocol::encodeCommand(FleetCommand command, const FleetCommandOptions &options, const QByteArray &mac)
+{
+    QByteArray payload;
+    QDataStream stream(&payload, QIODevice::WriteOnly);
+    writeHeader(stream, Command);
+    stream << quint8(command) << options.maxRounds << options.quietPeriodMs << mac;
+    return payload;
+}
+
+QByteArray FleetProtocol::encodeStatus(const FleetStatus &status)
+{
+    QByteArray payload;
+    QDataStream stream(&payload, QIODevice::WriteOnly);
+    writeHeader(stream, Status);
+    stream << quint8(status.state) << status.watching << status.round << status.found << status.signalled
+           << status.exited << status.failed << status.survivors << status.elapsedMs;
+    return payload;
+}
+
+bool FleetProtocol::decodeType(const QByteArray &payload, MessageType &type)
+{
+    QDataStream stream(payload);
+    stream.setVersion(kStreamVersion);
+    quint32 magic = 0;
+    quint16 version = 0;
+    quint8 code = 0;
+    stream >> magic >> version >> code;
+    if (stream.status() != QDataStream::Ok || magic != kMagic || version != kProtocolVersion
+        || code < quint8(Hello) || code > quint8(Status)) {
+        return false;
+    }
+    type = MessageType(code);
+    return true;
+}
+
+bool FleetProtocol::decodeHello(const QByteArray &payload, QByteArray &nonce, QString &hostName)
+{
+    QDataStream stream(payload);
+    if (!readHeader(stream, Hello)) {
+        return false;
+    }
+    stream >> nonce >> hostName;
+    return stream.status() == QDataStream::Ok && stream.atEnd() && nonce.size() == kNonceSize;
+}
+
+bool FleetProtocol::decodeCommand(const QByteArray &payload, FleetCommand &command, FleetCommandOptions &options, QByteArray &mac)
+{
+    QDataStream stream(payload);
+    if (!readHeader(stream, Command)) {
+        return false;
+    }
+    quint8 code = 0;
+    stream >> code >> options.maxRounds >> options.quietPeriodMs >> mac;
+    if (stream.status() != QDataStream::Ok || !stream.atEnd() || !isValidCommand(code)) {
+        return false;
+    }
+    command = FleetCommand(code);
+    return true;
+}
+
+bool FleetProtocol::decodeStatus(const QByteArray &payload, FleetStatus &status)
+{
+    QDataStream stream(payload);
+    if (!readHeader(stream, Status)) {
+        return false;
+    }
+    quint8 state = 0;
+    stream >> state >> status.watching >> status.round >> status.found >> status.signalled
+           >> status.exited >> status.failed >> status.survivors >> status.elapsedMs;
+    if (stream.status() != QDataStream::Ok || !stream.atEnd() || state < FleetStatus::Running || state > FleetStatus::Busy) {
+        return false;
+    }
+    status.state = FleetStatus::State(state);
+    return true;
+}
+
+QByteArray FleetProtocol::commandMac(const QByteArray &key, const QByteArray &nonce, FleetCommand command,
+                                     const FleetCommandOptions &options)
+{
+    if (key.isEmpty()) {
+        return QByteArray();
+    }
+    QByteArray message;
+    QDataStream stream(&message, QIODevice::WriteOnly);
+    stream.setVersion(kStreamVersion);
+    stream << nonce << quint8(command) << options.maxRounds << options.quietPeriodMs;
+    return QMessageAuthenticationCode::hash(message, key, QCryptographicHash::Sha256);
+}
+
+bool FleetProtocol::verifyCommand(const QByteArray &key, const QByteArray &nonce, FleetCommand command,
+                                  const FleetCommandOptions &options, const QByteArray &mac)
+{
+    const QByteArray expected = commandMac(key, nonce, command, options);
+    if (mac.size() != expected.size()) {
+        return false;
+    }
+    // 逐字节累积差异，耗时与第一个不同字节的位置无关
+    quint8 difference = 0;
+    for (qsizetype i = 0; i < expected.size(); ++i) {
+        difference |= quint8(mac.at(i)) ^ quint8(expected.at(i));
+    }
+    return difference == 0;
+}
+
+FleetNode::FleetNode(const TargetCatalog &catalog, QObject *parent)
+    : QObject(parent)
+    , m_catalog(catalog)
+    , m_matcher(catalog)
+    , m_server(new QTcpServer(this))
+    , m_respawnPredictor(std::make_shared<RespawnPredictor>())
+{
+    connect(m_server, &QTcpServer::newConnection, this, &FleetNode::onNewConnection);
+    m_progressTimer.setInterval(kProgressIntervalMs);
+    connect(&m_progressTimer, &QTimer::timeout, this, &FleetNode::sendProgress);
+    m_idleTimer.setInterval(kIdleCheckIntervalMs);
+    connect(&m_idleTimer, &QTimer::timeout, this, &FleetNode::closeIdleConnections);
+}
+
+FleetNode::~FleetNode()
+{
+    // 取消后线程在几毫秒内结束
+    if (m_sweep) {
+        m_sweep->cancel();
+        m_sweep->wait();
+    }
+    if (m_watchdog) {
+        m_watchdog->stop();
+    }
+}
+
+void FleetNode::setKey(const QByteArray &key)
+{
+    m_key = key;
+}
+
+void FleetNode::setInsecure(bool insecure)
+{
+    m_insecure = insecure;
+}
+
+bool FleetNode::listen(const QString &address, quint16 port, QString *errorString)
+{
+    auto fail = [errorString](const QString &message) {
+        if (errorString) {
+            *errorString = message;
+        }
+        return false;
+    };
+
+    const bool authenticated = !m_key.isEmpty() || m_insecure;
+    QHostAddress hostAddress;
+    if (address.isEmpty()) {
+        hostAddress = QHostAddress(authenticated ? QHostAddress::Any : QHostAddress::LocalHost);
+    } else if (!hostAddress.setAddress(address)) {
+        return fail(QString("无效的监听地址：%1").arg(address));
+    }
+    // 没有密钥时任何能连上节点的人都能下发命令，只允许本机连接
+    if (!authenticated && !hostAddress.isLoopback()) {
+        return fail("未设置密钥时只能监听回环地址");
+    }
+    if (!m_server->listen(hostAddress, port)) {
+        return fail(m_server->errorString());
+    }
+    m_idleTimer.start();
+    return true;
+}
+
+quint16 FleetNode::port() const
+{
+    return m_server->serverPort();
+}
+
+void FleetNode::onNewConnection()
+{
+    while (QTcpSocket *socket = m_server->nextPendingConnection()) {
+        if (m_connections.size() >= kMaxConnections) {
+            emit logUpdated(QString("连接数已达上限（%1），拒绝来自 %2 的连接").arg(kMaxConnections).arg(socket->peerAddress().toString()));
+            socket->abort();
+            socket->deleteLater();
+            continue;
+        }
+        Connection connection;
+        connection.accepted.start();
+        connection.nonce.resize(kNonceSize);
+        QRandomGenerator::system()->fillRange(reinterpret_cast<quint32 *>(connection.nonce.data()), kNonceSize / 4);
+        m_connections.insert(socket, connection);
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket]() {
+            onReadyRead(socket);
+        });
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket]() {
+            m_connections.remove(socket);
+            socket->deleteLater();
+        });
+        socket->write(MessageFrame::wrap(FleetProtocol::encodeHello(connection.nonce, QSysInfo::machineHostName())));
+    }
+}
+
+void FleetNode::onReadyRead(QTcpSocket *socket)
+{
+    auto connection = m_connections.find(socket);
+    if (connection == m_connections.end()) {
+        return;
+    }
+    connection->buffer += socket->readAll();
+
+    QByteArray payload;
+    bool invalid = false;
+    while (!invalid && MessageFrame::take(connection->buffer, payload, invalid, kMaxMessageSize)) {
+        FleetProtocol::MessageType type;
+        FleetCommand command;
+        FleetCommandOptions options;
+        QByteArray mac;
+        if (connection->commanded || !FleetProtocol::decodeType(payload, type) || type != FleetProtocol::Command
+            || !FleetProtocol::decodeCommand(payload, command, options, mac)) {
+            invalid = true;
+            break;
+        }
+        if (!FleetProtocol::verifyCommand(m_key, connection->nonce, command, options, mac)) {
+            emit logUpdated(QString("拒绝来自 %1 的命令：认证失败").arg(socket->peerAddress().toString()));
+            FleetStatus status;
+            status.state = FleetStatus::Rejected;
+            finish(socket, status);
+            return;
+        }
+        connection->commanded = true;
+        // 执行后连接可能已关闭（connection 随之失效），其后的数据不再处理
+        execute(socket, command, options);
+        return;
+    }
+    if (invalid) {
+        emit logUpdated(QString("来自 %1 的数据无效，断开连接").arg(socket->peerAddress().toString()));
+        FleetStatus status;
+        status.state = FleetStatus::Rejected;
+        finish(socket, status);
+    }
+}
+
+void FleetNode::closeIdleConnections()
+{
+    QList<QTcpSocket *> idle;
+    for (auto it = m_connections.constBegin(); it != m_connections.constEnd(); ++it) {
+        if (!it->commanded && it->accepted.hasExpired(kIdleTimeoutMs)) {
+            idle.append(it.key());
+        }
+    }
+    for (QTcpSocket *socket : idle) {
+        emit logUpdated(QString("来自 %1 的连接 %2 毫秒内未下发命令，断开连接")
+                            .arg(socket->peerAddress().toString())
+                            .arg(kIdleTimeoutMs));
+        socket->abort();  // 触发 disconnected，连接随之移除
+    }
+}
+
+void FleetNode::execute(QTcpSocket *socket, FleetCommand command, const FleetCommandOptions &options)
+{
+    QElapsedTimer timer;
+    timer.start();
+    FleetStatus status;
+    status.state = FleetStatus::Finished;
+
+    switch (command) {
+    case FleetCommand::Detect:
+        status.found = quint32(m_matcher.matchAll(ProcessSnapshot::capture()).size());
+        status.survivors = status.found;
+        break;
+    case FleetCommand::Sweep:
+        if (m_sweep) {
+            status.state = FleetStatus::Busy;
+            break;
+        }
+        startSweep(socket, options);
+        return;  // 进度与最终状态由关闭任务回传
+    case FleetCommand::Watch:
+        if (!m_watchdog) {
+            m_watchdog = new ProcessWatchdog(m_catalog, this);
+            m_watchdog->setRespawnPredictor(m_respawnPredictor);
+            connect(m_watchdog, &ProcessWatchdog::logUpdated, this, &FleetNode::logUpdated);
+            m_watchdog->start();
+            emit logUpdated("协调端开启了守护模式");
+        }
+        break;
+    case FleetCommand::Unwatch:
+        if (m_watchdog) {
+            m_watchdog->stop();
+            delete m_watchdog;
+            m_watchdog = nullptr;
+            emit logUpdated("协调端关闭了守护模式");
+        }
+        break;
+    }
+
+    status.watching = m_watchdog != nullptr;
+    status.elapsedMs = quint32(timer.elapsed());
+    finish(socket, status);
+}
+
+void FleetNode::startSweep(QTcpSocket *socket, const FleetCommandOptions &options)
+{
+    SweepPolicy policy;
+    policy.maxRounds = qMax(1, int(options.maxRounds));
+    policy.quietPeriodMs = options.quietPeriodMs;
+
+    m_sweep = new KillProcessThread(m_catalog, this);
+    m_sweep->setMode(KillProcessThread::ForceSweep);
+    m_sweep->setSweepPolicy(policy);
+    m_sweep->setRespawnPredictor(m_respawnPredictor);
+    connect(m_sweep, &KillProcessThread::logUpdated, this, &FleetNode::logUpdated);
+    connect(m_sweep, &KillProcessThread::finishedKill, this, &FleetNode::onSweepFinished);
+    m_sweepClient = socket;
+    m_lastSent = FleetStatus();
+    m_sweepTimer.start();
+    m_progressTimer.start();
+    emit logUpdated(QString("收到来自 %1 的全量关闭命令").arg(socket->peerAddress().toString()));
+    m_sweep->start();
+}
+
+void FleetNode::sendProgress()
+{
+    if (!m_sweep) {
+        return;
+    }
+    const KillProgress::Counters counters = m_sweep->progress()->sample();
+    FleetStatus status;
+    status.state = FleetStatus::Running;
+    status.watching = m_watchdog != nullptr;
+    status.round = quint16(counters.round);
+    status.found = quint32(counters.found);
+    status.signalled = quint32(counters.signalled);
+    status.exited = quint32(counters.exited);
+    status.failed = quint32(counters.failed);
+    status.elapsedMs = quint32(m_sweepTimer.elapsed());
+    if (sameCounters(status, m_lastSent)) {
+        return;
+    }
+    m_lastSent = status;
+    send(m_sweepClient, status);
+}
+
+void FleetNode::onSweepFinished()
+{
+    m_progressTimer.stop();
+    m_sweep->wait();  // 信号在 run() 末尾发出，线程即将结束
+
+    const KillProgress::Counters counters = m_sweep->progress()->sample();
+    FleetStatus status;
+    status.state = FleetStatus::Finished;
+    status.watching = m_watchdog != nullptr;
+    status.round = quint16(m_sweep->roundsExecuted());
+    status.found = quint32(counters.found);
+    status.signalled = quint32(counters.signalled);
+    status.exited = quint32(counters.exited);
+    status.failed = quint32(counters.failed);
+    status.survivors = quint32(countSurvivors());
+    status.elapsedMs = quint32(m_sweepTimer.elapsed());
+    finish(m_sweepClient, status);
+    emit logUpdated(QString("全量关闭完成：%1轮，确认退出 %2 个，仍在运行 %3 个")
+                        .arg(status.round)
+                        .arg(status.exited)
+                        .arg(status.survivors));
+
+    m_sweep->deleteLater();
+    m_sweep = nullptr;
+    m_sweepClient = nullptr;
+}
+
+int FleetNode::countSurvivors() const
+{
+    return int(m_matcher.matchAll(ProcessSnapshot::capture()).size());
+}
+
+void FleetNode::send(QTcpSocket *socket, const FleetStatus &status)
+{
+    // 发起方已断开时任务照常完成，只是不再回传
+    if (socket && socket->state() == QAbstractSocket::ConnectedState) {
+        socket->write(MessageFrame::wrap(FleetProtocol::encodeStatus(status)));
+    }
+}
+
+void FleetNode::finish(QTcpSocket *socket, const FleetStatus &status)
+{
+    send(socket, status);
+    if (socket) {
+        socket->disconnectFromHost();  // 待发送的数据写完后再断开
+    }
+}
+
+FleetCoordinator::FleetCoordinator(QObject *parent)
+    : QObject(parent)
+{
+    m_deadlineTimer.setSingleShot(true);
+    connect(&m_deadlineTimer, &QTimer::timeout, this, [this]() {
+        const QList<QTcpSocket *> sockets = m_connections.keys();
+        for (QTcpSocket *socket : sockets) {
+            finishNode(socket, QString("%1毫秒内未完成").arg(m_timeoutMs));
+        }
+    });
+}
+
+FleetCoordinator::~FleetCoordinator() = default;
+
+void FleetCoordinator::setKey(const QByteArray &key)
+{
+    m_key = key;
+}
+
+void FleetCoordinator::setTimeout(int msecs)
+{
+    m_timeoutMs = msecs;
+}
+
+void FleetCoordinator::run(const QList<FleetEndpoint> &nodes, FleetCommand command, const FleetCommandOptions &options)
+{
+    m_command = command;
+    m_options = options;
+    m_results.clear();
+    m_pending = int(nodes.size());
+    m_elapsed.start();
+    if (nodes.isEmpty()) {
+        QTimer::singleShot(0, this, &FleetCoordinator::finished);
+        return;
+    }
+
+    // 所有连接同时发起，由事件循环并发处理
+    for (int i = 0; i < nodes.size(); ++i) {
+        FleetNodeResult result;
+        result.endpoint = nodes.at(i);
+        m_results.append(result);
+
+        QTcpSocket *socket = new QTcpSocket(this);
+        Connection connection;
+        connection.node = i;
+        m_connections.insert(socket, connection);
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket]() {
+            onReadyRead(socket);
+        });
+        connect(socket, &QTcpSocket::errorOccurred, this, [this, socket]() {
+            finishNode(socket, socket->errorString());
+        });
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket]() {
+            finishNode(socket, "连接在命令完成前断开");
+        });
+        socket->connectToHost(nodes.at(i).host, nodes.at(i).port);
+    }
+    m_deadlineTimer.start(m_timeoutMs);
+}
+
+void FleetCoordinator::onReadyRead(QTcpSocket *socket)
+{
+    auto connection = m_connections.find(socket);
+    if (connection == m_connections.end()) {
+        return;
+    }
+    connection->buffer += socket->readAll();
+
+    QByteArray payload;
+    bool invalid = false;
+    while (MessageFrame::take(connection->buffer, payload, invalid, kMaxMessageSize)) {
+        FleetNodeResult &result = m_results[connection->node];
+        FleetProtocol::MessageType type;
+        if (!FleetProtocol::decodeType(payload, type)) {
+            invalid = true;
+            break;
+        }
+        if (type == FleetProtocol::Hello && !connection->commandSent) {
+            QByteArray nonce;
+            if (!FleetProtocol::decodeHello(payload, nonce, result.hostName)) {
+                invalid = true;
+                break;
+            }
+            const QByteArray mac = FleetProtocol::commandMac(m_key, nonce, m_command, m_options);
+            socket->write(MessageFrame::wrap(FleetProtocol::encodeCommand(m_command, m_options, mac)));
+            connection->commandSent = true;
+        } else if (type == FleetProtocol::Status && connection->commandSent) {
+            FleetStatus status;
+            if (!FleetProtocol::decodeStatus(payload, status)) {
+                invalid = true;
+                break;
+            }
+            result.status = status;
+            emit statusReceived(connection->node, status);
+            if (status.isFinal()) {
+                result.completed = true;
+                QString error;
+                if (status.state == FleetStatus::Rejected) {
+                    error = "节点拒绝了命令（认证失败或数据无效）";
+                } else if (status.state == FleetStatus::Busy) {
+                    error = "节点已有关闭任务在运行";
+                }
+                finishNode(socket, error);
+                return;
+            }
+        } else {
+            invalid = true;
+            break;
+        }
+    }
+    if (invalid) {
+        finishNode(socket, "节点返回了无效的数据");
+    }
+}
+
+void FleetCoordinator::finishNode(QTcpSocket *socket, const QString &error)
+{
+    const auto connection = m_connections.constFind(socket);
+    if (connection == m_connections.constEnd()) {
+        return;  // 已经结束（如出错后又收到断开通知）
+    }
+    FleetNodeResult &result = m_results[connection->node];
+    if (!error.isEmpty()) {
+        result.error = error;
+    }
+    result.latencyMs = m_elapsed.elapsed();
+    m_connections.erase(connection);
+
+    socket->disconnect(this);
+    socket->abort();
+    socket->deleteLater();
+
+    if (--m_pending == 0) {
+        m_deadlineTimer.stop();
+        emit finished();
+    }
+}
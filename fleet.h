@@ -0,0 +1,212 @@
+#ifndef FLEET_H
+#define FLEET_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <QTimer>
+#include <memory>
+#include "targetcatalog.h"
+
+class QTcpServer;
+class QTcpSocket;
+class KillProcessThread;
+class ProcessWatchdog;
+class RespawnPredictor;
+
+// 机房协同模式：协调端通过 TCP 同时向所有机器下发命令，各机器在本机执行检测/关闭并回传紧凑的二进制状态
+// 连接、命令与状态全部由事件循环异步处理，100 台机器的一次关闭耗时约等于最慢的单台机器
+
+// 下发给节点的命令
+enum class FleetCommand : quint8 {
+    Detect = 1,   // 检测一次，回传命中数
+    Sweep = 2,    // 执行一次全量关闭（自适应轮次），运行期间持续回传进度
+    Watch = 3,    // 开启守护模式
+    Unwatch = 4   // 关闭守护模式
+};
+
+struct FleetCommandOptions
+{
+    quint16 maxRounds = 10;      // Sweep 的轮次上限
+    quint16 quietPeriodMs = 300; // Sweep 的静默期
+};
+
+// 节点回传的状态（定长二进制，每帧约 40 字节）
+struct FleetStatus
+{
+    enum State : quint8 {
+        Running = 1,   // Sweep 进行中（进度帧）
+        Finished = 2,  // 命令已完成（最终帧）
+        Rejected = 3,  // 认证失败或命令无效（最终帧）
+        Busy = 4       // 本机已有关闭任务在运行（最终帧）
+    };
+
+    State state = Running;
+    bool watching = false;    // 节点当前是否处于守护模式
+    quint16 round = 0;
+    quint32 found = 0;        // 已排入关闭的进程（Detect 为命中数）
+    quint32 signalled = 0;
+    quint32 exited = 0;
+    quint32 failed = 0;
+    quint32 survivors = 0;    // 命令结束后仍在运行的目标进程
+    quint32 elapsedMs = 0;    // 节点收到命令至今的耗时
+
+    bool isFinal() const { return state != Running; }
+};
+
+struct FleetEndpoint
+{
+    QString host;
+    quint16 port = 0;
+
+    // "host:port" 或 "host"（使用默认端口）
+    static bool parse(const QString &text, FleetEndpoint &endpoint);
+    QString toString() const { return QString("%1:%2").arg(host).arg(port); }
+};
+
+// 协议编解码（节点与协调端共用）；分帧见 MessageFrame
+class FleetProtocol
+{
+public:
+    static constexpr quint16 kDefaultPort = 47653;
+
+    enum MessageType : quint8 {
+        Hello = 1,    // 节点 → 协调端：连接后立即发送，携带一次性随机数与主机名
+        Command = 2,  // 协调端 → 节点：命令 + HMAC-SHA256(密钥, 随机数 + 命令)
+        Status = 3    // 节点 → 协调端
+    };
+
+    static QByteArray encodeHello(const QByteArray &nonce, const QString &hostName);
+    static QByteArray encodeCommand(FleetCommand command, const FleetCommandOptions &options, const QByteArray &mac);
+    static QByteArray encodeStatus(const FleetStatus &status);
+    // 读取消息类型，其余字段按类型分别解码
+    static bool decodeType(const QByteArray &payload, MessageType &type);
+    static bool decodeHello(const QByteArray &payload, QByteArray &nonce, QString &hostName);
+    static bool decodeCommand(const QByteArray &payload, FleetCommand &command, FleetCommandOptions &options, QByteArray &mac);
+    static bool decodeStatus(const QByteArray &payload, FleetStatus &status);
+
+    // 命令认证码；密钥为空时返回空
+    static QByteArray commandMac(const QByteArray &key, const QByteArray &nonce, FleetCommand command,
+                                 const FleetCommandOptions &options);
+    // 校验命令认证码（定长时间比较）；密钥为空时只接受空认证码（仅限 FleetNode::setInsecure 的场景）
+    static bool verifyCommand(const QByteArray &key, const QByteArray &nonce, FleetCommand command,
+                              const FleetCommandOptions &options, const QByteArray &mac);
+};
+
+// 节点：监听 TCP 端口，执行协调端下发的命令；同一时刻只运行一个关闭任务
+class FleetNode : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FleetNode(const TargetCatalog &catalog, QObject *parent = nullptr);
+    ~FleetNode() override;
+
+    // 共享密钥；未设置时节点只能监听回环地址
+    void setKey(const QByteArray &key);
+    // 允许未设置密钥时监听任意地址（不校验命令，仅适用于隔离的测试环境）
+    void setInsecure(bool insecure);
+    // address 为空时：设置了密钥则监听所有地址，否则只监听回环地址
+    bool listen(const QString &address, quint16 port, QString *errorString = nullptr);
+    quint16 port() const;
+
+signals:
+    void logUpdated(const QString &log);
+
+private:
+    struct Connection
+    {
+        QByteArray buffer;
+        QByteArray nonce;
+        bool commanded = false;  // 每个连接只接受一条命令
+        QElapsedTimer accepted;  // 连接建立至今（未下发命令的连接超时后断开）
+    };
+
+    TargetCatalog m_catalog;
+    TargetMatcher m_matcher;
+    QByteArray m_key;
+    bool m_insecure = false;
+    QTcpServer *m_server;
+    QHash<QTcpSocket *, Connection> m_connections;
+    QTimer m_idleTimer;                      // 定期断开迟迟不下发命令的连接
+    KillProcessThread *m_sweep = nullptr;
+    QPointer<QTcpSocket> m_sweepClient;      // 发起当前关闭任务的连接（可能已断开）
+    QElapsedTimer m_sweepTimer;
+    QTimer m_progressTimer;                  // 关闭进行中按固定间隔采样进度并回传
+    FleetStatus m_lastSent;
+    ProcessWatchdog *m_watchdog = nullptr;
+    std::shared_ptr<RespawnPredictor> m_respawnPredictor;  // 关闭任务与守护模式共享
+
+    void onNewConnection();
+    void onReadyRead(QTcpSocket *socket);
+    void closeIdleConnections();
+    // 回传最终状态后关闭连接（每个连接只执行一条命令）
+    void finish(QTcpSocket *socket, const FleetStatus &status);
+    void execute(QTcpSocket *socket, FleetCommand command, const FleetCommandOptions &options);
+    void startSweep(QTcpSocket *socket, const FleetCommandOptions &options);
+    void onSweepFinished();
+    void sendProgress();
+    int countSurvivors() const;
+    void send(QTcpSocket *socket, const FleetStatus &status);
+};
+
+// 单个节点的执行结果
+struct FleetNodeResult
+{
+    FleetEndpoint endpoint;
+    QString hostName;       // 节点上报的主机名
+    FleetStatus status;     // 最近一次收到的状态
+    bool completed = false; // 收到了最终状态
+    QString error;          // 连接失败、超时或协议错误
+    qint64 latencyMs = 0;   // 从发起连接到收到最终状态
+};
+
+// 协调端：并发连接所有节点、下发同一条命令并汇总结果
+class FleetCoordinator : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FleetCoordinator(QObject *parent = nullptr);
+    ~FleetCoordinator() override;
+
+    void setKey(const QByteArray &key);
+    // 整个命令的时间上限（超时未完成的节点记为失败）
+    void setTimeout(int msecs);
+
+    // 异步执行；完成后发出 finished()
+    void run(const QList<FleetEndpoint> &nodes, FleetCommand command, const FleetCommandOptions &options = FleetCommandOptions());
+    const QList<FleetNodeResult> &results() const { return m_results; }
+
+signals:
+    void statusReceived(int node, const FleetStatus &status);
+    void finished();
+
+private:
+    struct Connection
+    {
+        int node = -1;
+        QByteArray buffer;
+        bool commandSent = false;
+    };
+
+    QByteArray m_key;
+    int m_timeoutMs = 30000;
+    FleetCommand m_command = FleetCommand::Detect;
+    FleetCommandOptions m_options;
+    QList<FleetNodeResult> m_results;
+    QHash<QTcpSocket *, Connection> m_connections;
+    QElapsedTimer m_elapsed;
+    QTimer m_deadlineTimer;
+    int m_pending = 0;
+
+    void onReadyRead(QTcpSocket *socket);
+    // 结束一个节点（error 为空表示正常完成）
+    void finishNode(QTcpSocket *socket, const QString &error = QString());
+};
+
+#endif // FLEET_H
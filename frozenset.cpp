@@ -0,0 +1,167 @@
+#include "frozenset.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QSet>
+#include <QStandardPaths>
+
+namespace {
+
+constexpr int kFormatVersion = 1;
+
+QMutex mutex;       // 保护读改写与 customPath
+QString customPath;
+
+QString currentPath()
+{
+    if (!customPath.isEmpty()) {
+        return customPath;
+    }
+    return QDir(QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation)).filePath("jiyu/frozen.json");
+}
+
+QPair<qint64, quint64> keyOf(const FrozenSet::Entry &entry)
+{
+    return qMakePair(entry.pid, entry.startTime);
+}
+
+// 文件缺失或损坏时视为空集合（最坏情况是少恢复几个进程，不影响冻结本身）
+QList<FrozenSet::Entry> read(const QString &path)
+{
+    QList<FrozenSet::Entry> entries;
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return entries;
+    }
+    const QJsonObject object = QJsonDocument::fromJson(file.readAll()).object();
+    if (object.value("version").toInt() != kFormatVersion) {
+        return entries;
+    }
+    for (const QJsonValue &value : object.value("processes").toArray()) {
+        const QJsonObject process = value.toObject();
+        FrozenSet::Entry entry;
+        // 启动时间（Windows 为 FILETIME）超出 double 的精确范围，以字符串保存
+        entry.pid = process.value("pid").toString().toLongLong();
+        entry.startTime = process.value("startTime").toString().toULongLong();
+        entry.product = process.value("product").toString();
+        entry.name = process.value("name").toString();
+        entry.stage = process.value("stage").toInt();
+        entry.guardian = process.value("guardian").toBool();
+        if (entry.pid > 0) {
+            entries.append(entry);
+        }
+    }
+    return entries;
+}
+
+bool write(const QString &path, const QList<FrozenSet::Entry> &entries, QString *errorString)
+{
+    QJsonArray processes;
+    for (const FrozenSet::Entry &entry : entries) {
+        QJsonObject process;
+        process.insert("pid", QString::number(entry.pid));
+        process.insert("startTime", QString::number(entry.startTime));
+        process.insert("product", entry.product);
+        process.insert("name", entry.name);
+        process.insert("stage", entry.stage);
+        process.insert("guardian", entry.guardian);
+        processes.append(process);
+    }
+    QJsonObject object;
+    object.insert("version", kFormatVersion);
+    object.insert("processes", processes);
+
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        if (errorString) {
+            *errorString = file.errorString();
+        }
+        return false;
+    }
+    file.write(QJsonDocument(object).toJson(QJsonDocument::Compact));
+    if (!file.commit()) {
+        if (errorString) {
+            *errorString = file.errorString();
+        }
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+QString FrozenSet::path()
+{
+    QMutexLocker locker(&mutex);
+    return currentPath();
+}
+
+void FrozenSet::setPath(const QString &path)
+{
+    QMutexLocker locker(&mutex);
+    customPath = path;
+}
+
+QList<FrozenSet::Entry> FrozenSet::prune(const ProcessSnapshot &snapshot)
+{
+    QMutexLocker locker(&mutex);
+    const QString path = currentPath();
+    const QList<Entry> entries = read(path);
+    QList<Entry> alive;
+    for (const Entry &entry : entries) {
+        const ProcessEntry *process = snapshot.process(entry.pid);
+        if (process && process->startTime == entry.startTime) {
+            alive.append(entry);
+        }
+    }
+    if (alive.size() != entries.size()) {
+        write(path, alive, nullptr);
+    }
+    return alive;
+}
+
+bool FrozenSet::add(const QList<Entry> &entries, QString *errorString)
+{
+    if (entries.isEmpty()) {
+        return true;
+    }
+    QMutexLocker locker(&mutex);
+    const QString path = currentPath();
+    QList<Entry> current = read(path);
+    QSet<QPair<qint64, quint64>> present;
+    for (const Entry &entry : current) {
+        present.insert(keyOf(entry));
+    }
+    for (const Entry &entry : entries) {
+        if (!present.contains(keyOf(entry))) {
+            present.insert(keyOf(entry));
+            current.append(entry);
+        }
+    }
+    return write(path, current, errorString);
+}
+
+bool FrozenSet::remove(const QList<Entry> &entries, QString *errorString)
+{
+    if (entries.isEmpty()) {
+        return true;
+    }
+    QMutexLocker locker(&mutex);
+    const QString path = currentPath();
+    QSet<QPair<qint64, quint64>> removed;
+    for (const Entry &entry : entries) {
+        removed.insert(keyOf(entry));
+    }
+    QList<Entry> current = read(path);
+    current.removeIf([&removed](const Entry &entry) {
+        return removed.contains(keyOf(entry));
+    });
+    return write(path, current, errorString);
+}
@@ -0,0 +1,38 @@
+#ifndef FROZENSET_H
+#define FROZENSET_H
+
+#include <QList>
+#include <QString>
+#include "processsnapshot.h"
+
+// 冻结集合：本工具挂起的进程（PID + 启动时间），持久化到文件，解冻可能在另一个进程（图形界面/命令行）中进行
+// 解冻只恢复集合中且仍是同一进程的条目；冻结跳过已在集合中的进程——Windows 的挂起按次数累加，
+// 重复挂起需要同样次数的恢复才能让进程继续运行
+// 与 SweepJournal 一样是进程级单例，各函数可在任意线程中调用（读改写整体加锁）
+class FrozenSet
+{
+public:
+    struct Entry
+    {
+        qint64 pid = 0;
+        quint64 startTime = 0;
+        QString product;
+        QString name;
+        int stage = 0;          // 冻结时的阶段（守护关系图的拓扑层），解冻按逆序恢复
+        bool guardian = false;  // 全量关闭挂起的守护进程，或冻结的守护进程
+    };
+
+    // 默认位于用户数据目录，图形界面与命令行共用
+    static QString path();
+    // 改用其他文件（测试用）；空串恢复默认
+    static void setPath(const QString &path);
+
+    // 读取集合并丢弃已退出（或 PID 已被复用）的条目，返回仍在运行的条目（按加入顺序）
+    static QList<Entry> prune(const ProcessSnapshot &snapshot);
+    // 追加条目（已存在的同一进程不重复加入）
+    static bool add(const QList<Entry> &entries, QString *errorString = nullptr);
+    // 移除条目（按 PID + 启动时间）
+    static bool remove(const QList<Entry> &entries, QString *errorString = nullptr);
+};
+
+#endif // FROZENSET_H
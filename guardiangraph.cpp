@@ -0,0 +1,119 @@
+#include "guardiangraph.h"
+#include <QSet>
+
+int GuardianGraph::addNode(const ProcessEntry &process, int rule, bool guardian)
+{
+    const auto existing = m_index.constFind(process.pid);
+    if (existing != m_index.constEnd()) {
+        return existing.value();
+    }
+    Node node;
+    node.process = process;
+    node.rule = rule;
+    node.guardian = guardian;
+    m_nodes.append(node);
+    m_edges.append(QList<int>());
+    m_index.insert(process.pid, int(m_nodes.size() - 1));
+    m_guardianCount += guardian ? 1 : 0;
+    return int(m_nodes.size() - 1);
+}
+
+void GuardianGraph::addEdge(int from, int to)
+{
+    if (from != to && !m_edges.at(from).contains(to)) {
+        m_edges[from].append(to);
+    }
+}
+
+void GuardianGraph::addClient(const ProcessEntry &process, int rule)
+{
+    addNode(process, rule, false);
+}
+
+void GuardianGraph::resolve(const TargetMatcher &matcher, const ProcessSnapshot &snapshot, const QHash<qint64, quint64> &skip)
+{
+    if (!matcher.hasGuardians()) {
+        return;
+    }
+    const qsizetype clientCount = m_nodes.size();
+    for (const ProcessEntry &process : snapshot.entries()) {
+        const auto skipped = skip.constFind(process.pid);
+        if (skipped != skip.constEnd() && skipped.value() == process.startTime) {
+            continue;
+        }
+        const int rule = matcher.matchGuardian(process);
+        if (rule >= 0 && !m_index.contains(process.pid)) {
+            addNode(process, rule, true);
+        }
+    }
+    if (m_guardianCount == 0) {
+        return;
+    }
+
+    QHash<int, QList<int>> clientsByRule;
+    for (int i = 0; i < clientCount; ++i) {
+        clientsByRule[m_nodes.at(i).rule].append(i);
+    }
+    for (int i = 0; i < m_nodes.size(); ++i) {
+        const Node &node = m_nodes.at(i);
+        if (node.guardian) {
+            // 目录规则：守护进程负责拉起本产品的客户端
+            for (int client : clientsByRule.value(node.rule)) {
+                addEdge(i, client);
+            }
+        }
+        // 父子关系：守护进程直接拉起的进程（含其他产品的客户端、次级守护进程）
+        const ProcessEntry *parentProcess = snapshot.parentOf(node.process);
+        const auto parent = parentProcess ? m_index.constFind(parentProcess->pid) : m_index.constEnd();
+        if (parent != m_index.constEnd() && m_nodes.at(parent.value()).guardian) {
+            addEdge(parent.value(), i);
+        }
+    }
+}
+
+QList<int> GuardianGraph::layers() const
+{
+    QList<int> layer(m_nodes.size(), -1);
+    QList<int> inDegree(m_nodes.size(), 0);
+    for (const QList<int> &edges : m_edges) {
+        for (int to : edges) {
+            ++inDegree[to];
+        }
+    }
+
+    int assigned = 0;
+    for (int current = 0; assigned < m_nodes.size(); ++current) {
+        // Kahn 算法：本层为所有入度为 0 的未分配节点
+        QList<int> ready;
+        for (int i = 0; i < m_nodes.size(); ++i) {
+            if (layer.at(i) < 0 && inDegree.at(i) == 0) {
+                ready.append(i);
+            }
+        }
+        if (ready.isEmpty()) {
+            // 只剩环：先把剩余的守护进程整体放入本层（一起挂起后谁也无法再拉起谁）
+            for (int i = 0; i < m_nodes.size(); ++i) {
+                if (layer.at(i) < 0 && m_nodes.at(i).guardian) {
+                    ready.append(i);
+                }
+            }
+            if (ready.isEmpty()) {
+                for (int i = 0; i < m_nodes.size(); ++i) {
+                    if (layer.at(i) < 0) {
+                        ready.append(i);
+                    }
+                }
+            }
+        }
+        for (int node : ready) {
+            layer[node] = current;
+            ++assigned;
+        }
+        for (int node : ready) {
+            for (int to : m_edges.at(node)) {
+                --inDegree[to];
+            }
+        }
+    }
+    return layer;
+}
@@ -0,0 +1,43 @@
+#ifndef GUARDIANGRAPH_H
+#define GUARDIANGRAPH_H
+
+#include <QHash>
+#include <QList>
+#include "processsnapshot.h"
+#include "targetcatalog.h"
+
+// 守护关系图：节点为一次快照中的客户端进程与守护进程，边“A → B”表示 A 会重新拉起 B，A 必须先于 B 处理
+// 边来自两处：目录规则（产品的守护进程 → 该产品的全部客户端进程）与父子关系（守护进程 → 它的直接子进程）
+// 按拓扑分层后，守护进程先被挂起/终止，客户端被关闭时已经没有进程能再拉起它，一轮即可完成
+class GuardianGraph
+{
+public:
+    struct Node
+    {
+        ProcessEntry process;
+        int rule = -1;           // TargetCatalog::rules() 下标
+        bool guardian = false;
+    };
+
+    // 加入一个客户端进程（需在 resolve() 之前加入全部客户端）
+    void addClient(const ProcessEntry &process, int rule);
+    // 从快照中找出目录声明的守护进程并连边；skip 中的进程（PID -> 启动时间，如已挂起的守护进程）不再加入
+    void resolve(const TargetMatcher &matcher, const ProcessSnapshot &snapshot, const QHash<qint64, quint64> &skip);
+
+    const QList<Node> &nodes() const { return m_nodes; }
+    int guardianCount() const { return m_guardianCount; }
+    // 每个节点所在的拓扑层（与 nodes() 一一对应，从 0 开始）
+    // 互相拉起的守护进程构成环：环上剩余的守护进程整体并入同一层，再继续处理其下游
+    QList<int> layers() const;
+
+private:
+    QList<Node> m_nodes;
+    QHash<qint64, int> m_index;      // PID -> 节点下标
+    QList<QList<int>> m_edges;       // 出边
+    int m_guardianCount = 0;
+
+    int addNode(const ProcessEntry &process, int rule, bool guardian);
+    void addEdge(int from, int to);
+};
+
+#endif // GUARDIANGRAPH_H
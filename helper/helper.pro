@@ -0,0 +1,18 @@
+# 特权助手：jiyu-helper [--server name] [--catalog path] [--idle-timeout s]
+# 由图形界面/命令行版本在首次遇到权限不足时启动（Windows 经一次提权确认），之后整个会话通过本地套接字复用
+# 需与 jiyu、jiyu-cli 部署在同一目录
+QT       = core network
+CONFIG  += c++17 console
+CONFIG  -= app_bundle
+
+TARGET = jiyu-helper
+
+include(../engine.pri)
+
+SOURCES += \
+    main.cpp
+
+# Default rules for deployment.
+qnx: target.path = /tmp/$${TARGET}/bin
+else: unix:!android: target.path = /opt/$${TARGET}/bin
+!isEmpty(target.path): INSTALLS += target
@@ -0,0 +1,80 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QTextStream>
+#include "elevatedhelper.h"
+#include "targetcatalog.h"
+
+namespace {
+
+enum ExitCode {
+    ExitOk = 0,             // 空闲超时退出，或已有助手在运行
+    ExitUsage = 64,         // 参数错误
+    ExitCatalogError = 66,  // 目标目录无法加载
+    ExitListenError = 69    // 无法监听本地套接字
+};
+
+void writeLog(const QString &log)
+{
+    QTextStream err(stderr);
+    err << log << Qt::endl;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("jiyu-helper");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("电子教室关闭工具的特权助手。通过本地套接字接收批量终止请求，"
+                                     "只终止目标目录命中的进程及其子进程。");
+    parser.addHelpOption();
+    QCommandLineOption serverOption("server", "本地套接字名（默认按当前用户生成）", "name", ElevatedHelper::serverName());
+    QCommandLineOption catalogOption("catalog", "目标目录文件（默认程序目录下的 targets.json，缺失时使用内置列表）", "path");
+    QCommandLineOption idleOption("idle-timeout", "没有请求时自动退出的等待时间（默认 900 秒）", "s", "900");
+    QCommandLineOption verboseOption(QStringList() << "v" << "verbose", "输出每个请求的处理结果到标准错误");
+    parser.addOptions({serverOption, catalogOption, idleOption, verboseOption});
+    parser.process(app);
+
+    bool idleOk = false;
+    const int idleSeconds = parser.value(idleOption).toInt(&idleOk);
+    if (!idleOk || idleSeconds < 1) {
+        writeLog("--idle-timeout 必须为正整数");
+        return ExitUsage;
+    }
+
+    TargetCatalog catalog;
+    if (parser.isSet(catalogOption)) {
+        QString errorString;
+        catalog = TargetCatalog::load(parser.value(catalogOption), &errorString);
+        if (catalog.isEmpty()) {
+            writeLog(QString("目标目录加载失败：%1").arg(errorString));
+            return ExitCatalogError;
+        }
+    } else {
+        catalog = TargetCatalog::loadDefault();
+    }
+
+    ElevatedHelperServer server(catalog);
+    server.setIdleTimeout(idleSeconds * 1000);
+    if (parser.isSet(verboseOption)) {
+        QObject::connect(&server, &ElevatedHelperServer::logUpdated, &app, &writeLog);
+    }
+    QObject::connect(&server, &ElevatedHelperServer::idleTimeout, &app, &QCoreApplication::quit);
+
+    QString errorString;
+    switch (server.listen(parser.value(serverOption), &errorString)) {
+    case ElevatedHelperServer::Listening:
+        break;
+    case ElevatedHelperServer::AlreadyRunning:
+        // 调用方直接连接已有的助手即可
+        writeLog("已有特权助手在运行");
+        return ExitOk;
+    case ElevatedHelperServer::ListenFailed:
+        writeLog(QString("特权助手启动失败：%1").arg(errorString));
+        return ExitListenError;
+    }
+    writeLog(QString("特权助手已启动（%1）").arg(parser.value(serverOption)));
+    return app.exec();
+}
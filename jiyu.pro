@@ -5,28 +5,35 @@ greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
 CONFIG += c++17
 
+# 检测/关闭引擎（仅依赖 QtCore），与命令行版本 cli/cli.pro 共用
+include(engine.pri)
+
 # You can make your code fail to compile if it uses deprecated APIs.
 # In order to do so, uncomment the following line.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += \
     help.cpp \
-    killprocessthread.cpp \
     main.cpp \
     mainwindow.cpp \
     progresswindow.cpp \
+    startuploader.cpp \
+    startuptrace.cpp \
     stop.cpp \
     up.cpp \
-    versionchecker.cpp
+    versionchecker.cpp \
+    wallpapercache.cpp
 
 HEADERS += \
     help.h \
-    killprocessthread.h \
     mainwindow.h \
     progresswindow.h \
+    startuploader.h \
+    startuptrace.h \
     stop.h \
     up.h \
-    versionchecker.h
+    versionchecker.h \
+    wallpapercache.h
 
 FORMS += \
     help.ui \
@@ -45,4 +52,5 @@ RESOURCES += \
     tupian/tupian.qrc
 
 DISTFILES += \
+    targets.json \
     tupian/icon file.ico
@@ -1,87 +1,742 @@
-#include "KillProcessThread.h"
-#include <QProcess>
+#include "killprocessthread.h"
 #include <QThread>
 #include <QDebug>
+#include <QDeadlineTimer>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QMap>
+#include <QSet>
+#include "killtrace.h"
+#include "sweepjournal.h"
+#include "guardiangraph.h"
+#include "frozenset.h"
 
-KillProcessThread::KillProcessThread(const QMap<QString, QString> &processMap, int totalRounds, QObject *parent)
+namespace {
+
+// 冻结的遍数上限：每遍补上前一遍挂起过程中新派生的子进程，正常情况下第 2 遍即扫描不到新目标
+constexpr int kMaxFreezePasses = 5;
+
+FrozenSet::Entry frozenEntry(const KillTarget &target, int index)
+{
+    FrozenSet::Entry entry;
+    entry.pid = target.processes.at(index).pid;
+    entry.startTime = target.processes.at(index).startTime;
+    entry.product = target.className;
+    entry.name = target.processes.at(index).name;
+    entry.stage = target.stage;
+    entry.guardian = target.guardian;
+    return entry;
+}
+
+// 解冻目标：按（阶段, 守护进程, 产品）分组，组内按挂起的逆序排列（子先于父）
+QList<KillTarget> thawTargets(const QList<FrozenSet::Entry> &entries, const ProcessSnapshot &snapshot)
+{
+    QList<KillTarget> targets;
+    QHash<QString, int> index;
+    for (auto it = entries.crbegin(); it != entries.crend(); ++it) {
+        const ProcessEntry *process = snapshot.process(it->pid);
+        if (!process) {
+            continue;
+        }
+        const QString key = QString("%1\t%2\t%3").arg(it->stage).arg(int(it->guardian)).arg(it->product);
+        auto found = index.constFind(key);
+        if (found == index.constEnd()) {
+            KillTarget target;
+            target.className = it->product;
+            target.action = KillTarget::Resume;
+            target.stage = it->stage;
+            target.guardian = it->guardian;
+            found = index.insert(key, int(targets.size()));
+            targets.append(target);
+        }
+        KillTarget &target = targets[found.value()];
+        if (!target.processName.split('/').contains(process->name)) {
+            target.processName = target.processName.isEmpty() ? process->name : target.processName + '/' + process->name;
+        }
+        target.processes.append(*process);
+    }
+    return targets;
+}
+
+} // namespace
+
+int SweepPolicy::backoffDelay(int streak) const
+{
+    double delay = initialBackoffMs;
+    for (int i = 1; i < streak && delay < maxBackoffMs; ++i) {
+        delay *= 2;
+    }
+    delay = qMin<double>(delay, maxBackoffMs);
+    // 抖动：避免与按固定周期拉起的守护进程“同相”
+    const double factor = 1.0 + jitter * (2.0 * QRandomGenerator::global()->generateDouble() - 1.0);
+    return qMax(0, int(delay * factor));
+}
+
+KillProcessThread::KillProcessThread(const TargetCatalog &catalog, QObject *parent)
+    : KillProcessThread(std::make_shared<const TargetMatcher>(catalog), parent)
+{
+}
+
+KillProcessThread::KillProcessThread(const std::shared_ptr<const TargetMatcher> &matcher, QObject *parent)
     : QThread(parent)
-    , m_processMap(processMap)
-    , m_totalRounds(totalRounds)
+    , m_matcher(matcher)
+    , m_terminator(ProcessTerminator::create(ProcessTerminator::Native))
+    , m_processCache(&m_ownCache)
+    , m_progress(std::make_shared<KillProgress>())
+    , m_predictor(std::make_shared<RespawnPredictor>())
+    , m_cancellation(CancellationToken::create())
 {
+    m_terminator->setCancellationToken(m_cancellation);
+    m_terminator->setLogHandler([this](const QString &log) { appendLog(log); });
 }
 
 KillProcessThread::~KillProcessThread()
 {
-    // 确保线程退出
-    quit();
+    // run() 没有事件循环：取消后所有等待立即返回，线程很快结束
+    cancel();
     wait();
 }
 
-// 线程核心逻辑：执行多轮进程关闭（修复进度计算）
+void KillProcessThread::setDeadline(QDeadlineTimer deadline)
+{
+    m_deadline = deadline;
+}
+
+void KillProcessThread::cancel()
+{
+    requestInterruption();
+    m_cancellation.cancel();
+}
+
+bool KillProcessThread::shouldStop() const
+{
+    return m_cancellation.isCancelled() || m_deadline.hasExpired();
+}
+
+void KillProcessThread::setMode(Mode mode)
+{
+    m_mode = mode;
+}
+
+void KillProcessThread::setProcessCache(ProcessTableCache *cache)
+{
+    m_processCache = cache ? cache : &m_ownCache;
+}
+
+void KillProcessThread::setLogChannel(const std::shared_ptr<LogChannel> &channel)
+{
+    m_logChannel = channel;
+}
+
+void KillProcessThread::appendLog(const QString &log)
+{
+    if (m_logChannel) {
+        m_logChannel->push(log);
+    } else {
+        emit logUpdated(log);
+    }
+}
+
+void KillProcessThread::setTerminatorBackend(ProcessTerminator::Backend backend)
+{
+    m_terminator = ProcessTerminator::create(backend);
+    m_terminator->setCancellationToken(m_cancellation);
+    m_terminator->setLogHandler([this](const QString &log) { appendLog(log); });
+}
+
+void KillProcessThread::setTreeOrder(ProcessSnapshot::TreeOrder order)
+{
+    m_treeOrder = order;
+}
+
+void KillProcessThread::setSweepPolicy(const SweepPolicy &policy)
+{
+    m_policy = policy;
+}
+
+void KillProcessThread::setRespawnPredictor(const std::shared_ptr<RespawnPredictor> &predictor)
+{
+    m_predictor = predictor ? predictor : std::make_shared<RespawnPredictor>();
+}
+
 void KillProcessThread::run()
 {
-    int totalProgress = m_totalRounds * m_processMap.size() * 100;  // 总进度（轮次×进程数×100）
-    int currentProgress = 0;
+    switch (m_mode) {
+    case DetectAndKill:
+        runDetectAndKill();
+        break;
+    case Freeze:
+        runFreeze();
+        break;
+    case Thaw:
+        runThaw();
+        break;
+    default:
+        runSweep();
+        break;
+    }
+}
 
-    for (int round = 1; round <= m_totalRounds; round++) {
-        emit logUpdated(QString("===== 执行第%1轮全量进程关闭 =====").arg(round));
+// 检测关闭：一次快照匹配全部目标，关闭第一个运行中的电子教室（含其子进程）
+void KillProcessThread::runDetectAndKill()
+{
+    ProcessSnapshot snapshot;
+    {
+        KillTraceScope scope("enumerate", QString(), 0, 1);
+        snapshot = m_processCache->refresh();
+    }
+    QList<TargetMatch> matches;
+    {
+        KillTraceScope scope("match", QString(), 0, 1);
+        matches = m_matcher->matchAll(snapshot);
+    }
+    if (matches.isEmpty()) {
+        emit detectionFinished(QString(), QString(), false, false);
+        return;
+    }
 
-        // 遍历所有进程执行关闭
-        for (auto it = m_processMap.constBegin(); it != m_processMap.constEnd(); ++it) {
-            QString processName = it.key();
-            QString className = it.value();
-            killSingleProcess(processName, className);
+    // 只关闭与第一个命中同一规则的进程：父服务、指纹、模式规则收窄的范围不能被同名的无关进程扩大
+    const TargetMatch &first = matches.first();
+    KillTarget target;
+    target.className = m_matcher->rule(first.rule).product;
+    target.processName = first.process.name;
+    target.timeoutMs = 6000;  // 与原先 3 次重试、每次 2 秒的上限一致
+    target.round = 1;
+    appendLog(QString("检测到%1（进程%2），开始关闭").arg(target.className).arg(target.processName));
 
-            currentProgress += 100;
-            emit progressUpdated(currentProgress, totalProgress);  // 每关闭一个进程更新进度
-            QThread::msleep(200);  // 短延迟，避免操作过快（非阻塞主线程）
+    // 该规则命中的全部进程连同子树一起关闭
+    QSet<qint64> assigned;
+    for (const TargetMatch &match : matches) {
+        if (match.rule != first.rule) {
+            continue;
+        }
+        for (const ProcessEntry &process : snapshot.subtree(match.process.pid, m_treeOrder)) {
+            if (!assigned.contains(process.pid)) {
+                assigned.insert(process.pid);
+                target.processes.append(process);
+            }
         }
+    }
+
+    QList<KillTarget> targets;
+    targets.append(target);
+    m_progress->setRound(1);
+    m_progress->addFound(int(target.processes.size()));
+    journalTargets(targets, 1);
+    KillScheduler scheduler(m_terminator.get(), 1);
+    scheduler.setCancellation(m_cancellation, m_deadline);
+    scheduler.setProgress(m_progress.get());
+    scheduler.run(targets, [this](const KillTarget &finished) {
+        logTargetResult(finished);
+        emit targetFinished(finished, 1);
+    });
+
+    // 关闭后再确认一次（按同一规则重新匹配）：守护进程立即重新拉起也视为失败
+    bool survived = false;
+    for (const TargetMatch &match : m_matcher->matchAll(m_processCache->refresh())) {
+        survived = survived || match.rule == first.rule;
+    }
+    const bool success = targets.first().succeeded() && !survived;
+    emit detectionFinished(target.className, target.processName, true, success);
+}
+
+// 全量关闭：自适应轮次。只对最新快照中仍在运行的目标再执行一轮；
+// 关闭后在静默期内持续检测，静默期内没有任何命中即结束，被反复拉起时按退避间隔继续
+void KillProcessThread::runSweep()
+{
+    QDeadlineTimer deadline(m_policy.maxDurationMs);
+    if (m_deadline < deadline) {
+        deadline = m_deadline;
+    }
+    KillScheduler scheduler(m_terminator.get());
+    scheduler.setCancellation(m_cancellation, deadline);
+    scheduler.setProgress(m_progress.get());
+    QHash<qint64, quint64> handled;  // 已确认退出或已挂起的进程（PID -> 启动时间）
+    QSet<QString> products;          // 本次关闭过的产品：只为它们的预测窗口延长观察
+    int respawnStreak = 0;
+    int suspendedGuardians = 0;
+    m_roundsExecuted = 0;
+
+    // 此前挂起（冻结或上一次关闭）的守护进程仍处于挂起状态，不再重复挂起
+    if (m_policy.neutralizeGuardians && m_matcher->hasGuardians()) {
+        for (const FrozenSet::Entry &entry : FrozenSet::prune(m_processCache->refresh())) {
+            if (entry.guardian) {
+                handled.insert(entry.pid, entry.startTime);
+            }
+        }
+    }
 
-        emit logUpdated(QString("第%1轮关闭完成，等待1秒...").arg(round));
-        QThread::msleep(1000);  // 轮次间隔（子线程内sleep，不影响UI）
+    QList<KillTarget> targets = scanTargets(1, handled, m_treeOrder);
+    if (targets.isEmpty()) {
+        appendLog("未检测到任何运行中的电子教室，无需关闭");
     }
 
-    emit logUpdated("所有轮次执行完成！");
-    emit progressUpdated(totalProgress, totalProgress);
+    while (!targets.isEmpty()) {
+        if (shouldStop()) {
+            break;
+        }
+        // 上限在开始新一轮之前检查，而不是等这一轮执行完
+        if (deadline.hasExpired()) {
+            appendLog(QString("已达到时间上限（%1毫秒），停止关闭").arg(m_policy.maxDurationMs));
+            break;
+        }
+        if (m_roundsExecuted >= m_policy.maxRounds) {
+            appendLog(QString("已达到轮次上限（%1轮），停止关闭").arg(m_policy.maxRounds));
+            break;
+        }
+        const int round = ++m_roundsExecuted;
+        int guardianCount = 0;
+        for (const KillTarget &target : targets) {
+            guardianCount += target.guardian ? int(target.processes.size()) : 0;
+        }
+        appendLog(QString("===== 执行第%1轮关闭（%2个目标） =====").arg(round).arg(targets.size()));
+        if (guardianCount > 0) {
+            appendLog(QString("先处理%1个守护进程，再按守护关系关闭其拉起的进程").arg(guardianCount));
+        }
+        int found = 0;
+        for (const KillTarget &target : targets) {
+            found += int(target.processes.size());
+            products.insert(target.className);
+        }
+        m_progress->setRound(round);
+        m_progress->addFound(found);
+        journalTargets(targets, round);
+        QList<FrozenSet::Entry> suspended;
+        {
+            KillTraceScope roundScope("round", QString(), 0, round);
+            // 回调在工作线程中串行执行（进度由调度器按进程累加）
+            const KillScheduler::TargetCallback onFinished = [this, round, &handled, &suspended](const KillTarget &target) {
+                logTargetResult(target);
+                emit targetFinished(target, round);
+                for (int i = 0; i < target.results.size(); ++i) {
+                    const KillResult &result = target.results.at(i);
+                    // 守护进程无论成败只处理一次：挂起失败（如权限不足）时不应被当作重新拉起而反复加轮
+                    if (target.guardian || result.exited) {
+                        handled.insert(target.processes.at(i).pid, target.processes.at(i).startTime);
+                    }
+                    // 挂起的守护进程在关闭结束后保持挂起（恢复后会立刻重新拉起客户端），记入冻结集合由解冻恢复
+                    if (target.action == KillTarget::Suspend && result.success) {
+                        suspended.append(frozenEntry(target, i));
+                    }
+                    if (target.action == KillTarget::Terminate && result.exited) {
+                        m_predictor->recordKill(target.className, target.processes.at(i).name);
+                    }
+                }
+            };
+            // 同一阶段的目标并行终止并等待退出确认，守护进程所在的阶段全部完成后才关闭它拉起的进程
+            runStages(scheduler, targets, false, onFinished);
+        }
+        suspendedGuardians += int(suspended.size());
+        QString frozenError;
+        if (!FrozenSet::add(suspended, &frozenError)) {
+            appendLog(QString("⚠️ 冻结集合保存失败（%1），挂起的守护进程将无法通过解冻恢复").arg(frozenError));
+        }
+
+        if (shouldStop()) {
+            break;
+        }
+        if (deadline.hasExpired()) {
+            appendLog(QString("已达到时间上限（%1毫秒），停止关闭").arg(m_policy.maxDurationMs));
+            break;
+        }
+
+        targets = watchForRespawn(round + 1, handled, products, deadline);
+        if (targets.isEmpty()) {
+            appendLog(QString("%1毫秒内未检测到目标被重新拉起，关闭完成").arg(m_policy.quietPeriodMs));
+            break;
+        }
+        // 下一轮已不可能执行时不再退避等待
+        if (m_roundsExecuted >= m_policy.maxRounds) {
+            appendLog(QString("已达到轮次上限（%1轮），停止关闭").arg(m_policy.maxRounds));
+            break;
+        }
+
+        // 守护进程仍在拉起目标：退避后重新扫描（退避期间可能又换了一批 PID）
+        const int delay = m_policy.backoffDelay(++respawnStreak);
+        QStringList names;
+        for (const KillTarget &target : targets) {
+            names.append(target.className);
+        }
+        appendLog(QString("检测到 %1 被重新拉起，%2毫秒后执行下一轮").arg(names.join("、")).arg(delay));
+        {
+            KillTraceScope backoffScope("backoff", QString(), 0, round + 1);
+            if (!m_cancellation.sleep(int(qMin<qint64>(delay, qMax<qint64>(0, deadline.remainingTime()))))) {
+                break;
+            }
+        }
+        targets = scanTargets(round + 1, handled, m_treeOrder);
+        if (targets.isEmpty()) {
+            // 退避后没有目标：连续拉起到此中断，之后再被拉起时退避从头开始
+            respawnStreak = 0;
+            targets = watchForRespawn(round + 1, handled, products, deadline);
+        }
+    }
+
+    if (m_cancellation.isCancelled()) {
+        appendLog(QString("关闭任务已取消（已执行%1轮）").arg(m_roundsExecuted));
+    } else if (m_deadline.hasExpired()) {
+        appendLog(QString("关闭任务已到截止时间（已执行%1轮）").arg(m_roundsExecuted));
+    } else {
+        appendLog(QString("全量关闭结束，共执行%1轮").arg(m_roundsExecuted));
+    }
+    if (suspendedGuardians > 0) {
+        appendLog(QString("%1个守护进程保持挂起，解冻时恢复").arg(suspendedGuardians));
+    }
     emit finishedKill();  // 通知主线程执行完成
 }
 
-// 关闭单个进程（添加失败日志反馈）
-void KillProcessThread::killSingleProcess(const QString &processName, const QString &className)
+// 冻结：挂起全部目标而不终止。守护进程所在的阶段先挂起，进程树父先于子，已挂起的进程无法再拉起或派生新进程；
+// 每遍结束后重新扫描，补上挂起过程中刚派生的子进程，直到一遍扫描不到新目标
+// 挂起成功的进程记入冻结集合；已在集合中的进程（此前冻结过、或全量关闭时挂起的守护进程）不再重复挂起
+void KillProcessThread::runFreeze()
 {
-    emit logUpdated(QString("正在关闭 %1（进程：%2）").arg(className).arg(processName));
+    KillScheduler scheduler(m_terminator.get());
+    scheduler.setCancellation(m_cancellation, m_deadline);
+    scheduler.setProgress(m_progress.get());
+    QHash<qint64, quint64> handled;  // 已处理的进程（PID -> 启动时间），挂起失败的也不再重复处理
+    int frozen = 0;
+    int failed = 0;
+    m_roundsExecuted = 0;
+    m_freezeLatencyMs = -1;
+    QElapsedTimer clock;
+    clock.start();
 
-    // 方式1：常规taskkill
-    QProcess taskkill;
-    taskkill.start("taskkill", QStringList() << "/F" << "/T" << "/IM" << processName);
-    taskkill.waitForFinished(2000);
-    QString taskkillOutput = taskkill.readAllStandardOutput() + taskkill.readAllStandardError();
+    const QList<FrozenSet::Entry> alreadyFrozen = FrozenSet::prune(m_processCache->refresh());
+    for (const FrozenSet::Entry &entry : alreadyFrozen) {
+        handled.insert(entry.pid, entry.startTime);
+    }
+    if (!alreadyFrozen.isEmpty()) {
+        appendLog(QString("%1个进程此前已被冻结，跳过").arg(alreadyFrozen.size()));
+    }
 
-    // 方式2：wmic强制终止
-    QProcess wmicKill;
-    wmicKill.start("wmic", QStringList() << "process" << "where" << QString("name='%1'").arg(processName) << "delete");
-    wmicKill.waitForFinished(2000);
-    QString wmicOutput = wmicKill.readAllStandardOutput() + wmicKill.readAllStandardError();
+    QList<KillTarget> targets = scanTargets(1, handled, ProcessSnapshot::TopDown);
+    if (targets.isEmpty()) {
+        appendLog(alreadyFrozen.isEmpty() ? "未检测到任何运行中的电子教室，无需冻结" : "没有新的进程需要冻结");
+    }
+    while (!targets.isEmpty() && !shouldStop()) {
+        if (m_roundsExecuted >= kMaxFreezePasses) {
+            appendLog(QString("已达到冻结遍数上限（%1遍），仍有新派生的进程未被挂起").arg(kMaxFreezePasses));
+            break;
+        }
+        const int pass = ++m_roundsExecuted;
+        int found = 0;
+        for (KillTarget &target : targets) {
+            target.action = KillTarget::Suspend;
+            found += int(target.processes.size());
+        }
+        appendLog(QString("===== 第%1遍冻结（%2个进程） =====").arg(pass).arg(found));
+        m_progress->setRound(pass);
+        m_progress->addFound(found);
+        journalTargets(targets, pass);
+        QList<FrozenSet::Entry> suspended;
+        {
+            KillTraceScope passScope("freeze", QString(), 0, pass);
+            runStages(scheduler, targets, false, [this, pass, &handled, &suspended, &frozen, &failed](const KillTarget &target) {
+                logTargetResult(target);
+                emit targetFinished(target, pass);
+                for (int i = 0; i < target.results.size(); ++i) {
+                    handled.insert(target.processes.at(i).pid, target.processes.at(i).startTime);
+                    if (target.results.at(i).success) {
+                        suspended.append(frozenEntry(target, i));
+                        ++frozen;
+                    } else {
+                        ++failed;
+                    }
+                }
+            });
+        }
+        // 每遍结束即落盘：任务中途被取消时，已挂起的进程仍能被解冻
+        QString errorString;
+        if (!FrozenSet::add(suspended, &errorString)) {
+            appendLog(QString("⚠️ 冻结集合保存失败（%1），解冻时将无法恢复本遍挂起的进程").arg(errorString));
+        }
+        m_freezeLatencyMs = clock.elapsed();
+        targets = scanTargets(pass + 1, handled, ProcessSnapshot::TopDown);
+    }
 
-    // 方式3：管理员权限执行
-    runCommandAsAdmin(QString("taskkill /F /T /IM %1").arg(processName));
+    if (m_cancellation.isCancelled()) {
+        appendLog(QString("冻结已取消（已挂起%1个进程）").arg(frozen));
+    } else if (m_deadline.hasExpired()) {
+        appendLog(QString("冻结已到截止时间（已挂起%1个进程）").arg(frozen));
+    } else if (m_freezeLatencyMs >= 0) {
+        appendLog(QString("冻结结束：挂起%1个进程，失败%2个，共%3遍，耗时%4毫秒")
+                      .arg(frozen)
+                      .arg(failed)
+                      .arg(m_roundsExecuted)
+                      .arg(m_freezeLatencyMs));
+    }
+    emit finishedKill();
+}
+
+// 解冻：只恢复冻结集合中仍在运行的进程，按冻结的逆序。先恢复客户端（子先于父），最后恢复守护进程，
+// 守护进程恢复时看到的客户端已在运行，不会再去拉起一份新的
+void KillProcessThread::runThaw()
+{
+    KillScheduler scheduler(m_terminator.get());
+    scheduler.setCancellation(m_cancellation, m_deadline);
+    scheduler.setProgress(m_progress.get());
+    int resumed = 0;
+    int failed = 0;
+    m_freezeLatencyMs = -1;
+    QElapsedTimer clock;
+    clock.start();
 
-    // 日志反馈执行结果
-    if (taskkillOutput.contains("成功") || wmicOutput.contains("删除")) {
-        emit logUpdated(QString("✅ 成功关闭 %1（进程：%2）").arg(className).arg(processName));
+    const ProcessSnapshot snapshot = m_processCache->refresh();
+    QList<KillTarget> targets = thawTargets(FrozenSet::prune(snapshot), snapshot);
+    m_roundsExecuted = targets.isEmpty() ? 0 : 1;
+    if (targets.isEmpty()) {
+        appendLog("没有被冻结且仍在运行的进程，无需解冻");
     } else {
-        emit logUpdated(QString("❌ 关闭 %1失败：taskkill=%2 | wmic=%3").arg(className).arg(taskkillOutput.trimmed()).arg(wmicOutput.trimmed()));
+        int found = 0;
+        for (KillTarget &target : targets) {
+            target.round = 1;
+            found += int(target.processes.size());
+        }
+        appendLog(QString("===== 解冻（%1个进程） =====").arg(found));
+        m_progress->setRound(1);
+        m_progress->addFound(found);
+        QList<FrozenSet::Entry> thawed;
+        {
+            KillTraceScope thawScope("thaw", QString(), 0, 1);
+            runStages(scheduler, targets, true, [this, &thawed, &resumed, &failed](const KillTarget &target) {
+                logTargetResult(target);
+                emit targetFinished(target, 1);
+                for (int i = 0; i < target.results.size(); ++i) {
+                    if (target.results.at(i).success) {
+                        thawed.append(frozenEntry(target, i));
+                        ++resumed;
+                    } else {
+                        ++failed;  // 保留在集合中，下次解冻再试
+                    }
+                }
+            });
+        }
+        QString errorString;
+        if (!FrozenSet::remove(thawed, &errorString)) {
+            appendLog(QString("⚠️ 冻结集合保存失败：%1").arg(errorString));
+        }
+        m_freezeLatencyMs = clock.elapsed();
+        appendLog(QString("解冻结束：恢复%1个进程，失败%2个，耗时%3毫秒").arg(resumed).arg(failed).arg(m_freezeLatencyMs));
+    }
+    emit finishedKill();
+}
+
+void KillProcessThread::runStages(KillScheduler &scheduler, const QList<KillTarget> &targets, bool descending,
+                                  const KillScheduler::TargetCallback &onFinished)
+{
+    int lastStage = 0;
+    for (const KillTarget &target : targets) {
+        lastStage = qMax(lastStage, target.stage);
+    }
+    for (int i = 0; i <= lastStage && !shouldStop(); ++i) {
+        const int stage = descending ? lastStage - i : i;
+        QList<KillTarget> stageTargets;
+        for (const KillTarget &target : targets) {
+            if (target.stage == stage) {
+                stageTargets.append(target);
+            }
+        }
+        if (!stageTargets.isEmpty()) {
+            scheduler.run(stageTargets, onFinished);
+        }
     }
+}
 
-    qDebug() << QString("关闭进程%1：taskkill输出=%2, wmic输出=%3")
-                    .arg(processName)
-                    .arg(taskkillOutput)
-                    .arg(wmicOutput);
+QList<KillTarget> KillProcessThread::scanTargets(int round, const QHash<qint64, quint64> &handled, ProcessSnapshot::TreeOrder order)
+{
+    ProcessSnapshot snapshot;
+    {
+        KillTraceScope scope("enumerate", QString(), 0, round);
+        snapshot = m_processCache->refresh();
+    }
+    KillTraceScope scope("match", QString(), 0, round);
+    QList<KillTarget> targets = buildTargets(snapshot, handled, order);
+    for (KillTarget &target : targets) {
+        target.round = round;
+        for (const ProcessEntry &process : target.processes) {
+            const ProcessEntry *parent = snapshot.parentOf(process);
+            m_predictor->recordSpawn(target.className, process, parent ? parent->name : QString());
+        }
+    }
+    m_predictor->dropOrphans(snapshot);
+    return targets;
 }
 
-// 管理员权限执行命令（无UI操作）
-void KillProcessThread::runCommandAsAdmin(const QString &command)
+QList<KillTarget> KillProcessThread::watchForRespawn(int round, const QHash<qint64, quint64> &handled, const QSet<QString> &products,
+                                                     const QDeadlineTimer &deadline)
 {
-    QString psCommand = QString("Start-Process cmd -ArgumentList '/c %1' -Verb RunAs").arg(command);
-    QProcess::startDetached("powershell", QStringList() << "-Command" << psCommand);
+    KillTraceScope scope("quiet-period", QString(), 0, round);
+    QElapsedTimer quiet;
+    quiet.start();
+    bool extended = false;
+    while (!shouldStop() && !deadline.hasExpired()) {
+        const QList<KillTarget> targets = scanTargets(round, handled, m_treeOrder);
+        if (!targets.isEmpty()) {
+            return targets;
+        }
+        qint64 remaining = m_policy.quietPeriodMs - quiet.elapsed();
+        if (remaining > 0) {
+            m_cancellation.sleep(int(qMin<qint64>(remaining, m_policy.pollIntervalMs)));
+            continue;
+        }
+        // 静默期已过：守护进程按已学到的节奏拉起时，只在预测窗口内高频检测，窗口结束仍未出现即完成
+        const qint64 windowEnd = m_predictor->msecsUntilLastWindowEnd(products);
+        remaining = deadline.isForever() ? windowEnd : qMin(windowEnd, deadline.remainingTime());
+        if (remaining <= 0) {
+            break;
+        }
+        if (!extended) {
+            extended = true;
+            appendLog(QString("根据重新拉起预测，继续观察%1毫秒").arg(remaining));
+        }
+        const int delay = m_predictor->nextPollDelay(m_policy.pollIntervalMs, int(remaining), int(remaining));
+        m_cancellation.sleep(int(qMin<qint64>(remaining, delay)));
+    }
+    return QList<KillTarget>();
+}
+
+QList<KillTarget> KillProcessThread::buildTargets(const ProcessSnapshot &snapshot, const QHash<qint64, quint64> &handled,
+                                                  ProcessSnapshot::TreeOrder order) const
+{
+    const bool neutralize = m_policy.neutralizeGuardians && m_matcher->hasGuardians();
+    const QList<TargetRule> &rules = m_matcher->catalog().rules();
+    QList<KillTarget> targets(rules.size());
+    for (int i = 0; i < rules.size(); ++i) {
+        targets[i].className = rules.at(i).product;
+        targets[i].processName = rules.at(i).names.isEmpty() ? rules.at(i).patterns.join('/') : rules.at(i).names.join('/');
+    }
+    // 整份快照只匹配一次；命中进程连同其整棵子树（含改名的守护/辅助子进程）归入对应规则
+    QSet<qint64> assigned;
+    for (const TargetMatch &match : m_matcher->matchAll(snapshot)) {
+        for (const ProcessEntry &process : snapshot.subtree(match.process.pid, order)) {
+            const auto handledProcess = handled.constFind(process.pid);
+            if (handledProcess != handled.constEnd() && handledProcess.value() == process.startTime) {
+                continue;
+            }
+            if (neutralize && m_matcher->matchGuardian(process) >= 0) {
+                continue;  // 客户端拉起的守护进程归入守护关系图
+            }
+            if (!assigned.contains(process.pid)) {
+                assigned.insert(process.pid);
+                targets[match.rule].processes.append(process);
+            }
+        }
+    }
+    if (neutralize) {
+        targets.append(buildGuardianStages(snapshot, handled, targets));
+    }
+    // 只保留本次有进程在运行的目标
+    targets.removeIf([](const KillTarget &target) {
+        return target.processes.isEmpty();
+    });
+    return targets;
+}
+
+QList<KillTarget> KillProcessThread::buildGuardianStages(const ProcessSnapshot &snapshot, const QHash<qint64, quint64> &handled,
+                                                          QList<KillTarget> &clients) const
+{
+    // clients 与目录规则一一对应（下标即规则）
+    GuardianGraph graph;
+    for (int rule = 0; rule < clients.size(); ++rule) {
+        for (const ProcessEntry &process : clients.at(rule).processes) {
+            graph.addClient(process, rule);
+        }
+    }
+    graph.resolve(*m_matcher, snapshot, handled);
+    if (graph.guardianCount() == 0) {
+        return QList<KillTarget>();
+    }
+
+    const QList<int> layers = graph.layers();
+    const QList<GuardianGraph::Node> &nodes = graph.nodes();
+    QHash<qint64, int> clientLayers;
+    QMap<QPair<int, int>, KillTarget> guardians;  // (拓扑层, 规则) -> 目标，按层有序
+    for (int i = 0; i < nodes.size(); ++i) {
+        const GuardianGraph::Node &node = nodes.at(i);
+        if (!node.guardian) {
+            clientLayers.insert(node.process.pid, layers.at(i));
+            continue;
+        }
+        const TargetRule &rule = m_matcher->rule(node.rule);
+        KillTarget &target = guardians[qMakePair(layers.at(i), node.rule)];
+        if (target.processes.isEmpty()) {
+            target.className = rule.product;
+            target.action = rule.guardianAction == TargetRule::KillGuardian ? KillTarget::Terminate : KillTarget::Suspend;
+            target.stage = layers.at(i);
+            target.guardian = true;
+        }
+        if (!target.processName.split('/').contains(node.process.name)) {
+            target.processName = target.processName.isEmpty() ? node.process.name : target.processName + '/' + node.process.name;
+        }
+        target.processes.append(node.process);
+    }
+    // 一个客户端目标整体执行：阶段取其进程所在的最深一层
+    for (KillTarget &client : clients) {
+        for (const ProcessEntry &process : client.processes) {
+            client.stage = qMax(client.stage, clientLayers.value(process.pid));
+        }
+    }
+    return guardians.values();
+}
+
+void KillProcessThread::journalTargets(const QList<KillTarget> &targets, int round) const
+{
+    if (!SweepJournal::isEnabled()) {
+        return;
+    }
+    const SweepJournal::Action action = round <= 1 ? SweepJournal::Detected : SweepJournal::Respawned;
+    for (const KillTarget &target : targets) {
+        for (const ProcessEntry &process : target.processes) {
+            SweepJournal::record(action, process.pid, SweepJournal::nameId(target.className, process.name), round);
+        }
+    }
+}
+
+// 输出单个目标的终止结果（结构化结果，不再解析命令输出）
+void KillProcessThread::logTargetResult(const KillTarget &target)
+{
+    if (target.processes.isEmpty()) {
+        appendLog(QString("未检测到 %1（进程：%2）").arg(target.className).arg(target.processName));
+        return;
+    }
+
+    if (target.cancelled) {
+        appendLog(QString("⚠️ %1 的关闭已取消").arg(target.className));
+    }
+    for (int i = 0; i < target.results.size(); ++i) {
+        const KillResult &result = target.results.at(i);
+        const QString &processName = target.processes.at(i).name;
+        const QString owner = target.className + (target.guardian ? QString("的守护进程") : QString());
+        if (target.action == KillTarget::Suspend && result.success) {
+            appendLog(QString("⏸️ 已挂起 %1（进程：%2，PID：%3）").arg(owner).arg(processName).arg(result.pid));
+        } else if (target.action == KillTarget::Resume && result.success) {
+            appendLog(QString("▶️ 已恢复 %1（进程：%2，PID：%3）").arg(owner).arg(processName).arg(result.pid));
+        } else if (result.exited) {
+            appendLog(QString("✅ 成功关闭 %1（进程：%2，PID：%3）").arg(owner).arg(processName).arg(result.pid));
+        } else if (result.success) {
+            appendLog(QString("⚠️ %1 已发送终止信号但未在时限内退出（PID：%2）").arg(target.className).arg(result.pid));
+        } else {
+            static const QHash<int, QString> kActionNames = {
+                {KillTarget::Terminate, QStringLiteral("关闭")},
+                {KillTarget::Suspend, QStringLiteral("挂起")},
+                {KillTarget::Resume, QStringLiteral("恢复")}
+            };
+            appendLog(QString("❌ %1 %2失败（PID：%3，状态：%4，错误码：%5 %6）")
+                                .arg(kActionNames.value(target.action))
+                                .arg(owner)
+                                .arg(result.pid)
+                                .arg(result.exitStatus)
+                                .arg(result.errorCode)
+                                .arg(result.errorString()));
+        }
+
+        qDebug() << QString("关闭进程%1：后端=%2, PID=%3, 状态=%4, 错误码=%5, 尝试次数=%6%7")
+                        .arg(processName)
+                        .arg(m_terminator->backendName())
+                        .arg(result.pid)
+                        .arg(result.exitStatus)
+                        .arg(result.errorCode)
+                        .arg(target.attempts)
+                        .arg(target.timedOut ? QString("（超时）") : QString());
+    }
 }
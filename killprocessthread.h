@@ -3,35 +3,138 @@
 
 #include <QThread>
 #include <QString>
-#include <QMap>
+#include <QDeadlineTimer>
+#include <memory>
+#include "processsnapshot.h"
+#include "targetcatalog.h"
+#include "logchannel.h"
+#include "processterminator.h"
+#include "killscheduler.h"
+#include "cancellationtoken.h"
+#include "killprogress.h"
+#include "respawnpredictor.h"
 
-// 子线程：执行耗时的进程关闭操作，通过信号通知主线程进度/日志
+// 全量关闭的自适应调度参数：只对最新快照中仍存活或被重新拉起的目标再执行一轮，
+// 守护进程反复拉起时按带抖动的指数退避等待，连续 quietPeriodMs 内没有任何命中即结束
+struct SweepPolicy
+{
+    int maxRounds = 10;            // 轮次上限（防止与守护进程无限拉锯）
+    int quietPeriodMs = 300;       // 关闭后观察是否被重新拉起的静默期
+    int pollIntervalMs = 20;       // 静默期内的检测间隔（增量刷新，开销很小）
+    int initialBackoffMs = 50;     // 首次发现重新拉起后的等待时间
+    int maxBackoffMs = 2000;       // 退避上限
+    double jitter = 0.25;          // 退避时间的随机抖动比例（±）
+    int maxDurationMs = 15000;     // 整个任务的时间上限
+    bool neutralizeGuardians = true; // 每轮先按守护关系图挂起/终止目录声明的守护进程，再关闭客户端
+
+    // 第 streak 次连续发现重新拉起时的等待时间（毫秒）
+    int backoffDelay(int streak) const;
+};
+
+// 子线程：执行耗时的进程检测/关闭操作，通过排队信号通知主线程进度/日志/结果
+// 同一个任务对象同时服务于“关闭按钮”的检测关闭路径、强制执行的全量关闭路径以及冻结/解冻
 class KillProcessThread : public QThread
 {
     Q_OBJECT
 
 public:
-    explicit KillProcessThread(const QMap<QString, QString> &processMap, int totalRounds = 3, QObject *parent = nullptr);
+    enum Mode {
+        DetectAndKill,  // 检测第一个运行中的电子教室并关闭（关闭按钮）
+        ForceSweep,     // 多轮全量关闭（强制执行）
+        Freeze,         // 挂起全部目标而不终止：守护进程先于客户端、父进程先于子进程，挂起后无法再拉起或派生新进程
+        Thaw            // 按冻结的逆序恢复全部目标（Windows 上挂起可嵌套，冻结几次就需要解冻几次）
+    };
+
+    explicit KillProcessThread(const TargetCatalog &catalog, QObject *parent = nullptr);
+    // 复用调用方已编译的匹配器（匹配器可在多个线程间共享），避免每个任务重新编译正则
+    explicit KillProcessThread(const std::shared_ptr<const TargetMatcher> &matcher, QObject *parent = nullptr);
     ~KillProcessThread() override;
 
+    // 任务模式（默认 ForceSweep，需在 start() 前设置）
+    void setMode(Mode mode);
+    Mode mode() const { return m_mode; }
+    // 共享调用方的进程表缓存，使重复检测保持增量（任务运行期间调用方不得使用该缓存）
+    void setProcessCache(ProcessTableCache *cache);
+    // 日志改走批量通道（设置后不再逐条发送 logUpdated 信号）
+    void setLogChannel(const std::shared_ptr<LogChannel> &channel);
+    // 选择终止后端（默认原生系统调用；Shell 仅作兜底，需在 start() 前设置）
+    void setTerminatorBackend(ProcessTerminator::Backend backend);
+    // 进程树终止顺序（默认父先于子，需在 start() 前设置；冻结固定父先于子，解冻固定子先于父）
+    void setTreeOrder(ProcessSnapshot::TreeOrder order);
+    // 全量关闭的调度参数（需在 start() 前设置）
+    void setSweepPolicy(const SweepPolicy &policy);
+    // 与其他任务共享重新拉起预测（默认使用自己的实例，需在 start() 前设置）
+    // 静默期结束时若仍有目标处于预测的重新拉起窗口之前，继续观察到窗口结束（不超过时间上限）
+    void setRespawnPredictor(const std::shared_ptr<RespawnPredictor> &predictor);
+    // 任务整体截止时间（默认不限；需在 start() 前设置）
+    void setDeadline(QDeadlineTimer deadline);
+    // 请求取消（任意线程调用）：正在进行的等待立即返回，不再发送新的终止信号
+    void cancel();
+    bool isCancelled() const { return m_cancellation.isCancelled(); }
+    // 进度计数：任务运行期间由界面线程定时采样
+    std::shared_ptr<KillProgress> progress() const { return m_progress; }
+    // 实际执行的关闭轮次（任务结束后读取；0 表示没有检测到任何目标）
+    int roundsExecuted() const { return m_roundsExecuted; }
+    // 冻结/解冻耗时（毫秒）：从开始检测到最后一遍挂起/恢复完成；没有检测到目标时为 -1
+    qint64 freezeLatencyMs() const { return m_freezeLatencyMs; }
+
 signals:
     // 发送实时日志（供进度窗口显示）
     void logUpdated(const QString &log);
-    // 发送进度更新（当前进度/总进度）
-    void progressUpdated(int current, int total);
-    // 线程执行完成
+    // 线程执行完成（ForceSweep、Freeze、Thaw）
     void finishedKill();
+    // 检测关闭完成（DetectAndKill）：found 为是否检测到运行中的目标，success 为是否已全部关闭
+    void detectionFinished(const QString &className, const QString &processName, bool found, bool success);
+    // 单个目标终止完成（在工作线程中串行发出，跨线程接收需使用直接连接并自行同步）
+    void targetFinished(const KillTarget &target, int round);
 
 protected:
     void run() override;  // 线程核心执行函数
 
 private:
-    QMap<QString, QString> m_processMap;  // 待关闭的进程列表
-    int m_totalRounds;                    // 总执行轮次
-    // 单个进程关闭（纯函数，无UI操作）
-    void killSingleProcess(const QString &processName, const QString &className);
-    // 管理员权限执行命令
-    void runCommandAsAdmin(const QString &command);
+    std::shared_ptr<const TargetMatcher> m_matcher;  // 待关闭的目标（由目标目录编译）
+    SweepPolicy m_policy;                 // 全量关闭的调度参数
+    int m_roundsExecuted = 0;
+    qint64 m_freezeLatencyMs = -1;
+    std::unique_ptr<ProcessTerminator> m_terminator;  // 终止后端
+    Mode m_mode = ForceSweep;
+    std::shared_ptr<LogChannel> m_logChannel;
+    std::shared_ptr<KillProgress> m_progress;
+    std::shared_ptr<RespawnPredictor> m_predictor;
+    CancellationToken m_cancellation;
+    QDeadlineTimer m_deadline{QDeadlineTimer::Forever};
+    ProcessTableCache m_ownCache;         // 默认的进程表缓存（跨轮次复用）
+    ProcessTableCache *m_processCache;    // 实际使用的缓存（可由调用方共享）
+    ProcessSnapshot::TreeOrder m_treeOrder = ProcessSnapshot::TopDown;
+    // 日志出口：有通道时写入通道，否则发送信号
+    void appendLog(const QString &log);
+    // 已取消或整体截止时间已到
+    bool shouldStop() const;
+    void runDetectAndKill();
+    void runSweep();
+    void runFreeze();
+    void runThaw();
+    // 按阶段执行一批目标：同一阶段并行，阶段之间串行（descending 为从最后一个阶段倒序执行）
+    void runStages(KillScheduler &scheduler, const QList<KillTarget> &targets, bool descending,
+                   const KillScheduler::TargetCallback &onFinished);
+    // 按快照生成目标列表（每条命中的目录规则一个目标，各自带重试/超时状态）
+    // handled 中已确认退出或已挂起的进程（PID -> 启动时间）不再计入，避免未回收的僵尸进程、挂起的守护进程被当作重新拉起
+    // 启用守护进程处理时，守护进程按（拓扑层, 规则）生成单独的目标，客户端目标的 stage 排在拉起它的守护进程之后
+    // order 为子树内的进程顺序（冻结固定父先于子，其余模式按 setTreeOrder()）
+    QList<KillTarget> buildTargets(const ProcessSnapshot &snapshot, const QHash<qint64, quint64> &handled,
+                                   ProcessSnapshot::TreeOrder order) const;
+    // 守护关系图：生成各拓扑层的守护进程目标，并把客户端目标的 stage 设为其最深的层
+    QList<KillTarget> buildGuardianStages(const ProcessSnapshot &snapshot, const QHash<qint64, quint64> &handled,
+                                          QList<KillTarget> &clients) const;
+    // 刷新进程表并生成本轮目标
+    QList<KillTarget> scanTargets(int round, const QHash<qint64, quint64> &handled, ProcessSnapshot::TreeOrder order);
+    // 静默期内反复检测：一旦有目标被重新拉起立即返回，静默期（及 products 的预测窗口）结束仍无命中则返回空列表
+    QList<KillTarget> watchForRespawn(int round, const QHash<qint64, quint64> &handled, const QSet<QString> &products,
+                                      const QDeadlineTimer &deadline);
+    // 把本轮排入关闭的进程写入持久化日志（第 1 轮记为检测到，后续轮次记为被重新拉起）
+    void journalTargets(const QList<KillTarget> &targets, int round) const;
+    // 输出单个目标的终止结果（纯函数，无UI操作）
+    void logTargetResult(const KillTarget &target);
 };
 
 #endif // KILLPROCESSTHREAD_H
@@ -0,0 +1,27 @@
+#include "killprogress.h"
+
+bool KillProgress::Counters::operator==(const Counters &other) const
+{
+    return round == other.round && found == other.found && signalled == other.signalled
+           && exited == other.exited && failed == other.failed;
+}
+
+KillProgress::Counters KillProgress::sample() const
+{
+    Counters counters;
+    counters.round = m_round.load(std::memory_order_relaxed);
+    counters.found = m_found.load(std::memory_order_relaxed);
+    counters.signalled = m_signalled.load(std::memory_order_relaxed);
+    counters.exited = m_exited.load(std::memory_order_relaxed);
+    counters.failed = m_failed.load(std::memory_order_relaxed);
+    return counters;
+}
+
+void KillProgress::reset()
+{
+    m_round.store(0, std::memory_order_relaxed);
+    m_found.store(0, std::memory_order_relaxed);
+    m_signalled.store(0, std::memory_order_relaxed);
+    m_exited.store(0, std::memory_order_relaxed);
+    m_failed.store(0, std::memory_order_relaxed);
+}
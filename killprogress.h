@@ -0,0 +1,43 @@
+#ifndef KILLPROGRESS_H
+#define KILLPROGRESS_H
+
+#include <atomic>
+
+// 关闭任务的进度计数（以进程为工作单位）：引擎在工作线程中原子累加，界面线程定时采样
+// 不再为每个单位发送一次跨线程信号，目标数量和轮次变化时进度依然准确
+class KillProgress
+{
+public:
+    struct Counters
+    {
+        int round = 0;       // 当前轮次
+        int found = 0;       // 已排入关闭的进程（每轮累加，被重新拉起的进程会再次计入）
+        int signalled = 0;   // 已成功发送终止信号
+        int exited = 0;      // 已确认退出
+        int failed = 0;      // 本次尝试结束仍未退出（含终止调用失败）
+
+        int completed() const { return exited + failed; }
+        int remaining() const { return found > completed() ? found - completed() : 0; }
+        bool operator==(const Counters &other) const;
+        bool operator!=(const Counters &other) const { return !(*this == other); }
+    };
+
+    void setRound(int round) { m_round.store(round, std::memory_order_relaxed); }
+    void addFound(int count) { m_found.fetch_add(count, std::memory_order_relaxed); }
+    void addSignalled(int count) { m_signalled.fetch_add(count, std::memory_order_relaxed); }
+    void addExited(int count) { m_exited.fetch_add(count, std::memory_order_relaxed); }
+    void addFailed(int count) { m_failed.fetch_add(count, std::memory_order_relaxed); }
+
+    // 任意线程调用；各计数分别读取，采样期间可能相差一个单位，界面显示足够
+    Counters sample() const;
+    void reset();
+
+private:
+    std::atomic<int> m_round{0};
+    std::atomic<int> m_found{0};
+    std::atomic<int> m_signalled{0};
+    std::atomic<int> m_exited{0};
+    std::atomic<int> m_failed{0};
+};
+
+#endif // KILLPROGRESS_H
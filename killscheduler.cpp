@@ -0,0 +1,290 @@
+#include "killscheduler.h"
+#include <QDeadlineTimer>
+#include <QElapsedTimer>
+#include <QMutexLocker>
+#include <QSet>
+#include <QThread>
+#include "killtrace.h"
+#include "processwaiter.h"
+#include "sweepjournal.h"
+#include <limits>
+
+namespace {
+
+// 终止调用本身失败（如权限不足）时，同一目标两次尝试之间的间隔（只阻塞该目标所在的工作线程）
+constexpr int kRetryIntervalMs = 50;
+
+} // namespace
+
+bool KillTarget::succeeded() const
+{
+    for (const KillResult &result : results) {
+        if (action == Terminate ? !result.exited : !result.success) {
+            return false;
+        }
+    }
+    return true;
+}
+
+KillScheduler::KillScheduler(ProcessTerminator *terminator, int maxWorkers)
+    : m_terminator(terminator)
+{
+    m_pool.setMaxThreadCount(maxWorkers > 0 ? maxWorkers : qBound(2, QThread::idealThreadCount(), 8));
+}
+
+KillScheduler::~KillScheduler()
+{
+    m_pool.waitForDone();
+}
+
+void KillScheduler::setCancellation(const CancellationToken &token, QDeadlineTimer deadline)
+{
+    m_cancellation = token;
+    m_deadline = deadline;
+}
+
+void KillScheduler::setProgress(KillProgress *progress)
+{
+    m_progress = progress;
+}
+
+void KillScheduler::run(QList<KillTarget> &targets, const TargetCallback &onFinished)
+{
+    // 先分离一次，保证工作线程拿到的元素地址在整批执行期间保持不变
+    KillTarget *data = targets.data();
+    for (qsizetype i = 0; i < targets.size(); ++i) {
+        KillTarget *target = data + i;
+        m_pool.start([this, target, &onFinished]() {
+            killTarget(*target);
+            if (onFinished) {
+                QMutexLocker locker(&m_callbackMutex);
+                onFinished(*target);
+            }
+        });
+    }
+    m_pool.waitForDone();
+}
+
+void KillScheduler::killTarget(KillTarget &target) const
+{
+    if (target.action != KillTarget::Terminate) {
+        suspendTarget(target);
+        return;
+    }
+    KillTraceScope targetScope("target", target.className, 0, target.round);
+    QDeadlineTimer deadline(target.timeoutMs);
+    if (m_deadline < deadline) {
+        deadline = m_deadline;  // 不超过任务的整体截止时间
+    }
+    const qint64 attemptTimeoutMs = qMax(1, target.timeoutMs / qMax(1, target.maxAttempts));
+    target.results.resize(target.processes.size());
+    target.attempts = 0;
+    target.timedOut = false;
+    target.cancelled = false;
+
+    QList<int> pending;
+    for (int i = 0; i < target.processes.size(); ++i) {
+        pending.append(i);
+    }
+    QList<bool> everSignalled(target.processes.size(), false);
+
+    // 持久化日志：名称 ID 每个目标只查一次，关闭耗时从开始处理该目标算起
+    QList<quint32> journalNames;
+    if (SweepJournal::isEnabled()) {
+        for (const ProcessEntry &process : target.processes) {
+            journalNames.append(SweepJournal::nameId(target.className, process.name));
+        }
+    }
+    QElapsedTimer targetTimer;
+    targetTimer.start();
+
+    while (!pending.isEmpty() && target.attempts < target.maxAttempts) {
+        ++target.attempts;
+        QList<int> failed;
+        QList<int> signalled;
+        QList<ProcessEntry> signalledProcesses;
+        if (m_cancellation.isCancelled() || m_deadline.hasExpired()) {
+            // 已取消：不再发送终止信号，剩余进程保持未处理
+            for (int index : pending) {
+                target.results[index].pid = target.processes.at(index).pid;
+            }
+            target.cancelled = true;
+            break;
+        }
+        // 本次尝试的进程整批交给后端（助手后端据此把需要提权的进程合并为一次请求）
+        QList<ProcessEntry> batch;
+        for (int index : pending) {
+            batch.append(target.processes.at(index));
+        }
+        QList<KillResult> batchResults;
+        {
+            KillTraceScope signalScope("signal", target.className, batch.size() == 1 ? batch.first().pid : 0, target.round);
+            batchResults = m_terminator->terminateAll(batch);
+        }
+        for (int i = 0; i < pending.size(); ++i) {
+            const int index = pending.at(i);
+            target.results[index] = batchResults.at(i);
+            if (target.results.at(index).success) {
+                if (m_progress && !everSignalled.at(index)) {
+                    m_progress->addSignalled(1);  // 每个进程只计一次
+                }
+                if (!journalNames.isEmpty() && !everSignalled.at(index)) {
+                    SweepJournal::record(SweepJournal::Signalled, target.results.at(index).pid, journalNames.at(index), target.round);
+                }
+                everSignalled[index] = true;
+                signalled.append(index);
+                signalledProcesses.append(target.processes.at(index));
+            } else {
+                failed.append(index);
+            }
+        }
+
+        // 等待确认退出：全部退出即立即返回，只有存活下来的进程才进入下一次尝试
+        const QDeadlineTimer attemptDeadline(qMin(deadline.remainingTime(), attemptTimeoutMs));
+        QSet<qint64> survivors;
+        {
+            KillTraceScope waitScope("wait-for-exit", target.className, 0, target.round);
+            for (const ProcessEntry &process : ProcessWaiter::waitForExit(signalledProcesses, attemptDeadline, m_cancellation)) {
+                survivors.insert(process.pid);
+            }
+        }
+
+        pending = failed;
+        for (int index : signalled) {
+            KillResult &result = target.results[index];
+            result.exited = !survivors.contains(result.pid);
+            if (!result.exited) {
+                pending.append(index);
+                continue;
+            }
+            if (m_progress) {
+                m_progress->addExited(1);
+            }
+            if (!journalNames.isEmpty()) {
+                SweepJournal::record(SweepJournal::Exited, result.pid, journalNames.at(index), target.round,
+                                     quint32(qMin<qint64>(targetTimer.nsecsElapsed() / 1000, 0xFFFFFFFF)));
+            }
+        }
+
+        if (pending.isEmpty()) {
+            break;
+        }
+        if (m_cancellation.isCancelled() || m_deadline.hasExpired()) {
+            target.cancelled = true;
+            break;
+        }
+        if (target.attempts >= target.maxAttempts) {
+            break;
+        }
+        if (deadline.hasExpired()) {
+            target.timedOut = true;
+            break;
+        }
+        if (survivors.isEmpty()) {
+            // 仅有调用失败的进程：稍作间隔再试
+            if (deadline.remainingTime() <= kRetryIntervalMs) {
+                target.timedOut = true;
+                break;
+            }
+            KillTraceScope retryScope("retry", target.className, 0, target.round);
+            if (!m_cancellation.sleep(kRetryIntervalMs)) {
+                target.cancelled = true;
+                break;
+            }
+        }
+    }
+
+    int failedCount = 0;
+    for (int i = 0; i < target.results.size(); ++i) {
+        const KillResult &result = target.results.at(i);
+        if (result.exited) {
+            continue;
+        }
+        ++failedCount;
+        if (!journalNames.isEmpty()) {
+            SweepJournal::record(SweepJournal::Failed, target.processes.at(i).pid, journalNames.at(i), target.round, 0,
+                                 result.errorCode, true);
+        }
+    }
+    if (m_progress) {
+        m_progress->addFailed(failedCount);
+    }
+}
+
+void KillScheduler::suspendTarget(KillTarget &target) const
+{
+    const bool resume = target.action == KillTarget::Resume;
+    KillTraceScope targetScope(resume ? "resume" : "suspend", target.className, 0, target.round);
+    target.results.resize(target.processes.size());
+    target.attempts = 0;
+    target.timedOut = false;
+    target.cancelled = false;
+
+    QList<quint32> journalNames;
+    if (SweepJournal::isEnabled()) {
+        for (const ProcessEntry &process : target.processes) {
+            journalNames.append(SweepJournal::nameId(target.className, process.name));
+        }
+    }
+
+    // 挂起/恢复是同步完成的：调用成功即生效，只对调用失败的进程重试
+    // 每次尝试把仍待处理的进程整批交给后端，助手后端只需一次往返，冻结时各进程停下的时刻也尽量接近
+    QElapsedTimer clock;
+    clock.start();
+    QList<int> pending;
+    for (int i = 0; i < target.processes.size(); ++i) {
+        pending.append(i);
+    }
+    while (!pending.isEmpty() && target.attempts < target.maxAttempts) {
+        ++target.attempts;
+        if (m_cancellation.isCancelled() || m_deadline.hasExpired()) {
+            for (int index : pending) {
+                target.results[index].pid = target.processes.at(index).pid;
+            }
+            target.cancelled = true;
+            break;
+        }
+        QList<ProcessEntry> batch;
+        batch.reserve(pending.size());
+        for (int index : pending) {
+            batch.append(target.processes.at(index));
+        }
+        const QList<KillResult> results = resume ? m_terminator->resumeAll(batch) : m_terminator->suspendAll(batch);
+        const quint32 latencyUs = quint32(qMin<qint64>(clock.nsecsElapsed() / 1000, std::numeric_limits<quint32>::max()));
+        QList<int> failed;
+        for (int i = 0; i < pending.size(); ++i) {
+            const int index = pending.at(i);
+            target.results[index] = results.at(i);
+            if (!target.results.at(index).success) {
+                failed.append(index);
+                continue;
+            }
+            if (m_progress) {
+                m_progress->addSignalled(1);
+                m_progress->addExited(1);
+            }
+            if (!journalNames.isEmpty()) {
+                SweepJournal::record(resume ? SweepJournal::Resumed : SweepJournal::Suspended, target.results.at(index).pid,
+                                     journalNames.at(index), target.round, latencyUs);
+            }
+        }
+        pending = failed;
+        if (pending.isEmpty() || target.attempts >= target.maxAttempts) {
+            break;
+        }
+        if (!m_cancellation.sleep(kRetryIntervalMs)) {
+            target.cancelled = true;
+            break;
+        }
+    }
+
+    for (int index : pending) {
+        if (!journalNames.isEmpty()) {
+            SweepJournal::record(SweepJournal::Failed, target.processes.at(index).pid, journalNames.at(index), target.round, 0,
+                                 target.results.at(index).errorCode, true);
+        }
+    }
+    if (m_progress) {
+        m_progress->addFailed(int(pending.size()));
+    }
+}
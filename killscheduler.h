@@ -0,0 +1,76 @@
+#ifndef KILLSCHEDULER_H
+#define KILLSCHEDULER_H
+
+#include <QDeadlineTimer>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QThreadPool>
+#include <functional>
+#include "processsnapshot.h"
+#include "processterminator.h"
+#include "cancellationtoken.h"
+#include "killprogress.h"
+
+// 单个目标（一个映像名）的终止任务及其独立的重试/超时状态
+struct KillTarget
+{
+    enum Action {
+        Terminate,  // 终止并等待确认退出
+        Suspend,    // 挂起（守护进程、冻结模式）：不等待退出，挂起成功即完成
+        Resume      // 恢复（解冻模式）：恢复成功即完成
+    };
+
+    QString processName;
+    QString className;
+    QList<ProcessEntry> processes;  // 本轮快照中匹配到的进程
+    int maxAttempts = 3;            // 单个目标的最大尝试次数（仅对存活下来的进程重试）
+    int timeoutMs = 2000;           // 单个目标的总超时（含等待退出确认）
+    int round = 0;                  // 所属轮次（仅用于分阶段计时）
+    Action action = Terminate;
+    int stage = 0;                  // 轮内阶段（守护关系图的拓扑层）：守护进程先于其拉起的进程处理
+    bool guardian = false;          // 目标为守护进程（仅用于日志）
+
+    // 以下由调度器填写，与 processes 一一对应
+    QList<KillResult> results;
+    int attempts = 0;
+    bool timedOut = false;
+    bool cancelled = false;         // 任务被取消或整体截止时间已到，未完成全部尝试
+
+    // 所有进程均已确认退出（Suspend/Resume：均已挂起/恢复）
+    bool succeeded() const;
+};
+
+// 并行终止调度器：将一批目标分发到有界线程池，各目标互不等待
+// 整批耗时取决于最慢的单个目标，而不是所有目标耗时之和
+class KillScheduler
+{
+public:
+    using TargetCallback = std::function<void(const KillTarget &target)>;
+
+    // terminator 需可重入（原生后端无状态，Shell 后端每次调用使用独立的 QProcess）
+    explicit KillScheduler(ProcessTerminator *terminator, int maxWorkers = 0);
+    ~KillScheduler();
+
+    // 任务级取消与整体截止时间：每次系统调用和等待之前检查，等待中被取消时立即返回
+    void setCancellation(const CancellationToken &token, QDeadlineTimer deadline = QDeadlineTimer(QDeadlineTimer::Forever));
+
+    // 进度计数（可选）：每个进程发送终止信号、确认退出或放弃时累加（挂起/恢复成功按确认退出计）
+    void setProgress(KillProgress *progress);
+
+    // 阻塞执行整批目标；onFinished 在工作线程中被串行调用
+    void run(QList<KillTarget> &targets, const TargetCallback &onFinished = TargetCallback());
+
+private:
+    void killTarget(KillTarget &target) const;
+    void suspendTarget(KillTarget &target) const;
+
+    ProcessTerminator *m_terminator;
+    CancellationToken m_cancellation;
+    KillProgress *m_progress = nullptr;
+    QDeadlineTimer m_deadline{QDeadlineTimer::Forever};
+    QThreadPool m_pool;
+    QMutex m_callbackMutex;
+};
+
+#endif // KILLSCHEDULER_H
@@ -0,0 +1,161 @@
+#include "killtrace.h"
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+
+namespace {
+
+constexpr quint64 kCapacity = 16384;  // 2 的幂，按位与取槽位
+
+// 预分配的事件槽位；committed 为写入完成时的序号 + 1，用于导出时跳过未写完或已被覆盖的槽位
+struct Slot
+{
+    std::atomic<quint64> committed{0};
+    KillTrace::Event event;
+};
+
+std::unique_ptr<Slot[]> traceSlots(new Slot[kCapacity]);
+std::atomic<quint64> nextSequence{0};
+std::atomic<qint64> epochNs{0};
+std::atomic<int> nextThread{0};
+
+qint64 steadyNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int currentThread()
+{
+    thread_local const int thread = nextThread.fetch_add(1, std::memory_order_relaxed) + 1;
+    return thread;
+}
+
+} // namespace
+
+std::atomic<bool> KillTrace::s_enabled{false};
+
+void KillTrace::setEnabled(bool enabled)
+{
+    if (enabled) {
+        clear();
+        epochNs.store(steadyNs(), std::memory_order_relaxed);
+    }
+    s_enabled.store(enabled, std::memory_order_release);
+}
+
+qint64 KillTrace::nowNs()
+{
+    return steadyNs() - epochNs.load(std::memory_order_relaxed);
+}
+
+void KillTrace::record(const char *phase, qint64 startNs, qint64 durationNs, const QString &target, qint64 pid, int round)
+{
+    if (!isEnabled()) {
+        return;
+    }
+    const quint64 sequence = nextSequence.fetch_add(1, std::memory_order_relaxed);
+    Slot &slot = traceSlots[sequence & (kCapacity - 1)];
+    slot.committed.store(0, std::memory_order_relaxed);
+    slot.event.phase = phase;
+    slot.event.target = target;
+    slot.event.pid = pid;
+    slot.event.round = round;
+    slot.event.thread = currentThread();
+    slot.event.startNs = startNs;
+    slot.event.durationNs = durationNs;
+    slot.committed.store(sequence + 1, std::memory_order_release);
+}
+
+QList<KillTrace::Event> KillTrace::events()
+{
+    const quint64 end = nextSequence.load(std::memory_order_acquire);
+    const quint64 begin = end > kCapacity ? end - kCapacity : 0;
+    QList<Event> result;
+    result.reserve(qsizetype(end - begin));
+    for (quint64 sequence = begin; sequence < end; ++sequence) {
+        const Slot &slot = traceSlots[sequence & (kCapacity - 1)];
+        if (slot.committed.load(std::memory_order_acquire) == sequence + 1) {
+            result.append(slot.event);
+        }
+    }
+    std::sort(result.begin(), result.end(), [](const Event &left, const Event &right) {
+        return left.startNs < right.startNs;
+    });
+    return result;
+}
+
+void KillTrace::clear()
+{
+    for (quint64 i = 0; i < kCapacity; ++i) {
+        traceSlots[i].committed.store(0, std::memory_order_relaxed);
+        traceSlots[i].event = Event();
+    }
+    nextSequence.store(0, std::memory_order_release);
+}
+
+bool KillTrace::exportToFile(const QString &path, QString *errorString)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        if (errorString) {
+            *errorString = file.errorString();
+        }
+        return false;
+    }
+    const QList<Event> list = events();
+    file.write(path.endsWith(".csv", Qt::CaseInsensitive) ? toCsv(list) : toChromeTrace(list));
+    return true;
+}
+
+QByteArray KillTrace::toChromeTrace(const QList<Event> &events)
+{
+    QJsonArray traceEvents;
+    for (const Event &event : events) {
+        QJsonObject args;
+        if (!event.target.isEmpty()) {
+            args.insert("target", event.target);
+        }
+        if (event.pid) {
+            args.insert("pid", event.pid);
+        }
+        if (event.round) {
+            args.insert("round", event.round);
+        }
+        QJsonObject object;
+        object.insert("name", QString::fromLatin1(event.phase));
+        object.insert("cat", "kill");
+        object.insert("ph", "X");  // 完整事件（开始时间 + 持续时间）
+        object.insert("ts", event.startNs / 1000.0);
+        object.insert("dur", event.durationNs / 1000.0);
+        object.insert("pid", 1);
+        object.insert("tid", event.thread);
+        object.insert("args", args);
+        traceEvents.append(object);
+    }
+    QJsonObject root;
+    root.insert("traceEvents", traceEvents);
+    root.insert("displayTimeUnit", "ms");
+    return QJsonDocument(root).toJson(QJsonDocument::Compact);
+}
+
+QByteArray KillTrace::toCsv(const QList<Event> &events)
+{
+    QByteArray csv("phase,target,pid,round,thread,start_us,duration_us\n");
+    for (const Event &event : events) {
+        QString target = event.target;
+        target.replace('"', "\"\"");
+        csv += QString("%1,\"%2\",%3,%4,%5,%6,%7\n")
+                   .arg(QString::fromLatin1(event.phase), target)
+                   .arg(event.pid)
+                   .arg(event.round)
+                   .arg(event.thread)
+                   .arg(event.startNs / 1000.0, 0, 'f', 3)
+                   .arg(event.durationNs / 1000.0, 0, 'f', 3)
+                   .toUtf8();
+    }
+    return csv;
+}
@@ -0,0 +1,77 @@
+#ifndef KILLTRACE_H
+#define KILLTRACE_H
+
+#include <QList>
+#include <QString>
+#include <atomic>
+
+// 关闭流程的分阶段计时：枚举、匹配、发送终止信号、等待退出、重试间隔
+// 事件写入预分配的环形缓冲区（写满后覆盖最旧的事件），可导出为 Chrome trace-event JSON 或 CSV
+// 未启用时每个计时点只有一次原子读取
+class KillTrace
+{
+public:
+    struct Event
+    {
+        const char *phase = nullptr;  // 阶段名（字符串字面量）
+        QString target;               // 教室软件名称（可为空）
+        qint64 pid = 0;
+        int round = 0;
+        int thread = 0;               // 线程序号（从 1 开始，按首次记录的先后分配）
+        qint64 startNs = 0;           // 单调时钟，相对 setEnabled(true) 时刻
+        qint64 durationNs = 0;
+    };
+
+    static bool isEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+    // 启用时清空缓冲区并重置时间起点
+    static void setEnabled(bool enabled);
+
+    static qint64 nowNs();
+    static void record(const char *phase, qint64 startNs, qint64 durationNs,
+                       const QString &target = QString(), qint64 pid = 0, int round = 0);
+
+    // 按时间顺序返回缓冲区中的事件；应在没有关闭任务运行时调用
+    static QList<Event> events();
+    static void clear();
+
+    // 按扩展名选择格式：.csv 输出 CSV，其余输出 Chrome trace-event JSON（可在 chrome://tracing 或 Perfetto 中打开）
+    static bool exportToFile(const QString &path, QString *errorString = nullptr);
+    static QByteArray toChromeTrace(const QList<Event> &events);
+    static QByteArray toCsv(const QList<Event> &events);
+
+private:
+    static std::atomic<bool> s_enabled;
+};
+
+// 作用域计时：构造时记下开始时间，析构时写入一条事件
+class KillTraceScope
+{
+public:
+    explicit KillTraceScope(const char *phase, const QString &target = QString(), qint64 pid = 0, int round = 0)
+        : m_phase(phase)
+        , m_startNs(KillTrace::isEnabled() ? KillTrace::nowNs() : -1)
+        , m_target(m_startNs >= 0 ? target : QString())
+        , m_pid(pid)
+        , m_round(round)
+    {
+    }
+
+    ~KillTraceScope()
+    {
+        if (m_startNs >= 0) {
+            KillTrace::record(m_phase, m_startNs, KillTrace::nowNs() - m_startNs, m_target, m_pid, m_round);
+        }
+    }
+
+    KillTraceScope(const KillTraceScope &) = delete;
+    KillTraceScope &operator=(const KillTraceScope &) = delete;
+
+private:
+    const char *m_phase;
+    qint64 m_startNs;
+    QString m_target;
+    qint64 m_pid;
+    int m_round;
+};
+
+#endif // KILLTRACE_H
@@ -0,0 +1,58 @@
+#include "logchannel.h"
+#include <QDateTime>
+
+LogChannel::LogChannel(int capacity)
+{
+    quint64 size = 2;
+    while (size < quint64(qMax(capacity, 2))) {
+        size <<= 1;
+    }
+    m_cells.reset(new Cell[size]);
+    m_mask = size - 1;
+    for (quint64 i = 0; i < size; ++i) {
+        m_cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+bool LogChannel::push(const QString &text)
+{
+    quint64 position = m_enqueuePosition.load(std::memory_order_relaxed);
+    for (;;) {
+        Cell &cell = m_cells[position & m_mask];
+        const quint64 sequence = cell.sequence.load(std::memory_order_acquire);
+        const qint64 difference = qint64(sequence) - qint64(position);
+        if (difference == 0) {
+            // 抢占该槽位
+            if (m_enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                cell.message.timestamp = QDateTime::currentMSecsSinceEpoch();
+                cell.message.text = text;
+                cell.sequence.store(position + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (difference < 0) {
+            // 缓冲区已满：日志不应反向阻塞关闭流程
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        } else {
+            position = m_enqueuePosition.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+int LogChannel::drain(QList<Message> &out, int maxCount)
+{
+    int count = 0;
+    while (count < maxCount) {
+        Cell &cell = m_cells[m_dequeuePosition & m_mask];
+        const quint64 sequence = cell.sequence.load(std::memory_order_acquire);
+        if (qint64(sequence) - qint64(m_dequeuePosition + 1) < 0) {
+            break;  // 空
+        }
+        out.append(std::move(cell.message));
+        cell.message = Message();
+        cell.sequence.store(m_dequeuePosition + m_mask + 1, std::memory_order_release);
+        ++m_dequeuePosition;
+        ++count;
+    }
+    return count;
+}
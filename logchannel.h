@@ -0,0 +1,45 @@
+#ifndef LOGCHANNEL_H
+#define LOGCHANNEL_H
+
+#include <QList>
+#include <QString>
+#include <atomic>
+#include <memory>
+
+// 工作线程 → 界面线程的日志通道
+// 日志写入有界无锁环形缓冲区（多生产者、单消费者），界面线程按帧率定时批量取出，
+// 不再为每条消息发送跨线程信号（进度见 KillProgress）
+class LogChannel
+{
+public:
+    struct Message
+    {
+        qint64 timestamp = 0;  // 写入时间（自纪元起的毫秒数）
+        QString text;
+    };
+
+    // capacity 向上取整为 2 的幂
+    explicit LogChannel(int capacity = 4096);
+
+    // 任意线程调用，无锁；缓冲区满时丢弃并计数
+    bool push(const QString &text);
+    // 仅消费者（界面线程）调用：取出至多 maxCount 条消息，返回条数
+    int drain(QList<Message> &out, int maxCount = 1024);
+
+    quint64 droppedCount() const { return m_dropped.load(std::memory_order_relaxed); }
+
+private:
+    struct Cell
+    {
+        std::atomic<quint64> sequence{0};
+        Message message;
+    };
+
+    std::unique_ptr<Cell[]> m_cells;
+    quint64 m_mask;
+    alignas(64) std::atomic<quint64> m_enqueuePosition{0};
+    alignas(64) quint64 m_dequeuePosition = 0;  // 单消费者，无需原子
+    std::atomic<quint64> m_dropped{0};
+};
+
+#endif // LOGCHANNEL_H
@@ -1,12 +1,45 @@
 #include "mainwindow.h"
+#include "startuptrace.h"
 
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QStandardPaths>
 
 int main(int argc, char *argv[])
 {
+    StartupTrace::start();
     QApplication a(argc, argv);
     QApplication::setWindowIcon(QIcon(":/logo.ico"));
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption watchOption("watch", "以守护模式在后台运行，自动关闭新启动的电子教室进程");
+    parser.addOption(watchOption);
+    QCommandLineOption startupTraceOption("startup-trace", "输出各启动阶段的时间戳（毫秒），用于测量冷启动耗时");
+    parser.addOption(startupTraceOption);
+    QCommandLineOption killTraceOption("kill-trace", "记录关闭流程的分阶段计时，每次关闭任务结束后写入文件（.csv 为 CSV，其余为 Chrome trace-event JSON）", "path");
+    parser.addOption(killTraceOption);
+    QCommandLineOption journalOption("journal", "检测/关闭事件的持久化日志文件（默认写入应用数据目录，传空字符串则不记录）", "path",
+                                     QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + "/sweep-journal.bin");
+    parser.addOption(journalOption);
+    parser.process(a);
+    StartupTrace::setEnabled(parser.isSet(startupTraceOption));
+    StartupTrace::mark("QApplication 创建完成");
+
     MainWindow w;
-    w.show();
+    if (parser.isSet(killTraceOption)) {
+        w.setKillTracePath(parser.value(killTraceOption));
+    }
+    w.setJournalPath(parser.value(journalOption));
+    if (parser.isSet(watchOption)) {
+        w.startWatchdog();
+        // 没有系统托盘时仍显示主窗口，避免程序不可见
+        if (!QSystemTrayIcon::isSystemTrayAvailable()) {
+            w.show();
+        }
+    } else {
+        w.show();
+        StartupTrace::mark("主窗口已显示");
+    }
     return a.exec();
 }
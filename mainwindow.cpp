@@ -15,12 +15,17 @@
 #include <QRegularExpression>
 #include <QVBoxLayout>
 #include <QTime>
+#include <QMenu>
 #include "stop.h"
 #include "up.h"
 #include "versionchecker.h"
 #include "help.h"
 #include "progresswindow.h"  // 确保包含进度窗口头文件
 #include "killprocessthread.h"  // 确保包含线程头文件
+#include "processsnapshot.h"
+#include "startuptrace.h"
+#include "killtrace.h"
+#include "sweepjournal.h"
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
@@ -36,94 +41,212 @@ MainWindow::MainWindow(QWidget *parent)
 
     // 连接服务器/版本检查信号（核心：修复服务器离线逻辑+标题追加）
     connect(m_versionChecker, &VersionChecker::serverOnline, this, [=]() {
+        StartupTrace::mark("服务器检查完成（在线）");
         qDebug() << "服务器在线";
+        // 缓存中是离线、刷新后恢复在线时去掉标题标注
+        this->setWindowTitle(m_originalWindowTitle);
     });
     connect(m_versionChecker, &VersionChecker::serverOffline, this, [=]() {
-        // 弹出带确定/取消的提示框
-        QMessageBox msgBox;
-        msgBox.setIcon(QMessageBox::Warning);
-        msgBox.setWindowTitle("服务提示");
-        msgBox.setText("检测到qingfangcomputer.com不在线，将提供有限的服务<br>或您没有连接到互联网！");
-        // 设置按钮文本：确定、取消
-        msgBox.setStandardButtons(QMessageBox::Ok | QMessageBox::Cancel);
-        msgBox.setButtonText(QMessageBox::Ok, "确定");
-        msgBox.setButtonText(QMessageBox::Cancel, "取消");
-        msgBox.setDefaultButton(QMessageBox::Ok);
-
-        // 处理按钮点击
-        int ret = msgBox.exec();
-        if (ret == QMessageBox::Cancel) {
-            // 点击取消：退出应用
-            QApplication::quit();
-        } else if (ret == QMessageBox::Ok) {
-            // 点击确定：追加“有限的体验”到标题
-            QString newTitle = QString("%1 ❌有限的体验").arg(m_originalWindowTitle);
-            this->setWindowTitle(newTitle);
-        }
+        StartupTrace::mark("服务器检查完成（离线）");
+        // 不再弹出模态对话框：离线时直接在标题上标注“有限的体验”
+        this->setWindowTitle(QString("%1 ❌有限的体验").arg(m_originalWindowTitle));
     });
     connect(m_versionChecker, &VersionChecker::newVersionAvailable, this, &MainWindow::onNewVersionAvailable);
     connect(m_versionChecker, &VersionChecker::noUpdatesAvailable, this, &MainWindow::onNoUpdatesAvailable);
 
-    m_versionChecker->checkServerAvailability();
-    m_versionChecker->checkForUpdates("4.3.1");
     setupUI();
+    setupTrayIcon();
+    // 构造函数只搭建界面；目录加载、进程快照、壁纸解码和网络检查都推迟到首帧之后
+    ui->commandLinkButton->setEnabled(false);
+    QTimer::singleShot(0, this, &MainWindow::startDeferredInitialization);
+    StartupTrace::mark("主窗口构造完成");
+}
+
+void MainWindow::startDeferredInitialization()
+{
+    StartupTrace::mark("首帧之后开始延迟初始化");
+
+    m_startupLoader = new StartupLoader(this);
+    m_startupLoader->setJournalPath(m_journalPath);
+    connect(m_startupLoader, &QThread::finished, this, &MainWindow::onStartupLoaderFinished);
+    m_startupLoader->start();
+
+    m_wallpaper->load();
+
+    // 先按磁盘缓存立即应答，缓存过期时才在后台发起一次条件 GET
+    m_versionChecker->check("4.3.1");
+    StartupTrace::mark("版本检查已发出");
+}
+
+void MainWindow::onStartupLoaderFinished()
+{
+    m_catalog = m_startupLoader->catalog();
+    m_matcher = m_startupLoader->matcher();
+    m_processCache = m_startupLoader->processCache();
+    m_startupLoader->deleteLater();
+    m_startupLoader = nullptr;
+
+    m_startupReady = true;
+    ui->commandLinkButton->setEnabled(true);
+    if (m_pendingWatchdog) {
+        m_pendingWatchdog = false;
+        startWatchdog();
+    }
+    StartupTrace::mark("可交互");
 }
 
 MainWindow::~MainWindow()
 {
+    stopWatchdog();
+    if (m_startupLoader) {
+        m_startupLoader->wait();
+    }
     delete ui;
     delete m_versionChecker;
-    // 释放子线程和进度窗口
+    // 释放子线程和进度窗口（取消后线程在几毫秒内结束）
     if (m_killThread) {
-        m_killThread->quit();
+        m_killThread->cancel();
         m_killThread->wait();
         delete m_killThread;
     }
     if (m_progressWindow) {
         delete m_progressWindow;
     }
+    // 所有关闭/守护线程都已结束，写出剩余记录
+    SweepJournal::close();
 }
 
-// 子线程日志更新 → 转发给进度窗口
-void MainWindow::onThreadLogUpdated(const QString &log)
+// 子线程执行完成 → 通知进度窗口
+void MainWindow::onThreadFinished()
 {
+    // 只处理当前任务的完成信号（不能等待或释放其他任务）
+    if (!m_killThread || sender() != m_killThread) {
+        return;
+    }
     if (m_progressWindow) {
-        m_progressWindow->appendLog(log);
+        // 用户已取消时进度窗口已关闭，不再弹出完成提示
+        if (!m_killThread->isCancelled()) {
+            m_progressWindow->finishProgress(m_killThread->roundsExecuted());
+        }
+        m_progressWindow->deleteLater();  // 延迟释放，避免UI卡顿
+        m_progressWindow = nullptr;
     }
+    // 重置计数器
+    m_clickCount = 0;
+    // 释放子线程
+    m_killThread->quit();
+    m_killThread->wait();
+    m_killThread->deleteLater();
+    m_killThread = nullptr;
+    exportKillTrace();
 }
 
-// 子线程进度更新 → 转发给进度窗口
-void MainWindow::onThreadProgressUpdated(int current, int total)
+// 托盘图标：守护模式、冻结/解冻可从托盘操作，窗口隐藏时程序继续在后台运行
+void MainWindow::setupTrayIcon()
 {
-    if (m_progressWindow) {
-        m_progressWindow->updateProgress(current, total);
+    if (!QSystemTrayIcon::isSystemTrayAvailable()) {
+        return;
     }
+
+    QMenu *trayMenu = new QMenu(this);
+    trayMenu->addAction("显示主窗口", this, [=]() {
+        showNormal();
+        activateWindow();
+    });
+    m_watchAction = trayMenu->addAction("守护模式");
+    m_watchAction->setCheckable(true);
+    connect(m_watchAction, &QAction::toggled, this, [=](bool checked) {
+        if (checked) {
+            startWatchdog();
+        } else {
+            stopWatchdog();
+        }
+    });
+    trayMenu->addAction("冻结电子教室", this, [=]() {
+        startFreezeJob(KillProcessThread::Freeze);
+    });
+    trayMenu->addAction("解冻电子教室", this, [=]() {
+        startFreezeJob(KillProcessThread::Thaw);
+    });
+    trayMenu->addSeparator();
+    trayMenu->addAction("退出", qApp, &QApplication::quit);
+
+    m_trayIcon = new QSystemTrayIcon(QIcon(":/logo.ico"), this);
+    m_trayIcon->setToolTip(m_originalWindowTitle);
+    m_trayIcon->setContextMenu(trayMenu);
+    m_trayIcon->show();
 }
 
-// 子线程执行完成 → 通知进度窗口
-void MainWindow::onThreadFinished()
+void MainWindow::startWatchdog()
 {
-    if (m_progressWindow) {
-        m_progressWindow->finishProgress();
-        m_progressWindow->deleteLater();  // 延迟释放，避免UI卡顿
-        m_progressWindow = nullptr;
+    if (isWatchdogRunning()) {
+        return;
     }
-    // 重置计数器
-    m_clickCount = 0;
-    // 释放子线程
-    if (m_killThread) {
-        m_killThread->quit();
-        m_killThread->wait();
-        m_killThread->deleteLater();
-        m_killThread = nullptr;
+    if (!m_startupReady) {
+        // 目标目录尚未加载，初始化完成后自动启动
+        m_pendingWatchdog = true;
+        if (m_watchAction) {
+            QSignalBlocker blocker(m_watchAction);
+            m_watchAction->setChecked(true);
+        }
+        return;
+    }
+    m_watchdog = new ProcessWatchdog(m_catalog, this);
+    m_watchdog->setRespawnPredictor(m_respawnPredictor);
+    connect(m_watchdog, &ProcessWatchdog::logUpdated, this, [](const QString &log) {
+        qDebug() << log;
+    });
+    connect(m_watchdog, &ProcessWatchdog::targetKilled, this, &MainWindow::onWatchdogTargetKilled);
+    m_watchdog->start();
+
+    // 守护模式下关闭窗口只隐藏到托盘
+    QApplication::setQuitOnLastWindowClosed(m_trayIcon == nullptr);
+    if (m_watchAction) {
+        QSignalBlocker blocker(m_watchAction);
+        m_watchAction->setChecked(true);
+    }
+    if (m_trayIcon) {
+        m_trayIcon->setToolTip(QString("%1（守护模式）").arg(m_originalWindowTitle));
     }
 }
 
-// 强制执行关闭（核心修改：传入QMap类型的进程列表+防止重复点击）
+void MainWindow::stopWatchdog()
+{
+    m_pendingWatchdog = false;
+    if (!m_watchdog) {
+        return;
+    }
+    m_watchdog->stop();
+    delete m_watchdog;
+    m_watchdog = nullptr;
+
+    QApplication::setQuitOnLastWindowClosed(true);
+    if (m_watchAction) {
+        QSignalBlocker blocker(m_watchAction);
+        m_watchAction->setChecked(false);
+    }
+    if (m_trayIcon) {
+        m_trayIcon->setToolTip(m_originalWindowTitle);
+    }
+}
+
+bool MainWindow::isWatchdogRunning() const
+{
+    return m_watchdog && m_watchdog->isRunning();
+}
+
+void MainWindow::onWatchdogTargetKilled(const QString &className, const QString &processName, qint64 pid)
+{
+    if (m_trayIcon) {
+        m_trayIcon->showMessage("守护模式", QString("已关闭 %1（进程：%2，PID：%3）").arg(className).arg(processName).arg(pid));
+    }
+}
+
+// 强制执行关闭（传入目标目录+防止重复点击）
 void MainWindow::forceKillAllClassroomProcesses()
 {
     // 防止重复点击创建多个线程/窗口
-    if (m_killThread && m_killThread->isRunning()) {
+    if (isKillJobRunning()) {
         QMessageBox::warning(this, "提示", "正在执行进程关闭操作，请等待完成！");
         return;
     }
@@ -135,42 +258,141 @@ void MainWindow::forceKillAllClassroomProcesses()
     m_progressWindow = new ProgressWindow(this);
     m_progressWindow->show();
 
-    // 修正：传入QMap类型的m_classroomProcesses（匹配线程构造函数）
-    m_killThread = new KillProcessThread(m_classroomProcesses, 3, this);
-    // 连接子线程信号到主窗口槽函数
-    connect(m_killThread, &KillProcessThread::logUpdated, this, &MainWindow::onThreadLogUpdated);
-    connect(m_killThread, &KillProcessThread::progressUpdated, this, &MainWindow::onThreadProgressUpdated);
+    m_killThread = new KillProcessThread(m_matcher, this);
+    m_killThread->setMode(KillProcessThread::ForceSweep);
+    m_killThread->setProcessCache(&m_processCache);
+    m_killThread->setRespawnPredictor(m_respawnPredictor);
+    // 权限不足的进程整批转交特权助手（首次需要时提权启动一次，之后整个会话复用）
+    m_killThread->setTerminatorBackend(ProcessTerminator::Helper);
+    // 日志经无锁通道批量送达，进度由引擎原子计数，进度窗口按帧率取数/采样，不再逐条跨线程发信号
+    auto logChannel = std::make_shared<LogChannel>();
+    m_killThread->setLogChannel(logChannel);
+    m_progressWindow->attachChannel(logChannel, m_killThread->progress());
     connect(m_killThread, &KillProcessThread::finishedKill, this, &MainWindow::onThreadFinished);
+    connect(m_progressWindow, &ProgressWindow::cancelRequested, m_killThread, &KillProcessThread::cancel);
 
     // 启动子线程
     m_killThread->start();
 }
 
-// 核心：关闭按钮点击逻辑（修复QMap迭代器调用）
+// 冻结/解冻：与关闭任务共用任务对象，结果只在托盘提示（无托盘时弹窗）
+void MainWindow::startFreezeJob(KillProcessThread::Mode mode)
+{
+    if (isKillJobRunning()) {
+        QMessageBox::warning(this, "提示", "正在执行进程关闭操作，请等待完成！");
+        return;
+    }
+    if (!m_startupReady) {
+        QMessageBox::information(this, "提示", "正在加载目标列表，请稍后再试");
+        return;
+    }
+
+    m_killThread = new KillProcessThread(m_matcher, this);
+    m_killThread->setMode(mode);
+    m_killThread->setProcessCache(&m_processCache);
+    m_killThread->setTerminatorBackend(ProcessTerminator::Helper);
+    connect(m_killThread, &KillProcessThread::logUpdated, this, [](const QString &log) {
+        qDebug() << log;
+    });
+    connect(m_killThread, &KillProcessThread::finishedKill, this, &MainWindow::onFreezeFinished);
+    m_killThread->start();
+}
+
+void MainWindow::onFreezeFinished()
+{
+    if (!m_killThread || sender() != m_killThread) {
+        return;
+    }
+    m_killThread->wait();  // 信号在 run() 末尾发出，线程即将结束
+    const bool freeze = m_killThread->mode() == KillProcessThread::Freeze;
+    const qint64 latencyMs = m_killThread->freezeLatencyMs();
+    const int passes = m_killThread->roundsExecuted();
+    m_killThread->deleteLater();
+    m_killThread = nullptr;
+    exportKillTrace();
+
+    const QString title = freeze ? QString("冻结") : QString("解冻");
+    QString message;
+    if (latencyMs < 0) {
+        message = "未检测到运行中的电子教室";
+    } else if (freeze) {
+        message = QString("已冻结电子教室（%1遍，耗时%2毫秒）").arg(passes).arg(latencyMs);
+    } else {
+        message = QString("已解冻电子教室（耗时%1毫秒）").arg(latencyMs);
+    }
+    if (m_trayIcon) {
+        m_trayIcon->showMessage(title, message);
+    } else {
+        QMessageBox::information(this, title, message);
+    }
+}
+
+bool MainWindow::isKillJobRunning() const
+{
+    return m_killThread != nullptr;
+}
+
+void MainWindow::setKillTracePath(const QString &path)
+{
+    m_killTracePath = path;
+    KillTrace::setEnabled(!path.isEmpty());
+}
+
+void MainWindow::setJournalPath(const QString &path)
+{
+    m_journalPath = path;
+}
+
+void MainWindow::exportKillTrace()
+{
+    if (m_killTracePath.isEmpty()) {
+        return;
+    }
+    QString errorString;
+    if (!KillTrace::exportToFile(m_killTracePath, &errorString)) {
+        qWarning() << "分阶段计时导出失败：" << m_killTracePath << errorString;
+    }
+}
+
+// 核心：关闭按钮点击逻辑（检测与关闭在子线程执行，结果通过排队信号返回，界面不再卡顿）
 void MainWindow::on_commandLinkButton_clicked()
 {
-    QString runningClassroom;
-    QString runningProcess;
-
-    // 修正：QMap迭代器调用key()/value()（原错误是用了QStringList）
-    for (auto it = m_classroomProcesses.constBegin(); it != m_classroomProcesses.constEnd(); ++it) {
-        if (isProcessRunning(it.key())) {  // QMap迭代器可以调用key()
-            runningProcess = it.key();
-            runningClassroom = it.value();  // QMap迭代器可以调用value()
-            break;
-        }
+    if (isKillJobRunning()) {
+        QMessageBox::warning(this, "提示", "正在执行进程关闭操作，请等待完成！");
+        return;
     }
 
-    if (!runningClassroom.isEmpty()) {
-        m_clickCount = 0;
-        qDebug() << QString("检测到%1（进程%2），开始关闭").arg(runningClassroom).arg(runningProcess);
-        bool killSuccess = killProcessWithRetry(runningProcess, 3);
+    m_killThread = new KillProcessThread(m_matcher, this);
+    m_killThread->setMode(KillProcessThread::DetectAndKill);
+    m_killThread->setProcessCache(&m_processCache);
+    m_killThread->setTerminatorBackend(ProcessTerminator::Helper);
+    connect(m_killThread, &KillProcessThread::logUpdated, this, [](const QString &log) {
+        qDebug() << log;
+    });
+    connect(m_killThread, &KillProcessThread::detectionFinished, this, &MainWindow::onDetectionFinished);
+    ui->commandLinkButton->setEnabled(false);
+    m_killThread->start();
+}
 
-        if (killSuccess) {
-            QMessageBox::information(this, "操作成功", QString("%1 关闭成功！").arg(runningClassroom));
+// 检测关闭任务完成 → 按原逻辑给出提示
+void MainWindow::onDetectionFinished(const QString &className, const QString &processName, bool found, bool success)
+{
+    if (!m_killThread || sender() != m_killThread) {
+        return;
+    }
+    ui->commandLinkButton->setEnabled(true);
+    m_killThread->wait();  // 信号在 run() 末尾发出，线程即将结束
+    m_killThread->deleteLater();
+    m_killThread = nullptr;
+    exportKillTrace();
+
+    if (found) {
+        m_clickCount = 0;
+        if (success) {
+            QMessageBox::information(this, "操作成功", QString("%1 关闭成功！").arg(className));
         } else {
             QMessageBox::critical(this, "操作失败",
-                                  QString("%1 关闭失败！<br>解决方案：<br>1. 关闭安全软件<br>2. 管理员运行本软件<br>3. 手动结束进程（%2）").arg(runningClassroom).arg(runningProcess));
+                                  QString("%1 关闭失败！<br>解决方案：<br>1. 关闭安全软件<br>2. 管理员运行本软件<br>3. 手动结束进程（%2）").arg(className).arg(processName));
         }
     } else {
         m_clickCount++;
@@ -195,58 +417,35 @@ void MainWindow::on_commandLinkButton_clicked()
     }
 }
 
-// 以下函数保持不变，仅确保编译通过
-void MainWindow::listResourceImages(const QString &path, QStringList &outList)
+void MainWindow::setupWallpaper()
 {
-    QDir dir(path);
-    if (!dir.exists()) {
-        qWarning() << "资源路径不存在：" << path;
-        return;
-    }
+    m_wallpaper = new WallpaperCache(":/wallpaper/", this);
+    connect(m_wallpaper, &WallpaperCache::ready, this, [this]() {
+        applyBackground(Qt::SmoothTransformation);
+        StartupTrace::mark("壁纸就绪");
+    });
+    connect(m_wallpaper, &WallpaperCache::failed, this, [this](const QString &message) {
+        QMessageBox::warning(this, "提示", message);
+    });
 
-    QStringList filters;
-    filters << "*.jpg" << "*.png" << "*.bmp" << "*.jpeg" << "*.gif";
-    dir.setNameFilters(filters);
-    dir.setFilter(QDir::Files | QDir::NoDotAndDotDot);
+    m_wallpaperTimer = new QTimer(this);
+    m_wallpaperTimer->setSingleShot(true);
+    m_wallpaperTimer->setInterval(150);
+    connect(m_wallpaperTimer, &QTimer::timeout, this, [this]() {
+        applyBackground(Qt::SmoothTransformation);
+    });
 
-    QFileInfoList fileList = dir.entryInfoList();
-    for (const QFileInfo &fileInfo : fileList) {
-        outList.append(fileInfo.filePath());
-    }
 }
 
-void MainWindow::setRandomBackground()
+void MainWindow::applyBackground(Qt::TransformationMode mode)
 {
-    QStringList backgroundImages;
-    listResourceImages(":/wallpaper/", backgroundImages);
-
-    if (backgroundImages.isEmpty()) {
-        QMessageBox::warning(this, "提示", "未找到背景图片资源，请检查 :/wallpaper/ 路径");
-        return;
-    }
-
-    int index;
-#if (QT_VERSION >= QT_VERSION_CHECK(5, 10, 0))
-    index = QRandomGenerator::global()->bounded(backgroundImages.size());
-#else
-    qsrand(QTime::currentTime().msec());
-    index = qrand() % backgroundImages.size();
-#endif
-
-    QString selectedImagePath = backgroundImages.at(index);
-
-    QImage backgroundImage(selectedImagePath);
-    if (backgroundImage.isNull()) {
-        QMessageBox::warning(this, "错误", "背景图片加载失败：" + selectedImagePath);
+    const QPixmap background = m_wallpaper->pixmap(this->size(), mode);
+    if (background.isNull()) {
         return;
     }
 
     QPalette palette = this->palette();
-    QBrush brush(backgroundImage.scaled(
-        this->size(),
-        Qt::KeepAspectRatioByExpanding,
-        Qt::SmoothTransformation
-        ));
+    QBrush brush(background);
     brush.setStyle(Qt::TexturePattern);
     palette.setBrush(QPalette::Window, brush);
     this->setPalette(palette);
@@ -260,12 +459,17 @@ void MainWindow::setRandomBackground()
 void MainWindow::resizeEvent(QResizeEvent *event)
 {
     QMainWindow::resizeEvent(event);
-    setRandomBackground();
+    if (!m_wallpaper || !m_wallpaper->isReady()) {
+        return;
+    }
+    // 拖动过程中只做快速缩放，停止调整后再平滑缩放一次
+    applyBackground(Qt::FastTransformation);
+    m_wallpaperTimer->start();
 }
 
 void MainWindow::setupUI()
 {
-    setRandomBackground();
+    setupWallpaper();
 
     QString styleSheet = R"(
         QWidget#centralwidget {
@@ -320,34 +524,3 @@ void MainWindow::on_pushButton_4_clicked()
 {
     QApplication::quit();
 }
-
-bool MainWindow::isProcessRunning(const QString &processName)
-{
-    QProcess tasklist;
-    tasklist.start("tasklist", QStringList() << "/FI" << QString("IMAGENAME eq %1").arg(processName) << "/NH" << "/FO" << "CSV");
-    tasklist.waitForFinished(3000);
-    QString output = tasklist.readAllStandardOutput().toLower();
-
-    QProcess wmic;
-    wmic.start("wmic", QStringList() << "process" << "where" << QString("name='%1'").arg(processName) << "get" << "name");
-    wmic.waitForFinished(3000);
-    QString wmicOutput = wmic.readAllStandardOutput().toLower();
-
-    return output.contains(processName.toLower()) || wmicOutput.contains(processName.toLower());
-}
-
-bool MainWindow::killProcessWithRetry(const QString &processName, int maxRetry)
-{
-    int retryCount = 0;
-    while (retryCount < maxRetry) {
-        if (!isProcessRunning(processName)) {
-            return true;
-        }
-        QProcess taskkill;
-        taskkill.start("taskkill", QStringList() << "/F" << "/T" << "/IM" << processName);
-        taskkill.waitForFinished(2000);
-        retryCount++;
-        QThread::msleep(800);
-    }
-    return !isProcessRunning(processName);
-}
@@ -11,9 +11,15 @@
 #include <QRegularExpression>
 #include <QMap>
 #include <QTimer>
+#include <QSystemTrayIcon>
+#include <QAction>
 #include "versionchecker.h"
 #include "progresswindow.h"
-#include "KillProcessThread.h"  // 引入子线程
+#include "killprocessthread.h"  // 引入子线程
+#include "processwatchdog.h"
+#include "targetcatalog.h"
+#include "wallpapercache.h"
+#include "startuploader.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui {
@@ -29,47 +35,72 @@ public:
     MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
+    // 守护模式：后台常驻，新启动的电子教室进程会被立即关闭
+    void startWatchdog();
+    void stopWatchdog();
+    bool isWatchdogRunning() const;
+    // 启用关闭流程分阶段计时，每次关闭任务结束后导出到 path
+    void setKillTracePath(const QString &path);
+    // 启用持久化日志（在启动后台阶段打开，需在首帧之前设置；为空表示不记录）
+    void setJournalPath(const QString &path);
+
 private slots:
     void onNewVersionAvailable(QString version);
     void onNoUpdatesAvailable();
     void on_pushButton_3_clicked();
     void on_pushButton_4_clicked();
     void on_commandLinkButton_clicked();
-    // 新增：接收子线程的日志/进度/完成信号
-    void onThreadLogUpdated(const QString &log);
-    void onThreadProgressUpdated(int current, int total);
+    // 接收子线程的完成信号（日志/进度经 LogChannel 批量送达进度窗口）
     void onThreadFinished();
+    void onDetectionFinished(const QString &className, const QString &processName, bool found, bool success);
+    // 冻结/解冻完成：提示耗时
+    void onFreezeFinished();
+    void onWatchdogTargetKilled(const QString &className, const QString &processName, qint64 pid);
+    // 启动流水线：首帧显示后再执行的初始化阶段
+    void startDeferredInitialization();
+    void onStartupLoaderFinished();
 
 private:
     Ui::MainWindow *ui;
     ProgressWindow *m_progressWindow;
     KillProcessThread *m_killThread;
     VersionChecker *m_versionChecker;
+    ProcessWatchdog *m_watchdog = nullptr;
+    ProcessTableCache m_processCache;  // 检测任务共享的进程表缓存（重复检测只解析变化的 PID）
+    // 关闭任务与守护模式共享的重新拉起预测（学到的间隔跨任务保留）
+    std::shared_ptr<RespawnPredictor> m_respawnPredictor = std::make_shared<RespawnPredictor>();
+    QSystemTrayIcon *m_trayIcon = nullptr;
+    QAction *m_watchAction = nullptr;
+    WallpaperCache *m_wallpaper = nullptr;  // 背景壁纸（每次会话随机选取一次，缩放结果按尺寸缓存）
+    QTimer *m_wallpaperTimer = nullptr;     // 调整窗口大小结束后再做平滑缩放
     int m_clickCount = 0;  // 点击计数器
     QString m_originalWindowTitle;  // 保存原始窗口标题（用于追加“有限的体验”）
+    QString m_killTracePath;        // 分阶段计时导出路径（为空表示未启用）
+    QString m_journalPath;          // 持久化日志路径（为空表示未启用）
 
-    // 核心修正：统一为QMap类型（进程名 -> 教室软件名称），避免类型冲突
-    const QMap<QString, QString> m_classroomProcesses = {
-        {"StudentMain.exe", "极域电子教室"},
-        {"Student.exe", "红蜘蛛电子教室"},
-        {"RedSpiderStudent.exe", "红蜘蛛电子教室"},
-        {"LanStarStudent.exe", "蓝星电子教室"},
-        {"NetOpStudent.exe", "NetOp电子教室"},
-        {"ClassInStudent.exe", "ClassIn电子教室"},
-        {"SmartClassroomStudent.exe", "智慧教室学生端"},
-        {"e-LearningStudent.exe", "易乐学电子教室"},
-        {"MultimediaClassroom.exe", "多媒体电子教室"}
-    };
+    // 目标目录（启动后台阶段从程序目录的 targets.json 加载，缺失时使用内置列表）
+    TargetCatalog m_catalog;
+    // 由目标目录编译一次，各关闭任务共享（初始化完成前为空目录）
+    std::shared_ptr<const TargetMatcher> m_matcher = std::make_shared<const TargetMatcher>();
+    StartupLoader *m_startupLoader = nullptr;
+    bool m_startupReady = false;     // 后台初始化完成（目标目录、进程缓存可用）
+    bool m_pendingWatchdog = false;  // 初始化完成前请求了守护模式
 
     void setupUI();
-    void setRandomBackground();
-    void listResourceImages(const QString &path, QStringList &outList);
+    void setupTrayIcon();
+    void setupWallpaper();
+    // 按当前窗口大小应用背景（拖动中用快速缩放，停止后用平滑缩放）
+    void applyBackground(Qt::TransformationMode mode);
     void resizeEvent(QResizeEvent *event) override;
 
-    // 进程检测函数（保留）
-    bool isProcessRunning(const QString &processName);
-    bool killProcessWithRetry(const QString &processName, int maxRetry = 3);
+    // 后台任务是否尚未结束（检测关闭、强制执行与冻结/解冻共用一个任务对象）
+    // 以完成槽释放任务对象为准：run() 已返回但完成信号尚在队列中时仍算运行中
+    bool isKillJobRunning() const;
+    // 关闭任务结束后导出分阶段计时（未启用时什么也不做）
+    void exportKillTrace();
     // 强制执行关闭（启动子线程）
     void forceKillAllClassroomProcesses();
+    // 冻结/解冻（mode 为 Freeze 或 Thaw，启动子线程）
+    void startFreezeJob(KillProcessThread::Mode mode);
 };
 #endif // MAINWINDOW_H
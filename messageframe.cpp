@@ -0,0 +1,27 @@
+#include "messageframe.h"
+#include <QtEndian>
+
+QByteArray MessageFrame::wrap(const QByteArray &payload)
+{
+    QByteArray bytes(4, Qt::Uninitialized);
+    qToBigEndian<quint32>(quint32(payload.size()), bytes.data());
+    return bytes + payload;
+}
+
+bool MessageFrame::take(QByteArray &buffer, QByteArray &payload, bool &invalid, quint32 maxSize)
+{
+    if (buffer.size() < 4) {
+        return false;
+    }
+    const quint32 length = qFromBigEndian<quint32>(buffer.constData());
+    if (length > maxSize) {
+        invalid = true;
+        return false;
+    }
+    if (quint32(buffer.size()) - 4 < length) {
+        return false;
+    }
+    payload = buffer.mid(4, length);
+    buffer.remove(0, 4 + length);
+    return true;
+}
@@ -0,0 +1,18 @@
+#ifndef MESSAGEFRAME_H
+#define MESSAGEFRAME_H
+
+#include <QByteArray>
+
+// 流式套接字（本地套接字、TCP）上的消息分帧：quint32 负载长度（大端）+ 负载
+// 特权助手与机房协同模式共用
+class MessageFrame
+{
+public:
+    static constexpr quint32 kDefaultMaxSize = 1 << 20;
+
+    static QByteArray wrap(const QByteArray &payload);
+    // 从缓冲区取出一个完整帧；数据不足返回 false，长度超过 maxSize 时置 invalid（调用方应断开连接）
+    static bool take(QByteArray &buffer, QByteArray &payload, bool &invalid, quint32 maxSize = kDefaultMaxSize);
+};
+
+#endif // MESSAGEFRAME_H
@@ -0,0 +1,530 @@
+#include "processsnapshot.h"
+#include <QFileInfo>
+#include <QSet>
+#include <algorithm>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#include <winternl.h>
+#include <tlhelp32.h>
+#elif defined(Q_OS_LINUX)
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#endif
+
+#if defined(Q_OS_WIN)
+namespace {
+
+// SystemProcessInformation 的记录（winternl.h 中把创建时间与父进程 PID 隐藏在保留字段里，这里按实际布局展开）
+struct SystemProcessRecord
+{
+    ULONG nextEntryOffset;
+    ULONG numberOfThreads;
+    LARGE_INTEGER workingSetPrivateSize;
+    ULONG hardFaultCount;
+    ULONG numberOfThreadsHighWatermark;
+    ULONGLONG cycleTime;
+    LARGE_INTEGER createTime;
+    LARGE_INTEGER userTime;
+    LARGE_INTEGER kernelTime;
+    UNICODE_STRING imageName;
+    LONG basePriority;
+    HANDLE uniqueProcessId;
+    HANDLE inheritedFromUniqueProcessId;
+};
+
+constexpr ULONG kSystemProcessInformation = 5;
+constexpr LONG kStatusInfoLengthMismatch = LONG(0xC0000004);
+
+// 一次系统调用取得整张进程表（含创建时间），失败返回 false
+bool captureNt(QList<ProcessEntry> &entries)
+{
+    using NtQuerySystemInformationFunction = LONG(NTAPI *)(ULONG, PVOID, ULONG, PULONG);
+    static const auto ntQuerySystemInformation = reinterpret_cast<NtQuerySystemInformationFunction>(
+        reinterpret_cast<void *>(GetProcAddress(GetModuleHandleW(L"ntdll.dll"), "NtQuerySystemInformation")));
+    if (!ntQuerySystemInformation) {
+        return false;
+    }
+    QByteArray buffer(256 * 1024, Qt::Uninitialized);
+    LONG status = kStatusInfoLengthMismatch;
+    // 两次调用之间可能又有进程启动，按返回的大小留出余量重试
+    for (int attempt = 0; attempt < 4 && status == kStatusInfoLengthMismatch; ++attempt) {
+        ULONG needed = 0;
+        status = ntQuerySystemInformation(kSystemProcessInformation, buffer.data(), ULONG(buffer.size()), &needed);
+        if (status == kStatusInfoLengthMismatch) {
+            buffer.resize(qMax<qsizetype>(buffer.size() * 2, qsizetype(needed) + 64 * 1024));
+        }
+    }
+    if (status < 0) {
+        return false;
+    }
+    const char *cursor = buffer.constData();
+    for (;;) {
+        const auto *record = reinterpret_cast<const SystemProcessRecord *>(cursor);
+        ProcessEntry entry;
+        entry.pid = qint64(quintptr(record->uniqueProcessId));
+        entry.parentPid = qint64(quintptr(record->inheritedFromUniqueProcessId));
+        entry.startTime = quint64(record->createTime.QuadPart);
+        entry.name = record->imageName.Buffer
+            ? QString::fromWCharArray(record->imageName.Buffer, record->imageName.Length / int(sizeof(wchar_t)))
+            : QStringLiteral("System Idle Process");
+        entries.append(entry);
+        if (record->nextEntryOffset == 0) {
+            break;
+        }
+        cursor += record->nextEntryOffset;
+    }
+    return true;
+}
+
+// 单个进程的创建时间（无权限查询时返回 0）
+quint64 processCreationTime(DWORD pid)
+{
+    HANDLE handle = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid);
+    if (!handle) {
+        return 0;
+    }
+    FILETIME creation;
+    FILETIME exit;
+    FILETIME kernel;
+    FILETIME user;
+    quint64 startTime = 0;
+    if (GetProcessTimes(handle, &creation, &exit, &kernel, &user)) {
+        startTime = (quint64(creation.dwHighDateTime) << 32) | creation.dwLowDateTime;
+    }
+    CloseHandle(handle);
+    return startTime;
+}
+
+} // namespace
+#endif
+
+#if defined(Q_OS_LINUX)
+namespace {
+
+// 内核 comm 字段最多保留 15 个字节（TASK_COMM_LEN - 1）
+constexpr int kCommMaxLength = 15;
+
+// 读取 /proc 下的小文件（直接系统调用，避免 QFile 的额外开销），返回读取字节数，失败返回 -1
+ssize_t readSmallFile(const char *path, char *buffer, size_t size)
+{
+    int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    ssize_t length = ::read(fd, buffer, size - 1);
+    ::close(fd);
+    if (length >= 0) {
+        buffer[length] = '\0';
+    }
+    return length;
+}
+
+bool isPidDirectory(const char *name)
+{
+    if (!*name) {
+        return false;
+    }
+    for (const char *c = name; *c; ++c) {
+        if (*c < '0' || *c > '9') {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 解析 /proc/<pid>/stat："pid (comm) state ppid ... starttime ..."
+// entry.name 为 comm（可能被截断），commLength 返回其字节数
+bool readProcStat(const char *pidDirectory, ProcessEntry &entry, int &commLength)
+{
+    char path[64];
+    char buffer[1024];
+    std::snprintf(path, sizeof(path), "/proc/%s/stat", pidDirectory);
+    if (readSmallFile(path, buffer, sizeof(buffer)) <= 0) {
+        return false;  // 进程在枚举过程中退出
+    }
+
+    // comm 中可能包含空格或括号，以最后一个 ')' 为界
+    char *commBegin = std::strchr(buffer, '(');
+    char *commEnd = std::strrchr(buffer, ')');
+    if (!commBegin || !commEnd || commEnd < commBegin) {
+        return false;
+    }
+    entry.pid = std::strtoll(buffer, nullptr, 10);
+    commLength = int(commEnd - commBegin - 1);
+    entry.name = QString::fromUtf8(commBegin + 1, commLength);
+
+    // 从第3列（state）开始计数
+    int field = 3;
+    char *saveptr = nullptr;
+    for (char *token = strtok_r(commEnd + 1, " ", &saveptr); token; token = strtok_r(nullptr, " ", &saveptr), ++field) {
+        if (field == 4) {
+            entry.parentPid = std::strtoll(token, nullptr, 10);
+        } else if (field == 22) {
+            entry.startTime = std::strtoull(token, nullptr, 10);
+            break;
+        }
+    }
+    return true;
+}
+
+bool readProcEntry(const char *pidDirectory, ProcessEntry &entry)
+{
+    int commLength = 0;
+    if (!readProcStat(pidDirectory, entry, commLength)) {
+        return false;
+    }
+    // comm 被截断时，从 argv[0] 还原完整映像名（Wine 进程形如 C:\...\StudentMain.exe）
+    if (commLength >= kCommMaxLength) {
+        const QString comm = entry.name;
+        char path[64];
+        char buffer[1024];
+        std::snprintf(path, sizeof(path), "/proc/%s/cmdline", pidDirectory);
+        if (readSmallFile(path, buffer, sizeof(buffer)) > 0) {
+            const char *baseName = buffer;
+            for (const char *c = buffer; *c; ++c) {
+                if (*c == '/' || *c == '\\') {
+                    baseName = c + 1;
+                }
+            }
+            const QString fullName = QString::fromUtf8(baseName);
+            if (fullName.startsWith(comm)) {
+                entry.name = fullName;
+            }
+        }
+    }
+    return true;
+}
+
+// 重读 stat 核对已缓存的进程：comm 或启动时间不同即映像已改变（exec、改名）
+bool imageChanged(const char *pidDirectory, const ProcessEntry &cached)
+{
+    ProcessEntry fresh;
+    int commLength = 0;
+    if (!readProcStat(pidDirectory, fresh, commLength)) {
+        return false;  // 已退出：由下一次目录读取剔除
+    }
+    // comm 被截断时缓存中是由 argv[0] 还原的完整映像名，只比较前缀
+    const bool sameName = commLength >= kCommMaxLength ? cached.name.startsWith(fresh.name) : cached.name == fresh.name;
+    return !sameName || fresh.startTime != cached.startTime;
+}
+
+} // namespace
+#endif
+
+ProcessSnapshot ProcessSnapshot::capture()
+{
+    ProcessSnapshot snapshot;
+
+#if defined(Q_OS_WIN)
+    QList<ProcessEntry> entries;
+    if (captureNt(entries)) {
+        for (const ProcessEntry &entry : entries) {
+            snapshot.insert(entry);
+        }
+        return snapshot;
+    }
+    HANDLE handle = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
+    if (handle != INVALID_HANDLE_VALUE) {
+        PROCESSENTRY32W processEntry;
+        processEntry.dwSize = sizeof(processEntry);
+        if (Process32FirstW(handle, &processEntry)) {
+            do {
+                ProcessEntry entry;
+                entry.pid = processEntry.th32ProcessID;
+                entry.parentPid = processEntry.th32ParentProcessID;
+                entry.name = QString::fromWCharArray(processEntry.szExeFile);
+                entry.startTime = processCreationTime(processEntry.th32ProcessID);
+                snapshot.insert(entry);
+            } while (Process32NextW(handle, &processEntry));
+        }
+        CloseHandle(handle);
+    }
+#elif defined(Q_OS_LINUX)
+    if (DIR *directory = opendir("/proc")) {
+        while (dirent *directoryEntry = readdir(directory)) {
+            if (!isPidDirectory(directoryEntry->d_name)) {
+                continue;
+            }
+            ProcessEntry entry;
+            if (readProcEntry(directoryEntry->d_name, entry)) {
+                snapshot.insert(entry);
+            }
+        }
+        closedir(directory);
+    }
+#endif
+
+    return snapshot;
+}
+
+bool ProcessSnapshot::readProcess(qint64 pid, ProcessEntry &entry)
+{
+#if defined(Q_OS_LINUX)
+    char pidDirectory[24];
+    std::snprintf(pidDirectory, sizeof(pidDirectory), "%lld", static_cast<long long>(pid));
+    return readProcEntry(pidDirectory, entry);
+#else
+    Q_UNUSED(pid);
+    Q_UNUSED(entry);
+    return false;
+#endif
+}
+
+QString ProcessSnapshot::executablePath(qint64 pid)
+{
+#if defined(Q_OS_WIN)
+    HANDLE handle = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, DWORD(pid));
+    if (!handle) {
+        return QString();
+    }
+    wchar_t buffer[MAX_PATH * 2];
+    DWORD size = DWORD(sizeof(buffer) / sizeof(buffer[0]));
+    QString path;
+    if (QueryFullProcessImageNameW(handle, 0, buffer, &size)) {
+        path = QString::fromWCharArray(buffer, int(size));
+    }
+    CloseHandle(handle);
+    return path;
+#elif defined(Q_OS_LINUX)
+    return QFileInfo(QString("/proc/%1/exe").arg(pid)).symLinkTarget();
+#else
+    Q_UNUSED(pid);
+    return QString();
+#endif
+}
+
+const ProcessEntry *ProcessSnapshot::process(qint64 pid) const
+{
+    const auto it = m_processes.constFind(pid);
+    return it == m_processes.constEnd() ? nullptr : &it.value();
+}
+
+QString ProcessSnapshot::foldName(const QString &processName)
+{
+    return processName.toCaseFolded();
+}
+
+bool ProcessSnapshot::contains(const QString &processName) const
+{
+    return m_nameIndex.contains(foldName(processName));
+}
+
+QList<ProcessEntry> ProcessSnapshot::find(const QString &processName) const
+{
+    QList<ProcessEntry> result;
+    const auto it = m_nameIndex.constFind(foldName(processName));
+    if (it != m_nameIndex.constEnd()) {
+        for (qint64 pid : it.value()) {
+            result.append(m_processes.value(pid));
+        }
+    }
+    return result;
+}
+
+const ProcessEntry *ProcessSnapshot::parentOf(const ProcessEntry &process) const
+{
+    const ProcessEntry *parent = process.parentPid == process.pid ? nullptr : this->process(process.parentPid);
+    // 子进程不可能早于父进程启动：排除 PPID 过期（原父进程已退出、PID 被复用）造成的误判
+    if (!parent || parent->startTime == 0 || process.startTime == 0 || parent->startTime > process.startTime) {
+        return nullptr;
+    }
+    return parent;
+}
+
+QList<ProcessEntry> ProcessSnapshot::subtree(qint64 root, TreeOrder order) const
+{
+    QList<ProcessEntry> result;
+    const ProcessEntry *rootEntry = process(root);
+    if (!rootEntry) {
+        return result;
+    }
+
+    // 深度优先前序遍历：父进程总在其所有后代之前；反转后即为子先于父
+    QSet<qint64> visited;
+    QList<const ProcessEntry *> stack;
+    stack.append(rootEntry);
+    while (!stack.isEmpty()) {
+        const ProcessEntry *current = stack.takeLast();
+        if (visited.contains(current->pid)) {
+            continue;
+        }
+        visited.insert(current->pid);
+        result.append(*current);
+
+        const auto childrenIt = m_children.constFind(current->pid);
+        if (childrenIt == m_children.constEnd()) {
+            continue;
+        }
+        for (qint64 childPid : childrenIt.value()) {
+            const ProcessEntry *child = process(childPid);
+            if (!child || parentOf(*child) != current) {
+                continue;
+            }
+            stack.append(child);
+        }
+    }
+
+    if (order == BottomUp) {
+        std::reverse(result.begin(), result.end());
+    }
+    return result;
+}
+
+void ProcessSnapshot::insert(const ProcessEntry &entry)
+{
+    remove(entry.pid);
+    m_processes.insert(entry.pid, entry);
+    m_nameIndex[foldName(entry.name)].append(entry.pid);
+    if (entry.parentPid != entry.pid) {
+        m_children[entry.parentPid].append(entry.pid);
+    }
+}
+
+void ProcessSnapshot::remove(qint64 pid)
+{
+    const auto it = m_processes.constFind(pid);
+    if (it == m_processes.constEnd()) {
+        return;
+    }
+    const QString key = foldName(it->name);
+    const qint64 parentPid = it->parentPid;
+    m_processes.erase(it);
+
+    auto childrenIt = m_children.find(parentPid);
+    if (childrenIt != m_children.end()) {
+        childrenIt->removeOne(pid);
+        if (childrenIt->isEmpty()) {
+            m_children.erase(childrenIt);
+        }
+    }
+
+    auto indexIt = m_nameIndex.find(key);
+    if (indexIt != m_nameIndex.end()) {
+        indexIt->removeOne(pid);
+        if (indexIt->isEmpty()) {
+            m_nameIndex.erase(indexIt);
+        }
+    }
+}
+
+ProcessSnapshot ProcessTableCache::refresh(QList<ProcessEntry> *added, QList<ProcessEntry> *removed)
+{
+    QHash<qint64, quint64> current;
+    current.reserve(m_generations.size() + 16);
+    m_parsed = 0;
+    if (!m_clock.isValid()) {
+        m_clock.start();
+    }
+    const qint64 now = m_clock.elapsed();
+    // 首次刷新看到的是早已在运行的进程，不必逐次复核
+    const bool initial = m_generations.isEmpty();
+
+    // 新出现、PID 被复用或映像已改变（exec、改名）的进程才需要解析
+    auto admit = [&](qint64 pid, quint64 generation, const ProcessEntry *known, bool changed) {
+        current.insert(pid, generation);
+        const auto it = m_generations.constFind(pid);
+        if (it != m_generations.constEnd() && it.value() == generation && !changed) {
+            return;
+        }
+        if (it != m_generations.constEnd() && removed) {
+            removed->append(m_snapshot.m_processes.value(pid));  // 旧映像按消失处理，新映像按新出现处理
+        }
+
+        ProcessEntry entry;
+        if (known) {
+            entry = *known;
+        } else if (!ProcessSnapshot::readProcess(pid, entry)) {
+            current.remove(pid);
+            m_snapshot.remove(pid);
+            return;
+        } else {
+            ++m_parsed;
+            if (!initial) {
+                m_young.insert(pid, now);
+            }
+        }
+        m_snapshot.insert(entry);
+        if (added) {
+            added->append(entry);
+        }
+    };
+
+#if defined(Q_OS_LINUX)
+    // 只读取 /proc 目录项（inode 作为代次标记），新出现或 PID 被复用的进程才读取 stat
+    // exec 或改名不改变 inode：刚出现的进程（Wine 在加载 .exe 后才改名）每次刷新复核 stat，
+    // 其余已知进程只按 m_revalidateIntervalMs 的慢节奏复核，稳态开销只是一次目录读取
+    const bool revalidateAll = m_lastRevalidation < 0 || now - m_lastRevalidation >= m_revalidateIntervalMs;
+    if (revalidateAll) {
+        m_lastRevalidation = now;
+    }
+    if (DIR *directory = opendir("/proc")) {
+        while (dirent *directoryEntry = readdir(directory)) {
+            if (!isPidDirectory(directoryEntry->d_name)) {
+                continue;
+            }
+            const qint64 pid = std::strtoll(directoryEntry->d_name, nullptr, 10);
+            const quint64 generation = quint64(directoryEntry->d_ino);
+            bool changed = false;
+            const auto knownIt = m_generations.constFind(pid);
+            if (knownIt != m_generations.constEnd() && knownIt.value() == generation
+                && (revalidateAll || m_young.contains(pid))) {
+                if (const ProcessEntry *cached = m_snapshot.process(pid)) {
+                    ++m_parsed;
+                    changed = imageChanged(directoryEntry->d_name, *cached);
+                }
+            }
+            admit(pid, generation, nullptr, changed);
+        }
+        closedir(directory);
+    }
+#else
+    // Windows 的快照本身已带映像名，增量部分在于索引维护与新增进程的识别
+    const ProcessSnapshot full = ProcessSnapshot::capture();
+    for (auto it = full.m_processes.constBegin(); it != full.m_processes.constEnd(); ++it) {
+        const ProcessEntry *cached = nullptr;
+        const auto cachedIt = m_snapshot.m_processes.constFind(it.key());
+        if (cachedIt != m_snapshot.m_processes.constEnd()) {
+            cached = &cachedIt.value();
+        }
+        // 父进程、映像名或创建时间（取自本次快照）变化视为 PID 被复用
+        const bool changed = cached && (cached->parentPid != it->parentPid || cached->name != it->name || cached->startTime != it->startTime);
+        admit(it.key(), m_generations.value(it.key()), &it.value(), !cached || changed);
+    }
+#endif
+
+    // 已消失的 PID
+    for (auto it = m_generations.constBegin(); it != m_generations.constEnd(); ++it) {
+        if (!current.contains(it.key())) {
+            if (removed) {
+                removed->append(m_snapshot.m_processes.value(it.key()));
+            }
+            m_snapshot.remove(it.key());
+        }
+    }
+
+    // 过了复核期或已消失的进程不再逐次复核（集合大小与进程变化量成正比）
+    m_young.removeIf([&](const QHash<qint64, qint64>::iterator it) {
+        return now - it.value() >= kYoungProcessMs || !current.contains(it.key());
+    });
+
+    m_generations.swap(current);
+    return m_snapshot;
+}
+
+void ProcessTableCache::setRevalidateInterval(int msecs)
+{
+    m_revalidateIntervalMs = qMax(0, msecs);
+}
+
+void ProcessTableCache::clear()
+{
+    m_snapshot = ProcessSnapshot();
+    m_generations.clear();
+    m_young.clear();
+    m_lastRevalidation = -1;
+}
@@ -0,0 +1,107 @@
+#ifndef PROCESSSNAPSHOT_H
+#define PROCESSSNAPSHOT_H
+
+#include <QString>
+#include <QList>
+#include <QHash>
+#include <QElapsedTimer>
+
+// 进程表中的一项（快照内只读）
+struct ProcessEntry
+{
+    qint64 pid = 0;
+    qint64 parentPid = 0;
+    quint64 startTime = 0;   // 进程启动时间（Linux：/proc/<pid>/stat 第22列，单位 jiffies；Windows：创建时间，FILETIME 100 纳秒），0 表示未知
+    QString name;            // 映像名，如 StudentMain.exe
+};
+
+// 进程快照：一次性枚举系统进程表，之后的所有名称查询都在内存中完成
+// Linux 直接读取 /proc，Windows 使用 NtQuerySystemInformation（一次调用同时得到创建时间，失败时退回 CreateToolhelp32Snapshot），
+// 全程不启动子进程
+class ProcessSnapshot
+{
+public:
+    // 进程树遍历顺序
+    enum TreeOrder {
+        TopDown,   // 父进程先于子进程（先终止父进程，避免其重新拉起子进程）
+        BottomUp   // 子进程先于父进程
+    };
+
+    ProcessSnapshot() = default;
+
+    // 枚举当前进程表（一次系统调用批次）
+    static ProcessSnapshot capture();
+    // 读取单个进程的当前信息（仅 Linux 支持，进程不存在时返回 false）
+    static bool readProcess(qint64 pid, ProcessEntry &entry);
+    // 进程可执行文件的完整路径（无权限或进程已退出时返回空）
+    static QString executablePath(qint64 pid);
+
+    QList<ProcessEntry> entries() const { return m_processes.values(); }
+    int size() const { return int(m_processes.size()); }
+    bool isEmpty() const { return m_processes.isEmpty(); }
+    // 按 PID 查找，不存在时返回 nullptr（指针在快照被修改前有效）
+    const ProcessEntry *process(qint64 pid) const;
+    // 直接子进程（来自父→子邻接索引，未核对启动时间）
+    QList<qint64> children(qint64 pid) const { return m_children.value(pid); }
+    // 父进程：只有 PPID 对应的进程确实不晚于该进程启动时才返回（Windows 的 PPID 在父进程退出后不会更新，PID 可能已被复用），
+    // 任一方启动时间未知、无法核实时返回 nullptr
+    const ProcessEntry *parentOf(const ProcessEntry &process) const;
+    // 以 root 为根的整棵子树（含 root），按指定顺序排列；开销与子树大小成正比
+    // 只沿 parentOf() 核实过的父子关系展开，无法核实启动时间的子进程不计入
+    QList<ProcessEntry> subtree(qint64 root, TreeOrder order = TopDown) const;
+
+    // 按映像名查询（大小写不敏感，走哈希索引）
+    bool contains(const QString &processName) const;
+    QList<ProcessEntry> find(const QString &processName) const;
+
+    // 统一的名称归一化规则（大小写折叠），索引与查询共用
+    static QString foldName(const QString &processName);
+
+private:
+    friend class ProcessTableCache;
+
+    QHash<qint64, ProcessEntry> m_processes;         // PID -> 进程
+    QHash<QString, QList<qint64>> m_nameIndex;       // 折叠后的映像名 -> PID 列表
+    QHash<qint64, QList<qint64>> m_children;         // 父 PID -> 子 PID 列表
+
+    void insert(const ProcessEntry &entry);
+    void remove(qint64 pid);
+};
+
+// 持久化的进程表缓存（PID -> 启动时间、映像名）
+// 刷新时只解析新出现（或 PID 被复用）的进程、剔除已消失的 PID，开销与进程变化量成正比，而不是与进程总数成正比
+// Linux 上 exec 或改名不改变 /proc/<pid> 的 inode：刚出现的进程在 kYoungProcessMs 内每次刷新重读 stat 核对，
+// 其余已知进程按复核间隔慢节奏核对（需要即时发现改名时使用进程连接器的 exec/comm 事件）；Windows 直接比较本次快照中的映像名
+// 非线程安全：每个使用方（界面线程、关闭线程、守护线程）各自持有一份
+class ProcessTableCache
+{
+public:
+    static constexpr int kDefaultRevalidateIntervalMs = 5000;
+
+    // 增量刷新并返回最新快照（隐式共享，返回开销很小）
+    // added/removed 可选，返回本次新出现/消失的进程
+    ProcessSnapshot refresh(QList<ProcessEntry> *added = nullptr, QList<ProcessEntry> *removed = nullptr);
+    const ProcessSnapshot &snapshot() const { return m_snapshot; }
+    void clear();
+
+    // 已知进程全量复核 stat 的间隔（仅 Linux；0 表示每次刷新都复核）
+    void setRevalidateInterval(int msecs);
+    // 上次刷新读取 stat 的进程数（新进程的解析与已知进程的复核，基准测试与单元测试用）
+    int lastParsed() const { return m_parsed; }
+
+private:
+    // 新出现的进程逐次复核的时长
+    static constexpr qint64 kYoungProcessMs = 1000;
+
+    ProcessSnapshot m_snapshot;
+    // PID -> 代次标记（Linux 为 /proc/<pid> 目录项的 inode，PID 被复用时会变化）
+    QHash<qint64, quint64> m_generations;
+    // PID -> 首次解析的时刻（m_clock 毫秒），只保留复核期内的进程
+    QHash<qint64, qint64> m_young;
+    QElapsedTimer m_clock;
+    qint64 m_lastRevalidation = -1;
+    int m_revalidateIntervalMs = kDefaultRevalidateIntervalMs;
+    int m_parsed = 0;
+};
+
+#endif // PROCESSSNAPSHOT_H
@@ -0,0 +1,266 @@
+#include "processterminator.h"
+#include "elevatedhelper.h"
+#include <QDeadlineTimer>
+#include <QProcess>
+#include <QStringList>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#else
+#include <cerrno>
+#include <csignal>
+#include <sys/types.h>
+#include <unistd.h>
+#if defined(Q_OS_LINUX)
+#include <sys/syscall.h>
+#endif
+#endif
+
+namespace {
+
+// Shell 后端等待外部命令时检查取消的间隔
+constexpr int kShellWaitSliceMs = 20;
+// 特权助手单次请求的往返上限
+constexpr int kHelperRequestTimeoutMs = 2000;
+
+#if defined(Q_OS_WIN)
+// 未公开但自 XP 起稳定存在的 ntdll 接口：一次调用挂起/恢复进程内的全部线程
+using NtProcessFunction = LONG(NTAPI *)(HANDLE);
+
+NtProcessFunction ntdllFunction(const char *name)
+{
+    return reinterpret_cast<NtProcessFunction>(reinterpret_cast<void *>(GetProcAddress(GetModuleHandleW(L"ntdll.dll"), name)));
+}
+
+// 打开快照中的进程；PID 已不存在或已被复用（创建时间与快照不符）时返回 nullptr 并按"进程不存在"填写 result，
+// 与 Linux 的 pidfd 路径一致：句柄固定了进程，核对之后不会再被复用
+HANDLE openProcess(DWORD access, const ProcessEntry &process, KillResult &result)
+{
+    HANDLE handle = OpenProcess(access | PROCESS_QUERY_LIMITED_INFORMATION, FALSE, DWORD(process.pid));
+    if (!handle) {
+        result.errorCode = int(GetLastError());
+        // PID 已不存在：目标已经退出
+        result.success = (result.errorCode == ERROR_INVALID_PARAMETER);
+        return nullptr;
+    }
+    FILETIME creation;
+    FILETIME exit;
+    FILETIME kernel;
+    FILETIME user;
+    if (process.startTime != 0 && GetProcessTimes(handle, &creation, &exit, &kernel, &user)
+        && ((quint64(creation.dwHighDateTime) << 32) | creation.dwLowDateTime) != process.startTime) {
+        CloseHandle(handle);
+        result.errorCode = ERROR_INVALID_PARAMETER;
+        result.success = true;
+        return nullptr;
+    }
+    return handle;
+}
+
+KillResult callNtProcessFunction(NtProcessFunction function, const ProcessEntry &process)
+{
+    using RtlNtStatusToDosErrorFunction = ULONG(NTAPI *)(LONG);
+    static const auto rtlNtStatusToDosError = reinterpret_cast<RtlNtStatusToDosErrorFunction>(
+        reinterpret_cast<void *>(GetProcAddress(GetModuleHandleW(L"ntdll.dll"), "RtlNtStatusToDosError")));
+
+    KillResult result;
+    result.pid = process.pid;
+    if (!function) {
+        result.errorCode = ERROR_PROC_NOT_FOUND;
+        return result;
+    }
+    HANDLE handle = openProcess(PROCESS_SUSPEND_RESUME, process, result);
+    if (!handle) {
+        return result;
+    }
+    const LONG status = function(handle);
+    result.exitStatus = int(status);
+    result.success = status >= 0;
+    result.errorCode = result.success ? 0 : int(rtlNtStatusToDosError ? rtlNtStatusToDosError(status) : ERROR_GEN_FAILURE);
+    CloseHandle(handle);
+    return result;
+}
+#else
+// 向快照中的进程发送信号；ESRCH（目标在快照之后已经退出）视为成功
+KillResult sendSignal(const ProcessEntry &process, int signal)
+{
+    KillResult result;
+    result.pid = process.pid;
+#if defined(Q_OS_LINUX) && defined(SYS_pidfd_open) && defined(SYS_pidfd_send_signal)
+    const int pidfd = int(::syscall(SYS_pidfd_open, pid_t(process.pid), 0));
+    if (pidfd >= 0) {
+        // pidfd 已固定目标进程，再核对启动时间，防止快照之后 PID 被复用
+        ProcessEntry current;
+        if (process.startTime != 0
+            && (!ProcessSnapshot::readProcess(process.pid, current) || current.startTime != process.startTime)) {
+            ::close(pidfd);
+            result.errorCode = ESRCH;
+            result.success = true;
+            return result;
+        }
+        result.exitStatus = int(::syscall(SYS_pidfd_send_signal, pidfd, signal, nullptr, 0));
+        result.errorCode = result.exitStatus == 0 ? 0 : errno;
+        result.success = result.exitStatus == 0 || result.errorCode == ESRCH;
+        ::close(pidfd);
+        return result;
+    }
+    if (errno == ESRCH) {
+        result.errorCode = ESRCH;
+        result.success = true;
+        return result;
+    }
+    // 内核不支持 pidfd（Linux < 5.3）时退回 kill(2)
+#endif
+    result.exitStatus = ::kill(pid_t(process.pid), signal);
+    result.errorCode = result.exitStatus == 0 ? 0 : errno;
+    result.success = result.exitStatus == 0 || result.errorCode == ESRCH;
+    return result;
+}
+#endif
+
+} // namespace
+
+QString KillResult::errorString() const
+{
+    return errorCode == 0 ? QString() : qt_error_string(errorCode);
+}
+
+std::unique_ptr<ProcessTerminator> ProcessTerminator::create(Backend backend)
+{
+    if (backend == Shell) {
+        return std::make_unique<ShellProcessTerminator>();
+    }
+    if (backend == Helper) {
+        return std::make_unique<HelperProcessTerminator>();
+    }
+    return std::make_unique<NativeProcessTerminator>();
+}
+
+QList<KillResult> ProcessTerminator::terminateAll(const QList<ProcessEntry> &processes)
+{
+    QList<KillResult> results;
+    results.reserve(processes.size());
+    for (const ProcessEntry &process : processes) {
+        results.append(terminate(process));
+    }
+    return results;
+}
+
+KillResult NativeProcessTerminator::terminate(const ProcessEntry &process)
+{
+    KillResult result;
+    result.pid = process.pid;
+
+#if defined(Q_OS_WIN)
+    HANDLE handle = openProcess(PROCESS_TERMINATE, process, result);
+    if (!handle) {
+        return result;
+    }
+    const BOOL terminated = TerminateProcess(handle, 1);
+    result.exitStatus = terminated ? 0 : -1;
+    result.errorCode = terminated ? 0 : int(GetLastError());
+    result.success = terminated;
+    CloseHandle(handle);
+#else
+    result = sendSignal(process, SIGKILL);
+#endif
+    return result;
+}
+
+KillResult ProcessTerminator::suspend(const ProcessEntry &process)
+{
+#if defined(Q_OS_WIN)
+    static const NtProcessFunction ntSuspendProcess = ntdllFunction("NtSuspendProcess");
+    return callNtProcessFunction(ntSuspendProcess, process);
+#else
+    return sendSignal(process, SIGSTOP);
+#endif
+}
+
+KillResult ProcessTerminator::resume(const ProcessEntry &process)
+{
+#if defined(Q_OS_WIN)
+    static const NtProcessFunction ntResumeProcess = ntdllFunction("NtResumeProcess");
+    return callNtProcessFunction(ntResumeProcess, process);
+#else
+    return sendSignal(process, SIGCONT);
+#endif
+}
+
+QList<KillResult> ProcessTerminator::suspendAll(const QList<ProcessEntry> &processes)
+{
+    QList<KillResult> results;
+    results.reserve(processes.size());
+    for (const ProcessEntry &process : processes) {
+        results.append(suspend(process));
+    }
+    return results;
+}
+
+QList<KillResult> ProcessTerminator::resumeAll(const QList<ProcessEntry> &processes)
+{
+    QList<KillResult> results;
+    results.reserve(processes.size());
+    for (const ProcessEntry &process : processes) {
+        results.append(resume(process));
+    }
+    return results;
+}
+
+KillResult ShellProcessTerminator::terminate(const ProcessEntry &process)
+{
+    KillResult result;
+    result.pid = process.pid;
+    const QString pid = QString::number(process.pid);
+
+    // 方式1：常规taskkill（按 PID，连同子进程）
+    QProcess taskkill;
+    if (runAndWait(taskkill, "taskkill", QStringList() << "/F" << "/T" << "/PID" << pid, 2000)) {
+        result.exitStatus = taskkill.exitCode();
+        if (result.exitStatus == 0) {
+            result.success = true;
+            return result;
+        }
+    }
+
+    // 方式2：wmic强制终止
+    QProcess wmicKill;
+    if (runAndWait(wmicKill, "wmic", QStringList() << "process" << "where" << QString("processid=%1").arg(pid) << "delete", 2000)) {
+        result.exitStatus = wmicKill.exitCode();
+        if (result.exitStatus == 0) {
+            result.success = true;
+            return result;
+        }
+    }
+
+    // 方式3：转交常驻的特权助手（整个会话只提权启动一次）
+    QString errorString;
+    const QList<KillResult> elevated = ElevatedHelper::request(ElevatedHelper::Terminate, QList<ProcessEntry>{process},
+                                                               kHelperRequestTimeoutMs, m_cancellation, &errorString);
+    if (elevated.isEmpty()) {
+        log(QString("特权助手请求失败：%1").arg(errorString));
+        return result;
+    }
+    return elevated.first();
+}
+
+bool ShellProcessTerminator::runAndWait(QProcess &process, const QString &program, const QStringList &arguments, int timeoutMs)
+{
+    if (m_cancellation.isCancelled()) {
+        return false;
+    }
+    process.start(program, arguments);
+    const QDeadlineTimer deadline(timeoutMs);
+    // 分片等待，每片之间检查取消
+    while (!process.waitForFinished(kShellWaitSliceMs)) {
+        if (process.state() == QProcess::NotRunning) {
+            return false;  // 启动失败
+        }
+        if (m_cancellation.isCancelled() || deadline.hasExpired()) {
+            process.kill();
+            process.waitForFinished(kShellWaitSliceMs);
+            return false;
+        }
+    }
+    return process.exitStatus() == QProcess::NormalExit;
+}
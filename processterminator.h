@@ -0,0 +1,93 @@
+#ifndef PROCESSTERMINATOR_H
+#define PROCESSTERMINATOR_H
+
+#include <QString>
+#include <QStringList>
+#include <functional>
+#include <memory>
+#include "processsnapshot.h"
+#include "cancellationtoken.h"
+
+class QProcess;
+
+// 单次终止操作的结构化结果（不再依赖解析本地化的命令输出）
+struct KillResult
+{
+    qint64 pid = 0;
+    bool success = false;
+    int exitStatus = -1;   // 原生后端：系统调用返回值；Shell 后端：命令退出码
+    int errorCode = 0;     // Linux 为 errno，Windows 为 GetLastError()
+    bool exited = false;   // 是否已确认进程退出（由调用方等待确认后填写）
+
+    QString errorString() const;
+};
+
+// 进程终止后端接口：按快照中的 PID 结束进程
+class ProcessTerminator
+{
+public:
+    enum Backend {
+        Native,  // 进程内系统调用（默认）
+        Shell,   // taskkill/wmic/PowerShell，仅作为显式指定的兜底方案
+        Helper   // 进程内系统调用，权限不足的进程整批转交常驻的特权助手（见 ElevatedHelper）
+    };
+
+    virtual ~ProcessTerminator() = default;
+
+    virtual QString backendName() const = 0;
+    virtual KillResult terminate(const ProcessEntry &process) = 0;
+    // 批量终止，结果与 processes 一一对应（默认逐个调用 terminate()）
+    virtual QList<KillResult> terminateAll(const QList<ProcessEntry> &processes);
+    // 挂起进程（守护进程、冻结模式）：Linux 发送 SIGSTOP，Windows 调用 NtSuspendProcess；恢复对应 SIGCONT/NtResumeProcess
+    // 默认为原生实现；进程已不存在时视为成功
+    // Windows 的挂起计数可以叠加：挂起几次就需要恢复几次
+    virtual KillResult suspend(const ProcessEntry &process);
+    virtual KillResult resume(const ProcessEntry &process);
+    // 批量挂起/恢复，结果与 processes 一一对应（默认逐个调用）
+    virtual QList<KillResult> suspendAll(const QList<ProcessEntry> &processes);
+    virtual QList<KillResult> resumeAll(const QList<ProcessEntry> &processes);
+
+    static std::unique_ptr<ProcessTerminator> create(Backend backend = Native);
+
+    // 取消后不再启动新的外部命令，正在等待的外部命令被立即终止（需在任务开始前设置）
+    void setCancellationToken(const CancellationToken &token) { m_cancellation = token; }
+
+    // 诊断日志出口（如特权助手不可用的原因；需在任务开始前设置，会在多个工作线程中并发调用）
+    using LogHandler = std::function<void(const QString &log)>;
+    void setLogHandler(const LogHandler &handler) { m_logHandler = handler; }
+
+protected:
+    CancellationToken m_cancellation;
+
+    void log(const QString &message) const
+    {
+        if (m_logHandler) {
+            m_logHandler(message);
+        }
+    }
+
+private:
+    LogHandler m_logHandler;
+};
+
+// 原生后端：Linux 使用 pidfd_send_signal/kill(2)，Windows 使用 OpenProcess/TerminateProcess
+class NativeProcessTerminator : public ProcessTerminator
+{
+public:
+    QString backendName() const override { return QStringLiteral("native"); }
+    KillResult terminate(const ProcessEntry &process) override;
+};
+
+// Shell 后端：保留原有的 taskkill → wmic 流程，两者都失败时转交特权助手（不再每次启动管理员 PowerShell）
+class ShellProcessTerminator : public ProcessTerminator
+{
+public:
+    QString backendName() const override { return QStringLiteral("shell"); }
+    KillResult terminate(const ProcessEntry &process) override;
+
+private:
+    // 启动外部命令并等待结束；超时或被取消时终止该命令，不留下后台进程
+    bool runAndWait(QProcess &process, const QString &program, const QStringList &arguments, int timeoutMs);
+};
+
+#endif // PROCESSTERMINATOR_H
@@ -0,0 +1,168 @@
+#include "processwaiter.h"
+#include <QThread>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#else
+#include <cerrno>
+#include <csignal>
+#include <poll.h>
+#include <sys/types.h>
+#include <unistd.h>
+#if defined(Q_OS_LINUX)
+#include <sys/syscall.h>
+#endif
+#endif
+
+namespace {
+
+// 内核不支持 pidfd 时的退化轮询间隔
+constexpr int kFallbackPollIntervalMs = 10;
+
+#if !defined(Q_OS_WIN)
+// 进程是否仍是快照中的那一个（PID 被复用视为已退出）
+bool isAlive(const ProcessEntry &process)
+{
+#if defined(Q_OS_LINUX)
+    ProcessEntry current;
+    return ProcessSnapshot::readProcess(process.pid, current)
+           && (process.startTime == 0 || current.startTime == process.startTime);
+#else
+    return ::kill(pid_t(process.pid), 0) == 0 || errno == EPERM;
+#endif
+}
+
+int openPidfd(qint64 pid)
+{
+#if defined(Q_OS_LINUX) && defined(SYS_pidfd_open)
+    return int(::syscall(SYS_pidfd_open, pid_t(pid), 0));
+#else
+    Q_UNUSED(pid);
+    errno = ENOSYS;
+    return -1;
+#endif
+}
+#endif
+
+// QDeadlineTimer 剩余时间换算为系统等待超时（-1 表示无限等待）
+qint64 remainingMs(const QDeadlineTimer &deadline)
+{
+    return deadline.isForever() ? -1 : qMax<qint64>(0, deadline.remainingTime());
+}
+
+} // namespace
+
+QList<ProcessEntry> ProcessWaiter::waitForExit(const QList<ProcessEntry> &processes, QDeadlineTimer deadline,
+                                               const CancellationToken &cancellation)
+{
+    QList<ProcessEntry> survivors;
+
+#if defined(Q_OS_WIN)
+    QList<HANDLE> handles;
+    QList<int> indexes;
+    for (int i = 0; i < processes.size(); ++i) {
+        HANDLE handle = OpenProcess(SYNCHRONIZE, FALSE, DWORD(processes.at(i).pid));
+        if (handle) {
+            handles.append(handle);
+            indexes.append(i);
+        } else if (GetLastError() != ERROR_INVALID_PARAMETER) {
+            survivors.append(processes.at(i));  // 无法确认（如权限不足），按存活处理
+        }
+    }
+
+    // 每次等待任意一个句柄（取消事件占一个位置），退出的进程移出等待集合，直到全部退出、超时或被取消
+    HANDLE cancelEvent = HANDLE(cancellation.waitHandle());
+    QList<HANDLE> pending = handles;
+    while (!pending.isEmpty() && !deadline.hasExpired() && !cancellation.isCancelled()) {
+        const DWORD count = DWORD(qMin<qsizetype>(MAXIMUM_WAIT_OBJECTS - 1, pending.size()));
+        QList<HANDLE> waitSet(pending.constBegin(), pending.constBegin() + count);
+        if (cancelEvent) {
+            waitSet.append(cancelEvent);
+        }
+        const qint64 remaining = remainingMs(deadline);
+        const DWORD result = WaitForMultipleObjects(DWORD(waitSet.size()), waitSet.constData(), FALSE,
+                                                    remaining < 0 ? INFINITE : DWORD(remaining));
+        if (result >= WAIT_OBJECT_0 && result < WAIT_OBJECT_0 + count) {
+            pending.removeAt(qsizetype(result - WAIT_OBJECT_0));
+        } else {
+            break;  // 取消、超时或等待失败
+        }
+    }
+
+    for (int i = 0; i < handles.size(); ++i) {
+        if (WaitForSingleObject(handles.at(i), 0) != WAIT_OBJECT_0) {
+            survivors.append(processes.at(indexes.at(i)));
+        }
+        CloseHandle(handles.at(i));
+    }
+#else
+    QList<pollfd> pidfds;
+    QList<int> pidfdIndexes;
+    QList<int> polled;  // 不支持 pidfd 时退化为轮询的进程
+    for (int i = 0; i < processes.size(); ++i) {
+        const ProcessEntry &process = processes.at(i);
+        const int pidfd = openPidfd(process.pid);
+        if (pidfd >= 0) {
+            // pidfd 固定了当前占用该 PID 的进程；若已不是快照中的那个，说明原进程已退出
+            if (!isAlive(process)) {
+                ::close(pidfd);
+                continue;
+            }
+            pidfds.append(pollfd{pidfd, POLLIN, 0});
+            pidfdIndexes.append(i);
+        } else if (errno != ESRCH && isAlive(process)) {
+            polled.append(i);
+        }
+    }
+
+    int pending = pidfds.size();
+    // 取消令牌的 eventfd 放在最后一项，取消时 poll 立即返回
+    const int cancelDescriptor = cancellation.waitDescriptor();
+    if (cancelDescriptor >= 0) {
+        pidfds.append(pollfd{cancelDescriptor, POLLIN, 0});
+    }
+    const qsizetype processCount = pidfdIndexes.size();
+    while ((pending > 0 || !polled.isEmpty()) && !deadline.hasExpired() && !cancellation.isCancelled()) {
+        qint64 timeout = remainingMs(deadline);
+        if (!polled.isEmpty()) {
+            timeout = timeout < 0 ? kFallbackPollIntervalMs : qMin<qint64>(timeout, kFallbackPollIntervalMs);
+        }
+
+        if (pending > 0) {
+            // 进程退出时 pidfd 变为可读；fd 为负的项会被 poll 忽略
+            const int ready = ::poll(pidfds.data(), nfds_t(pidfds.size()), int(timeout));
+            if (ready < 0 && errno != EINTR) {
+                break;
+            }
+            for (qsizetype i = 0; i < processCount; ++i) {
+                pollfd &entry = pidfds[i];
+                if (entry.fd >= 0 && entry.revents != 0) {
+                    ::close(entry.fd);
+                    entry.fd = -1;
+                    --pending;
+                }
+            }
+        } else {
+            cancellation.sleep(int(timeout));
+        }
+
+        for (qsizetype i = polled.size() - 1; i >= 0; --i) {
+            if (!isAlive(processes.at(polled.at(i)))) {
+                polled.removeAt(i);
+            }
+        }
+    }
+
+    for (qsizetype i = 0; i < processCount; ++i) {
+        if (pidfds.at(i).fd >= 0) {
+            ::close(pidfds.at(i).fd);
+            survivors.append(processes.at(pidfdIndexes.at(i)));
+        }
+    }
+    for (int index : polled) {
+        survivors.append(processes.at(index));
+    }
+#endif
+
+    return survivors;
+}
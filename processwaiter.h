@@ -0,0 +1,19 @@
+#ifndef PROCESSWAITER_H
+#define PROCESSWAITER_H
+
+#include <QDeadlineTimer>
+#include <QList>
+#include "processsnapshot.h"
+#include "cancellationtoken.h"
+
+// 进程退出等待：阻塞到目标进程真正退出或截止时间到达，不做固定时长的 sleep
+// Linux 使用 pidfd + poll，Windows 使用进程句柄 + WaitForMultipleObjects
+class ProcessWaiter
+{
+public:
+    // 等待所有进程退出，返回截止时间到达（或被取消）时仍存活的进程
+    static QList<ProcessEntry> waitForExit(const QList<ProcessEntry> &processes, QDeadlineTimer deadline,
+                                           const CancellationToken &cancellation = CancellationToken());
+};
+
+#endif // PROCESSWAITER_H
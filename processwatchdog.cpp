@@ -0,0 +1,270 @@
+#include "processwatchdog.h"
+#include <QDebug>
+#include <QElapsedTimer>
+
+#if defined(Q_OS_LINUX)
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <linux/netlink.h>
+#include <linux/connector.h>
+#include <linux/cn_proc.h>
+#endif
+
+namespace {
+
+// 事件等待的最长阻塞时间（用于响应停止请求）
+constexpr int kStopCheckIntervalMs = 200;
+// 等待确认退出的上限：超时只少记一条 Exited（强制终止通常几毫秒内退出）
+constexpr qint64 kExitConfirmTimeoutMs = 5000;
+
+#if defined(Q_OS_LINUX)
+// proc_event::what 的取值（新旧内核头文件中枚举的作用域不同，这里直接使用数值）
+constexpr unsigned kProcEventExec = 0x00000002;
+constexpr unsigned kProcEventComm = 0x00000200;
+constexpr unsigned kProcEventExit = 0x80000000;
+#endif
+
+} // namespace
+
+ProcessWatchdog::ProcessWatchdog(const TargetCatalog &catalog, QObject *parent)
+    : QThread(parent)
+    , m_matcher(catalog)
+    , m_predictor(std::make_shared<RespawnPredictor>())
+{
+}
+
+ProcessWatchdog::~ProcessWatchdog()
+{
+    stop();
+}
+
+void ProcessWatchdog::stop()
+{
+    requestInterruption();
+    wait();
+}
+
+void ProcessWatchdog::setRespawnPredictor(const std::shared_ptr<RespawnPredictor> &predictor)
+{
+    m_predictor = predictor ? predictor : std::make_shared<RespawnPredictor>();
+}
+
+void ProcessWatchdog::run()
+{
+    m_clock.start();
+    m_pendingExits.clear();
+    sweepExisting();
+
+#if defined(Q_OS_LINUX)
+    const int netlinkSocket = openProcConnector();
+    if (netlinkSocket >= 0) {
+        emit logUpdated("守护模式已启动（netlink 进程事件）");
+        runProcConnector(netlinkSocket);
+        ::close(netlinkSocket);
+        return;
+    }
+#endif
+
+    emit logUpdated(QString("守护模式已启动（增量比对，间隔%1毫秒，预测窗口内%2毫秒）").arg(kPollIntervalMs).arg(kFastPollIntervalMs));
+    runPolling();
+}
+
+void ProcessWatchdog::sweepExisting()
+{
+    const ProcessSnapshot snapshot = ProcessSnapshot::capture();
+    for (const TargetMatch &match : m_matcher.matchAll(snapshot)) {
+        const ProcessEntry *parent = snapshot.parentOf(match.process);
+        m_predictor->recordSpawn(m_matcher.rule(match.rule).product, match.process, parent ? parent->name : QString());
+        killMatch(match.rule, match.process, SweepJournal::Detected);
+    }
+}
+
+void ProcessWatchdog::handleProcess(const ProcessEntry &process, const QString &parentName)
+{
+    const int rule = m_matcher.match(process, parentName);
+    if (rule >= 0) {
+        m_predictor->recordSpawn(m_matcher.rule(rule).product, process, parentName);
+        killMatch(rule, process, SweepJournal::Respawned);
+    }
+}
+
+void ProcessWatchdog::killMatch(int rule, const ProcessEntry &process, SweepJournal::Action action)
+{
+    const QString &className = m_matcher.rule(rule).product;
+    const quint32 journalName = SweepJournal::nameId(className, process.name);
+    SweepJournal::record(action, process.pid, journalName);
+    const qint64 signalledAt = m_clock.nsecsElapsed();
+    const KillResult result = m_terminator.terminate(process);
+    if (result.success) {
+        SweepJournal::record(SweepJournal::Signalled, process.pid, journalName);
+        // 与关闭任务一样记录确认退出的耗时（--journal-stats 的平均关闭耗时才包含守护模式）；
+        // 守护线程不等待，退出由事件循环本身发现（进程连接器的 exit 事件或增量比对中消失的 PID）
+        if (SweepJournal::isEnabled()) {
+            m_pendingExits.insert(process.pid, PendingExit{journalName, process.startTime, signalledAt});
+        }
+    } else {
+        SweepJournal::record(SweepJournal::Failed, process.pid, journalName, 0, 0, result.errorCode, true);
+    }
+    if (result.success) {
+        m_predictor->recordKill(className, process.name);
+        const QString prediction = m_predictor->describe(className, process.name);
+        emit logUpdated(QString("守护模式：已关闭 %1（进程：%2，PID：%3）%4")
+                            .arg(className)
+                            .arg(process.name)
+                            .arg(process.pid)
+                            .arg(prediction.isEmpty() ? QString() : QString("，预计%1").arg(prediction)));
+        emit targetKilled(className, process.name, process.pid);
+    } else {
+        emit logUpdated(QString("守护模式：关闭 %1失败（PID：%2，错误码：%3 %4）")
+                            .arg(className)
+                            .arg(process.pid)
+                            .arg(result.errorCode)
+                            .arg(result.errorString()));
+    }
+}
+
+void ProcessWatchdog::confirmExit(qint64 pid, quint64 startTime)
+{
+    const auto it = m_pendingExits.constFind(pid);
+    if (it == m_pendingExits.constEnd() || (startTime != 0 && it->startTime != 0 && it->startTime != startTime)) {
+        return;
+    }
+    SweepJournal::record(SweepJournal::Exited, pid, it->journalName, 0,
+                         quint32(qMin<qint64>((m_clock.nsecsElapsed() - it->signalledAt) / 1000, 0xFFFFFFFF)));
+    m_pendingExits.erase(it);
+}
+
+void ProcessWatchdog::checkPendingExits(bool probe)
+{
+    const qint64 now = m_clock.nsecsElapsed();
+    for (auto it = m_pendingExits.begin(); it != m_pendingExits.end();) {
+        ProcessEntry current;
+        if (probe && (!ProcessSnapshot::readProcess(it.key(), current) || current.startTime != it->startTime)) {
+            // 进程在订阅事件之前就已退出，耗时以发现时刻为准
+            SweepJournal::record(SweepJournal::Exited, it.key(), it->journalName, 0,
+                                 quint32(qMin<qint64>((now - it->signalledAt) / 1000, 0xFFFFFFFF)));
+            it = m_pendingExits.erase(it);
+        } else if (now - it->signalledAt > kExitConfirmTimeoutMs * 1000000) {
+            it = m_pendingExits.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+#if defined(Q_OS_LINUX)
+int ProcessWatchdog::openProcConnector()
+{
+    const int netlinkSocket = ::socket(PF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC, NETLINK_CONNECTOR);
+    if (netlinkSocket < 0) {
+        return -1;
+    }
+
+    sockaddr_nl address = {};
+    address.nl_family = AF_NETLINK;
+    address.nl_groups = CN_IDX_PROC;
+    if (::bind(netlinkSocket, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0) {
+        ::close(netlinkSocket);  // 通常是缺少 CAP_NET_ADMIN
+        return -1;
+    }
+
+    // 订阅进程事件
+    alignas(nlmsghdr) char buffer[NLMSG_SPACE(sizeof(cn_msg) + sizeof(proc_cn_mcast_op))] = {};
+    nlmsghdr *header = reinterpret_cast<nlmsghdr *>(buffer);
+    header->nlmsg_len = NLMSG_LENGTH(sizeof(cn_msg) + sizeof(proc_cn_mcast_op));
+    header->nlmsg_type = NLMSG_DONE;
+    cn_msg *message = reinterpret_cast<cn_msg *>(NLMSG_DATA(header));
+    message->id.idx = CN_IDX_PROC;
+    message->id.val = CN_VAL_PROC;
+    message->len = sizeof(proc_cn_mcast_op);
+    *reinterpret_cast<proc_cn_mcast_op *>(message->data) = PROC_CN_MCAST_LISTEN;
+    if (::send(netlinkSocket, buffer, header->nlmsg_len, 0) < 0) {
+        ::close(netlinkSocket);
+        return -1;
+    }
+    return netlinkSocket;
+}
+
+void ProcessWatchdog::runProcConnector(int netlinkSocket)
+{
+    alignas(nlmsghdr) char buffer[8192];
+    pollfd descriptor = {netlinkSocket, POLLIN, 0};
+
+    while (!isInterruptionRequested()) {
+        if (::poll(&descriptor, 1, kStopCheckIntervalMs) <= 0) {
+            // 空闲时核对订阅之前终止、因而收不到 exit 事件的进程（集合通常为空）
+            checkPendingExits(true);
+            continue;
+        }
+        const ssize_t received = ::recv(netlinkSocket, buffer, sizeof(buffer), 0);
+        if (received <= 0) {
+            continue;  // ENOBUFS 等：事件溢出时下一条事件仍会到达
+        }
+
+        int remaining = int(received);
+        for (nlmsghdr *header = reinterpret_cast<nlmsghdr *>(buffer); NLMSG_OK(header, remaining);
+             header = NLMSG_NEXT(header, remaining)) {
+            if (header->nlmsg_type == NLMSG_ERROR || header->nlmsg_type == NLMSG_OVERRUN) {
+                break;
+            }
+            const cn_msg *message = reinterpret_cast<const cn_msg *>(NLMSG_DATA(header));
+            if (message->id.idx != CN_IDX_PROC || message->id.val != CN_VAL_PROC) {
+                continue;
+            }
+            const proc_event *event = reinterpret_cast<const proc_event *>(message->data);
+            if (unsigned(event->what) == kProcEventExit) {
+                // 线程退出也会产生 exit 事件，只认主线程（进程本身）
+                if (!m_pendingExits.isEmpty() && event->event_data.exit.process_pid == event->event_data.exit.process_tgid) {
+                    confirmExit(event->event_data.exit.process_tgid, 0);
+                }
+                continue;
+            }
+            qint64 pid = 0;
+            // exec：新映像加载；comm：进程改名（Wine 在加载 .exe 后通过 prctl 设置名称）
+            if (unsigned(event->what) == kProcEventExec) {
+                pid = event->event_data.exec.process_tgid;
+            } else if (unsigned(event->what) == kProcEventComm) {
+                pid = event->event_data.comm.process_tgid;
+            } else {
+                continue;
+            }
+
+            ProcessEntry process;
+            if (ProcessSnapshot::readProcess(pid, process)) {
+                ProcessEntry parent;
+                ProcessSnapshot::readProcess(process.parentPid, parent);
+                handleProcess(process, parent.name);
+            }
+        }
+    }
+}
+#endif
+
+void ProcessWatchdog::runPolling()
+{
+    ProcessTableCache cache;
+    cache.refresh();
+
+    while (!isInterruptionRequested()) {
+        // 每轮重新计算：关闭目标后会进入（或提前结束）预测窗口
+        const int interval = m_predictor->nextPollDelay(kFastPollIntervalMs, kPollIntervalMs, kPollIntervalMs);
+        for (int slept = 0; slept < interval && !isInterruptionRequested(); slept += kStopCheckIntervalMs) {
+            QThread::msleep(qMin(kStopCheckIntervalMs, interval - slept));
+        }
+        QList<ProcessEntry> added;
+        QList<ProcessEntry> removed;
+        const ProcessSnapshot snapshot = cache.refresh(&added, m_pendingExits.isEmpty() ? nullptr : &removed);
+        // 消失的 PID 即已确认退出（耗时精度为一个轮询间隔）
+        for (const ProcessEntry &process : removed) {
+            confirmExit(process.pid, process.startTime);
+        }
+        checkPendingExits(false);
+        for (const ProcessEntry &process : added) {
+            const ProcessEntry *parent = snapshot.parentOf(process);
+            handleProcess(process, parent ? parent->name : QString());
+        }
+        // 守护进程已退出的目标不会再被拉起，不必继续高频检测
+        m_predictor->dropOrphans(snapshot);
+    }
+}
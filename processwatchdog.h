@@ -0,0 +1,84 @@
+#ifndef PROCESSWATCHDOG_H
+#define PROCESSWATCHDOG_H
+
+#include <QThread>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QString>
+#include <memory>
+#include "processsnapshot.h"
+#include "processterminator.h"
+#include "targetcatalog.h"
+#include "sweepjournal.h"
+#include "respawnpredictor.h"
+
+// 守护模式线程：常驻后台，发现新启动的电子教室进程后立即终止
+// Linux 优先使用 netlink 进程连接器（事件驱动，需 CAP_NET_ADMIN），否则退化为 ProcessTableCache 增量比对；
+// Windows 使用快照增量比对，只处理新出现的 PID；增量比对按重新拉起预测调整间隔（窗口内高频、其余时间低频）
+class ProcessWatchdog : public QThread
+{
+    Q_OBJECT
+
+public:
+    // 增量比对的轮询间隔：每次只读一次目录（或快照差异），稳态开销低于 0.5% 单核（jiyu-bench 与单元测试核对）
+    // 平时使用常规间隔（新启动的目标最迟一个间隔后被发现）；只在预测的重新拉起窗口内使用高频间隔
+#if defined(Q_OS_WIN)
+    static constexpr int kPollIntervalMs = 300;
+    static constexpr int kFastPollIntervalMs = 50;
+#else
+    static constexpr int kPollIntervalMs = 100;
+    static constexpr int kFastPollIntervalMs = 10;
+#endif
+
+    explicit ProcessWatchdog(const TargetCatalog &catalog, QObject *parent = nullptr);
+    ~ProcessWatchdog() override;
+
+    // 请求停止并等待线程退出
+    void stop();
+    // 与其他任务共享重新拉起预测（默认使用自己的实例，需在 start() 前设置）
+    void setRespawnPredictor(const std::shared_ptr<RespawnPredictor> &predictor);
+
+signals:
+    void logUpdated(const QString &log);
+    // 终止了一个目标进程
+    void targetKilled(const QString &className, const QString &processName, qint64 pid);
+
+protected:
+    void run() override;
+
+private:
+    // 已发出终止、等待确认退出的进程（仅在持久化日志开启时登记，只在守护线程中访问）
+    struct PendingExit
+    {
+        quint32 journalName = 0;
+        quint64 startTime = 0;
+        qint64 signalledAt = 0;  // m_clock 纳秒
+    };
+
+    TargetMatcher m_matcher;
+    NativeProcessTerminator m_terminator;
+    std::shared_ptr<RespawnPredictor> m_predictor;
+    QElapsedTimer m_clock;
+    QHash<qint64, PendingExit> m_pendingExits;
+
+    // 启动时先清理已在运行的目标
+    void sweepExisting();
+    // 检查一个新出现的进程，命中则立即终止（parentName 用于父服务规则）
+    void handleProcess(const ProcessEntry &process, const QString &parentName);
+    // action 为写入持久化日志的来源：启动时已在运行记为 Detected，新出现的记为 Respawned
+    void killMatch(int rule, const ProcessEntry &process, SweepJournal::Action action);
+    // 确认等待中的进程已退出，记录 Exited 与耗时（startTime 为 0 时不核对）
+    void confirmExit(qint64 pid, quint64 startTime);
+    // probe 为 true 时逐个核对等待中的进程是否仍在运行；超时的条目直接丢弃
+    void checkPendingExits(bool probe);
+
+#if defined(Q_OS_LINUX)
+    // netlink 进程连接器：订阅成功返回 socket，否则返回 -1
+    int openProcConnector();
+    void runProcConnector(int netlinkSocket);
+#endif
+    // 增量比对：只解析新出现的 PID
+    void runPolling();
+};
+
+#endif // PROCESSWATCHDOG_H
@@ -50,42 +50,123 @@ ProgressWindow::ProgressWindow(QWidget *parent)
     m_mainLayout->addWidget(m_progressBar);
     setLayout(m_mainLayout);
 
+    // 日志通道取数定时器（约 60 帧/秒）
+    m_drainTimer = new QTimer(this);
+    m_drainTimer->setInterval(16);
+    connect(m_drainTimer, &QTimer::timeout, this, &ProgressWindow::drainChannel);
+
     // 初始日志
     appendLog("开始执行强制执行操作...");
 }
 
 ProgressWindow::~ProgressWindow() = default;
 
-// 更新进度条+强制刷新UI
-void ProgressWindow::updateProgress(int value, int maxValue)
+void ProgressWindow::attachChannel(const std::shared_ptr<LogChannel> &channel, const std::shared_ptr<KillProgress> &progress)
 {
-    m_progressBar->setRange(0, maxValue);
-    m_progressBar->setValue(value);
-    m_progressBar->setFormat(QString("进度：%1/%2 (%3%)")
-                                 .arg(value)
-                                 .arg(maxValue)
-                                 .arg(maxValue > 0 ? (value * 100 / maxValue) : 0));
-    // 修复qApp调用（已引入QApplication头文件）
-    QApplication::processEvents();  // 等价于qApp->processEvents()，更兼容
+    m_channel = channel;
+    m_progress = progress;
+    if (m_channel || m_progress) {
+        m_drainTimer->start();
+    } else {
+        m_drainTimer->stop();
+    }
 }
 
-// 添加日志+自动滚动+强制刷新
+// 更新进度条：以进程为单位（已确认退出 + 放弃 / 已发现），计数未变化时不重排
+void ProgressWindow::updateProgress(const KillProgress::Counters &counters)
+{
+    if (counters == m_shownProgress) {
+        return;
+    }
+    m_shownProgress = counters;
+    const int maxValue = qMax(1, counters.found);
+    if (m_progressBar->maximum() != maxValue) {
+        m_progressBar->setRange(0, maxValue);
+    }
+    m_progressBar->setValue(qMin(counters.completed(), maxValue));
+    m_progressBar->setFormat(QString("第%1轮：已关闭 %2/%3，已发送信号 %4，剩余 %5")
+                                 .arg(counters.round)
+                                 .arg(counters.exited)
+                                 .arg(counters.found)
+                                 .arg(counters.signalled)
+                                 .arg(counters.remaining()));
+}
+
+// 添加日志+自动滚动
 void ProgressWindow::appendLog(const QString &log)
 {
-    m_logTextEdit->append(QString("[%1] %2")
-                              .arg(QTime::currentTime().toString("HH:mm:ss"))
-                              .arg(log));
-    // 自动滚动到最新日志
+    LogChannel::Message message;
+    message.timestamp = QDateTime::currentMSecsSinceEpoch();
+    message.text = log;
+    appendLogBatch(QList<LogChannel::Message>() << message);
+}
+
+// 定时从通道取出一批日志并采样最新进度
+void ProgressWindow::drainChannel()
+{
+    if (m_channel) {
+        QList<LogChannel::Message> messages;
+        m_channel->drain(messages);
+        if (!messages.isEmpty()) {
+            appendLogBatch(messages);
+        }
+    }
+    if (m_progress) {
+        updateProgress(m_progress->sample());
+    }
+}
+
+void ProgressWindow::appendLogBatch(const QList<LogChannel::Message> &messages)
+{
+    QTextCursor cursor(m_logTextEdit->document());
+    cursor.movePosition(QTextCursor::End);
+    cursor.beginEditBlock();
+    for (const LogChannel::Message &message : messages) {
+        if (!m_logTextEdit->document()->isEmpty()) {
+            cursor.insertBlock();
+        }
+        cursor.insertText(QString("[%1] %2")
+                              .arg(QDateTime::fromMSecsSinceEpoch(message.timestamp).time().toString("HH:mm:ss"))
+                              .arg(message.text));
+    }
+    cursor.endEditBlock();
+    // 自动滚动到最新日志（每批一次）
     m_logTextEdit->verticalScrollBar()->setValue(m_logTextEdit->verticalScrollBar()->maximum());
-    // 强制刷新UI（修复qApp调用）
-    QApplication::processEvents();
+}
+
+void ProgressWindow::reject()
+{
+    // 关闭按钮/Esc：任务尚未完成时通知调用方取消
+    if (!m_finished) {
+        m_finished = true;
+        appendLog("正在取消...");
+        emit cancelRequested();
+    }
+    QDialog::reject();
 }
 
 // 执行完成处理
-void ProgressWindow::finishProgress()
+void ProgressWindow::finishProgress(int rounds)
 {
+    m_finished = true;
+    m_drainTimer->stop();
+    // 完成信号之前写入通道的日志/进度全部取出（单次取数有上限，循环到通道为空）
+    if (m_channel) {
+        QList<LogChannel::Message> messages;
+        while (m_channel->drain(messages) > 0) {
+        }
+        if (!messages.isEmpty()) {
+            appendLogBatch(messages);
+        }
+    }
+    if (m_progress) {
+        updateProgress(m_progress->sample());
+    }
     appendLog("强制执行操作完成！");
+    const QString summary = rounds > 0
+        ? QString("已完成%1轮全量电子教室进程关闭！").arg(rounds)
+        : QString("未检测到运行中的电子教室进程！");
     QMessageBox::information(this, "执行完成",
-                             "已完成3次全量电子教室进程关闭！\n若电子教室窗口仍然存在，请将此问题报告给软件开发者。");
+                             summary + "\n若电子教室窗口仍然存在，请将此问题报告给软件开发者。");
     close();
 }
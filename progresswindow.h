@@ -10,8 +10,11 @@
 #include <QScrollBar>
 #include <QFont>
 #include <QMessageBox>
-#include <QApplication>    // 新增：引入qApp所需头文件
+#include <QTimer>
 #include <QtWidgets>       // 兜底：确保所有QtWidgets组件被识别
+#include <memory>
+#include "logchannel.h"
+#include "killprogress.h"
 
 class ProgressWindow : public QDialog
 {
@@ -21,16 +24,36 @@ public:
     explicit ProgressWindow(QWidget *parent = nullptr);
     ~ProgressWindow() override;
 
+    // 绑定工作线程的日志通道与进度计数：按帧率定时批量取出日志并采样进度
+    void attachChannel(const std::shared_ptr<LogChannel> &channel, const std::shared_ptr<KillProgress> &progress);
+
+signals:
+    // 任务完成前用户关闭了进度窗口
+    void cancelRequested();
+
 public slots:
-    void updateProgress(int value, int maxValue);
-    // 添加日志+自动滚动+强制刷新
+    void reject() override;
+    void updateProgress(const KillProgress::Counters &counters);
+    // 添加日志+自动滚动
     void appendLog(const QString &log);
-    void finishProgress();
+    // rounds 为实际执行的关闭轮次（0 表示没有检测到任何目标）
+    void finishProgress(int rounds);
+
+private slots:
+    void drainChannel();
 
 private:
     QProgressBar *m_progressBar;
     QTextEdit *m_logTextEdit;
     QVBoxLayout *m_mainLayout;
+    QTimer *m_drainTimer;
+    std::shared_ptr<LogChannel> m_channel;
+    std::shared_ptr<KillProgress> m_progress;
+    KillProgress::Counters m_shownProgress;  // 当前显示的计数（未变化时不重绘）
+    bool m_finished = false;
+
+    // 一批日志作为一次文档编辑追加，只滚动一次
+    void appendLogBatch(const QList<LogChannel::Message> &messages);
 };
 
 #endif // PROGRESSWINDOW_H
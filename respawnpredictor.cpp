@@ -0,0 +1,172 @@
+#include "respawnpredictor.h"
+#include <QMutexLocker>
+#include <cmath>
+
+namespace {
+
+constexpr int kMinSamples = 2;                  // 少于该样本数时不做预测
+constexpr double kSmoothing = 0.3;              // 指数加权的新样本权重
+constexpr qint64 kMaxRespawnIntervalMs = 60000; // 超过该间隔才出现的不视为被重新拉起
+constexpr double kMinMarginMs = 50;             // 预测窗口的最小半宽
+constexpr double kDeviationFactor = 3;          // 窗口半宽 = 3 倍标准差 + 均值的 10%
+constexpr double kRelativeMargin = 0.1;
+// 每个目标记住的已计入进程数上限（事件驱动的守护模式不调用 dropOrphans，超出时整体清空）
+constexpr int kMaxSeenProcesses = 256;
+
+} // namespace
+
+RespawnPredictor::RespawnPredictor()
+{
+    m_clock.start();
+}
+
+QString RespawnPredictor::key(const QString &product, const QString &imageName)
+{
+    return product + '\t' + ProcessSnapshot::foldName(imageName);
+}
+
+void RespawnPredictor::recordKill(const QString &product, const QString &imageName)
+{
+    QMutexLocker locker(&m_mutex);
+    m_models[key(product, imageName)].killedAtMs = m_clock.elapsed();
+}
+
+void RespawnPredictor::recordSpawn(const QString &product, const ProcessEntry &process, const QString &parentName)
+{
+    QMutexLocker locker(&m_mutex);
+    Model &model = m_models[key(product, process.name)];
+    const auto seen = model.seen.constFind(process.pid);
+    if (seen != model.seen.constEnd() && seen.value() == process.startTime) {
+        return;  // 同一进程在后续检测中再次出现，不是新的拉起
+    }
+    if (model.seen.size() >= kMaxSeenProcesses) {
+        model.seen.clear();
+    }
+    model.seen.insert(process.pid, process.startTime);
+    if (!parentName.isEmpty()) {
+        ++model.parents[ProcessSnapshot::foldName(parentName)];
+    }
+    if (model.killedAtMs < 0) {
+        return;
+    }
+    const double interval = double(m_clock.elapsed() - model.killedAtMs);
+    model.killedAtMs = -1;
+    if (interval > kMaxRespawnIntervalMs) {
+        return;
+    }
+    if (model.samples == 0) {
+        model.meanMs = interval;
+        model.varianceMs2 = 0;
+    } else {
+        // 指数加权：守护进程调整拉起节奏后，预测在几次关闭内跟上
+        const double delta = interval - model.meanMs;
+        model.meanMs += kSmoothing * delta;
+        model.varianceMs2 = (1 - kSmoothing) * (model.varianceMs2 + kSmoothing * delta * delta);
+    }
+    ++model.samples;
+}
+
+void RespawnPredictor::dropOrphans(const ProcessSnapshot &snapshot)
+{
+    QMutexLocker locker(&m_mutex);
+    for (auto it = m_models.begin(); it != m_models.end(); ++it) {
+        Model &model = it.value();
+        model.seen.removeIf([&snapshot](QHash<qint64, quint64>::iterator seen) {
+            const ProcessEntry *process = snapshot.process(seen.key());
+            return !process || process->startTime != seen.value();
+        });
+        if (model.killedAtMs < 0) {
+            continue;
+        }
+        const QString guardian = dominantParent(model);
+        if (!guardian.isEmpty() && !snapshot.contains(guardian)) {
+            model.killedAtMs = -1;
+        }
+    }
+}
+
+bool RespawnPredictor::window(const Model &model, qint64 &startMs, qint64 &endMs)
+{
+    if (model.killedAtMs < 0 || model.samples < kMinSamples) {
+        return false;
+    }
+    const double margin = qMax(kMinMarginMs, kDeviationFactor * std::sqrt(model.varianceMs2) + kRelativeMargin * model.meanMs);
+    startMs = model.killedAtMs + qint64(model.meanMs - margin);
+    endMs = model.killedAtMs + qint64(model.meanMs + margin);
+    return true;
+}
+
+int RespawnPredictor::nextPollDelay(int fastMs, int baselineMs, int idleMs) const
+{
+    QMutexLocker locker(&m_mutex);
+    const qint64 now = m_clock.elapsed();
+    qint64 delay = idleMs;
+    for (const Model &model : m_models) {
+        if (model.killedAtMs < 0 || now - model.killedAtMs > kMaxRespawnIntervalMs) {
+            continue;
+        }
+        qint64 startMs = 0;
+        qint64 endMs = 0;
+        if (!window(model, startMs, endMs) || now > endMs) {
+            // 还在学习或这次没有按预测出现：退回常规检测间隔
+            delay = qMin<qint64>(delay, baselineMs);
+        } else if (now >= startMs) {
+            return fastMs;
+        } else {
+            delay = qMin(delay, qMax<qint64>(fastMs, startMs - now));
+        }
+    }
+    return int(delay);
+}
+
+qint64 RespawnPredictor::msecsUntilLastWindowEnd(const QSet<QString> &products) const
+{
+    QMutexLocker locker(&m_mutex);
+    const qint64 now = m_clock.elapsed();
+    qint64 latest = -1;
+    for (auto it = m_models.constBegin(); it != m_models.constEnd(); ++it) {
+        if (!products.contains(it.key().section('\t', 0, 0))) {
+            continue;
+        }
+        qint64 startMs = 0;
+        qint64 endMs = 0;
+        if (window(it.value(), startMs, endMs) && endMs > now) {
+            latest = qMax(latest, endMs - now);
+        }
+    }
+    return latest;
+}
+
+QString RespawnPredictor::dominantParent(const Model &model)
+{
+    QString parent;
+    int count = 0;
+    for (auto it = model.parents.constBegin(); it != model.parents.constEnd(); ++it) {
+        if (it.value() > count) {
+            parent = it.key();
+            count = it.value();
+        }
+    }
+    return parent;
+}
+
+QString RespawnPredictor::guardianOf(const QString &product, const QString &imageName) const
+{
+    QMutexLocker locker(&m_mutex);
+    const auto model = m_models.constFind(key(product, imageName));
+    return model == m_models.constEnd() ? QString() : dominantParent(model.value());
+}
+
+QString RespawnPredictor::describe(const QString &product, const QString &imageName) const
+{
+    QMutexLocker locker(&m_mutex);
+    const auto model = m_models.constFind(key(product, imageName));
+    if (model == m_models.constEnd() || model->samples < kMinSamples) {
+        return QString();
+    }
+    const QString guardian = dominantParent(model.value());
+    return QString("约 %1 毫秒后%2拉起（%3 个样本）")
+        .arg(qRound(model->meanMs))
+        .arg(guardian.isEmpty() ? QString() : QString("由 %1 ").arg(guardian))
+        .arg(model->samples);
+}
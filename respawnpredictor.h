@@ -0,0 +1,62 @@
+#ifndef RESPAWNPREDICTOR_H
+#define RESPAWNPREDICTOR_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QSet>
+#include <QString>
+#include "processsnapshot.h"
+
+// 重新拉起预测：按目标（产品 + 映像名）学习“关闭 → 被守护进程重新拉起”的间隔与拉起它的父进程，
+// 预测下一次出现的时间窗口。检测方只在窗口内高频检测，其余时间低频兜底，
+// 守护进程按固定节奏拉起时关闭耗时接近窗口内的检测间隔，又不必一直高频轮询
+// 可在多个线程间共享（内部加锁）
+class RespawnPredictor
+{
+public:
+    RespawnPredictor();
+
+    // 目标进程已被关闭，开始等待其被重新拉起
+    void recordKill(const QString &product, const QString &imageName);
+    // 目标进程出现（parentName 为父进程映像名）；有等待中的关闭时计入一次间隔样本
+    // 同一进程（PID + 启动时间）只计入第一次，调用方每次检测都可以直接上报仍在运行的目标
+    void recordSpawn(const QString &product, const ProcessEntry &process, const QString &parentName);
+    // 守护进程已不在运行的目标不会再被拉起，取消等待
+    void dropOrphans(const ProcessSnapshot &snapshot);
+
+    // 距下一次检测的等待时间（毫秒）：
+    // 处于预测窗口内返回 fastMs；在窗口之前则等到窗口开始（不超过 idleMs）；
+    // 有等待中但尚无可靠预测（样本不足或窗口已过）的目标时不超过 baselineMs；没有等待中的目标时返回 idleMs
+    int nextPollDelay(int fastMs, int baselineMs, int idleMs) const;
+    // products 中等待中目标的预测窗口最晚在多少毫秒后结束；没有可用预测时返回 -1
+    // （预测可能被多个任务共享，只看调用方自己关闭过的产品）
+    qint64 msecsUntilLastWindowEnd(const QSet<QString> &products) const;
+
+    // 拉起该目标次数最多的父进程映像名；未观测到时为空
+    QString guardianOf(const QString &product, const QString &imageName) const;
+    // 用于日志的预测描述（如“约 1200 毫秒后由 xx.exe 拉起（5 个样本）”）；样本不足时为空
+    QString describe(const QString &product, const QString &imageName) const;
+
+private:
+    struct Model
+    {
+        int samples = 0;
+        double meanMs = 0;          // 间隔的指数加权均值
+        double varianceMs2 = 0;     // 间隔的指数加权方差
+        qint64 killedAtMs = -1;     // 等待被重新拉起的起点（-1 表示不在等待）
+        QHash<QString, int> parents;
+        QHash<qint64, quint64> seen;  // 已计入的进程（PID -> 启动时间），退出后由 dropOrphans 清理
+    };
+
+    mutable QMutex m_mutex;
+    QElapsedTimer m_clock;
+    QHash<QString, Model> m_models;
+
+    static QString key(const QString &product, const QString &imageName);
+    static QString dominantParent(const Model &model);
+    // 预测窗口 [start, end]（相对 m_clock 的毫秒数）；样本不足或不在等待时返回 false
+    static bool window(const Model &model, qint64 &startMs, qint64 &endMs);
+};
+
+#endif // RESPAWNPREDICTOR_H
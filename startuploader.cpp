@@ -0,0 +1,30 @@
+#include "startuploader.h"
+#include "startuptrace.h"
+#include "sweepjournal.h"
+#include <QDebug>
+
+StartupLoader::StartupLoader(QObject *parent)
+    : QThread(parent)
+{
+}
+
+void StartupLoader::run()
+{
+    StartupTrace::mark("后台初始化开始");
+    m_catalog = TargetCatalog::loadDefault();
+    // 正则在这里编译一次，之后每次点击“关闭”都复用同一个匹配器
+    m_matcher = std::make_shared<const TargetMatcher>(m_catalog);
+    StartupTrace::mark(QString("目标目录加载完成（%1 条规则）").arg(m_catalog.rules().size()));
+    // 预热进程表缓存，第一次点击“关闭”时只需增量刷新
+    const ProcessSnapshot snapshot = m_processCache.refresh();
+    StartupTrace::mark(QString("首次进程快照完成（%1 个进程）").arg(snapshot.size()));
+    if (!m_journalPath.isEmpty()) {
+        // 打开时需读取名称表并映射文件，放在后台线程避免拖慢首帧
+        QString errorString;
+        if (SweepJournal::open(m_journalPath, SweepJournal::Options(), &errorString)) {
+            StartupTrace::mark("持久化日志已打开");
+        } else {
+            qWarning() << "持久化日志打开失败：" << m_journalPath << errorString;
+        }
+    }
+}
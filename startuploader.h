@@ -0,0 +1,36 @@
+#ifndef STARTUPLOADER_H
+#define STARTUPLOADER_H
+
+#include <QThread>
+#include <memory>
+#include "processsnapshot.h"
+#include "targetcatalog.h"
+
+// 启动后台阶段：加载并编译目标目录、建立首次进程快照
+// 主窗口先显示，线程结束（finished）后再由界面线程取走结果
+class StartupLoader : public QThread
+{
+    Q_OBJECT
+
+public:
+    explicit StartupLoader(QObject *parent = nullptr);
+
+    // 持久化日志路径（为空表示不记录，需在 start() 前设置）
+    void setJournalPath(const QString &path) { m_journalPath = path; }
+
+    // 仅在线程结束后调用
+    TargetCatalog catalog() const { return m_catalog; }
+    std::shared_ptr<const TargetMatcher> matcher() const { return m_matcher; }
+    ProcessTableCache processCache() const { return m_processCache; }
+
+protected:
+    void run() override;
+
+private:
+    TargetCatalog m_catalog;
+    std::shared_ptr<const TargetMatcher> m_matcher;
+    ProcessTableCache m_processCache;
+    QString m_journalPath;
+};
+
+#endif // STARTUPLOADER_H
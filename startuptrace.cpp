@@ -0,0 +1,41 @@
+#include "startuptrace.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <atomic>
+
+namespace {
+
+QElapsedTimer startupTimer;
+std::atomic<bool> traceEnabled{false};
+QMutex traceMutex;  // 保证多线程输出的行不交错
+
+} // namespace
+
+void StartupTrace::start()
+{
+    startupTimer.start();
+}
+
+void StartupTrace::setEnabled(bool enabled)
+{
+    traceEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool StartupTrace::isEnabled()
+{
+    return traceEnabled.load(std::memory_order_relaxed);
+}
+
+void StartupTrace::mark(const QString &stage)
+{
+    if (!isEnabled() || !startupTimer.isValid()) {
+        return;
+    }
+    const double elapsedMs = startupTimer.nsecsElapsed() / 1000000.0;
+    const QString threadName = QThread::isMainThread() ? QString("main") : QString("worker");
+    QMutexLocker locker(&traceMutex);
+    qInfo().noquote() << QString("[startup] %1 ms [%2] %3").arg(elapsedMs, 9, 'f', 1).arg(threadName).arg(stage);
+}
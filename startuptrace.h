@@ -0,0 +1,19 @@
+#ifndef STARTUPTRACE_H
+#define STARTUPTRACE_H
+
+#include <QString>
+
+// 冷启动计时：命令行加 --startup-trace 后，按阶段输出距进程启动的毫秒数，
+// 用于测量“首帧可见”和“可交互”时间并做回归对比
+class StartupTrace
+{
+public:
+    // 在 main() 最开始调用，作为计时起点
+    static void start();
+    static void setEnabled(bool enabled);
+    static bool isEnabled();
+    // 记录一个阶段（任意线程可调用，未启用时不输出）
+    static void mark(const QString &stage);
+};
+
+#endif // STARTUPTRACE_H
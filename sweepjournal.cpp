@@ -0,0 +1,584 @@
+#include "sweepjournal.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QWaitCondition>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "processsnapshot.h"
+
+namespace {
+
+constexpr char kMagic[4] = {'J', 'Y', 'S', 'J'};
+constexpr quint16 kFormatVersion = 1;
+constexpr int kHeaderSize = 64;
+constexpr quint64 kQueueCapacity = 65536;  // 2 的幂，按位与取槽位
+constexpr int kBatchSize = 4096;           // 后台线程每次拷贝的记录数上限
+constexpr int kMaxRotatedFiles = 99;       // 查询时最多向前查找的轮转文件
+
+// 文件头：count 在记录写入之后才更新，异常退出时最多丢失最后一批
+struct FileHeader
+{
+    char magic[4];
+    quint16 version;
+    quint16 recordSize;
+    quint32 capacity;
+    quint32 reserved;
+    quint64 count;
+    qint64 createdUs;
+    char padding[kHeaderSize - 32];
+};
+
+static_assert(sizeof(FileHeader) == kHeaderSize, "文件头必须为 64 字节");
+static_assert(sizeof(SweepJournal::Record) == 32, "记录必须为 32 字节");
+
+// 有界无锁队列（多生产者、单消费者），与 LogChannel 的算法相同，槽位存放定长记录
+struct Cell
+{
+    std::atomic<quint64> sequence{0};
+    SweepJournal::Record record;
+};
+
+Cell *createCells()
+{
+    Cell *cells = new Cell[kQueueCapacity];
+    for (quint64 i = 0; i < kQueueCapacity; ++i) {
+        cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    return cells;
+}
+
+// 队列在整个进程生命周期内保留，关闭日志时仍在写入的线程不会访问已释放的内存
+std::unique_ptr<Cell[]> queueCells(createCells());
+std::atomic<quint64> enqueuePosition{0};
+quint64 dequeuePosition = 0;  // 仅后台写入线程访问
+std::atomic<quint64> droppedRecords{0};
+// 已通过 isEnabled() 检查、正在写入槽位的生产者数：关闭时等它们归零后再做最后一次写出，
+// 否则迟到的记录会留在进程级队列里，被写进同一进程下一次打开的日志
+std::atomic<int> activeProducers{0};
+
+struct ProducerGuard
+{
+    ProducerGuard() { activeProducers.fetch_add(1, std::memory_order_seq_cst); }
+    ~ProducerGuard() { activeProducers.fetch_sub(1, std::memory_order_release); }
+};
+
+struct Writer
+{
+    QString path;
+    SweepJournal::Options options;
+    QFile file;
+    uchar *map = nullptr;
+    FileHeader *header = nullptr;
+
+    std::thread thread;
+    QMutex wakeMutex;
+    QWaitCondition wake;
+    bool stopping = false;
+
+    QHash<QString, quint32> nameIds;  // "产品\t折叠后的映像名" -> ID
+    quint32 nextNameId = 1;
+    QFile namesFile;
+};
+
+QMutex openMutex;  // 保护 writer 的创建/销毁与名称表
+std::unique_ptr<Writer> writer;
+
+qint64 nowUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+QString rotatedPath(const QString &path, int index)
+{
+    return QString("%1.%2").arg(path).arg(index);
+}
+
+QString namesPath(const QString &path)
+{
+    return path + ".names";
+}
+
+// 名称表中不允许出现分隔符
+QString sanitizeName(QString name)
+{
+    return name.replace('\t', ' ').replace('\n', ' ').replace('\r', ' ');
+}
+
+bool isValidHeader(const FileHeader *header)
+{
+    return std::memcmp(header->magic, kMagic, sizeof(kMagic)) == 0 && header->version == kFormatVersion
+           && header->recordSize == sizeof(SweepJournal::Record);
+}
+
+// 轮转文件：path → path.1 → path.2 …，超出保留数量的最旧文件被删除；返回当前文件是否已让出
+bool shiftFiles(const Writer &w)
+{
+    QFile::remove(w.options.maxFiles > 1 ? rotatedPath(w.path, w.options.maxFiles - 1) : w.path);
+    for (int i = w.options.maxFiles - 2; i >= 1; --i) {
+        QFile::rename(rotatedPath(w.path, i), rotatedPath(w.path, i + 1));
+    }
+    if (w.options.maxFiles > 1) {
+        QFile::rename(w.path, rotatedPath(w.path, 1));
+    }
+    return !QFile::exists(w.path);
+}
+
+void unmapFile(Writer &w)
+{
+    if (w.map) {
+        w.file.unmap(w.map);
+    }
+    w.map = nullptr;
+    w.header = nullptr;
+    w.file.close();
+}
+
+// 打开当前文件并映射；已有的文件格式或容量不符时先轮转出去
+bool mapFile(Writer &w, QString *errorString)
+{
+    const qint64 size = kHeaderSize + qint64(w.options.recordsPerFile) * qint64(sizeof(SweepJournal::Record));
+    w.file.setFileName(w.path);
+    if (!w.file.open(QIODevice::ReadWrite)) {
+        if (errorString) {
+            *errorString = w.file.errorString();
+        }
+        return false;
+    }
+    const bool fresh = w.file.size() == 0;
+    if (!fresh && w.file.size() != size) {
+        // 容量与当前设置不同（或文件已损坏）：与写满时一样轮转，已有的 .1、.2 … 依次后移而不被覆盖
+        w.file.close();
+        if (!shiftFiles(w)) {
+            if (errorString) {
+                *errorString = QString("无法轮转旧的日志文件：%1").arg(w.path);
+            }
+            return false;
+        }
+        return mapFile(w, errorString);
+    }
+    if (fresh && !w.file.resize(size)) {
+        if (errorString) {
+            *errorString = w.file.errorString();
+        }
+        w.file.close();
+        return false;
+    }
+    w.map = w.file.map(0, size);
+    if (!w.map) {
+        if (errorString) {
+            *errorString = w.file.errorString();
+        }
+        w.file.close();
+        return false;
+    }
+    w.header = reinterpret_cast<FileHeader *>(w.map);
+    if (fresh || !isValidHeader(w.header) || w.header->capacity != quint32(w.options.recordsPerFile)) {
+        std::memset(w.header, 0, kHeaderSize);
+        std::memcpy(w.header->magic, kMagic, sizeof(kMagic));
+        w.header->version = kFormatVersion;
+        w.header->recordSize = sizeof(SweepJournal::Record);
+        w.header->capacity = quint32(w.options.recordsPerFile);
+        w.header->createdUs = nowUs();
+    }
+    return true;
+}
+
+// 当前文件写满：轮转后从新文件开始
+void rotate(Writer &w)
+{
+    unmapFile(w);
+    shiftFiles(w);
+    mapFile(w, nullptr);
+}
+
+void writeBatch(Writer &w, const SweepJournal::Record *records, int count)
+{
+    while (count > 0) {
+        if (!w.header) {
+            droppedRecords.fetch_add(quint64(count), std::memory_order_relaxed);
+            return;  // 映射失败（如磁盘已满）：丢弃并计数，不影响关闭流程
+        }
+        if (w.header->count >= w.header->capacity) {
+            rotate(w);
+            continue;
+        }
+        const int n = int(qMin<quint64>(quint64(count), w.header->capacity - w.header->count));
+        std::memcpy(w.map + kHeaderSize + w.header->count * sizeof(SweepJournal::Record), records,
+                    size_t(n) * sizeof(SweepJournal::Record));
+        // 先落记录再更新计数，读取方看到的计数之内都是完整记录
+        std::atomic_thread_fence(std::memory_order_release);
+        w.header->count += quint64(n);
+        records += n;
+        count -= n;
+    }
+}
+
+// 取出队列中的全部记录并写入文件
+void drainQueue(Writer &w, std::vector<SweepJournal::Record> &batch)
+{
+    for (;;) {
+        batch.clear();
+        while (int(batch.size()) < kBatchSize) {
+            Cell &cell = queueCells[dequeuePosition & (kQueueCapacity - 1)];
+            const quint64 sequence = cell.sequence.load(std::memory_order_acquire);
+            if (qint64(sequence) - qint64(dequeuePosition + 1) < 0) {
+                break;  // 空
+            }
+            batch.push_back(cell.record);
+            cell.sequence.store(dequeuePosition + kQueueCapacity, std::memory_order_release);
+            ++dequeuePosition;
+        }
+        if (batch.empty()) {
+            return;
+        }
+        writeBatch(w, batch.data(), int(batch.size()));
+    }
+}
+
+void runWriter(Writer *w)
+{
+    std::vector<SweepJournal::Record> batch;
+    batch.reserve(kBatchSize);
+    for (;;) {
+        bool stopping = false;
+        {
+            QMutexLocker locker(&w->wakeMutex);
+            if (!w->stopping) {
+                w->wake.wait(&w->wakeMutex, ulong(w->options.flushIntervalMs));
+            }
+            stopping = w->stopping;
+        }
+        drainQueue(*w, batch);
+        if (stopping) {
+            return;
+        }
+    }
+}
+
+bool loadNames(Writer &w, QString *errorString)
+{
+    w.namesFile.setFileName(namesPath(w.path));
+    if (!w.namesFile.open(QIODevice::ReadWrite | QIODevice::Append | QIODevice::Text)) {
+        if (errorString) {
+            *errorString = w.namesFile.errorString();
+        }
+        return false;
+    }
+    w.namesFile.seek(0);
+    while (!w.namesFile.atEnd()) {
+        const QStringList fields = QString::fromUtf8(w.namesFile.readLine()).trimmed().split('\t');
+        bool ok = false;
+        const quint32 id = fields.value(0).toUInt(&ok);
+        if (ok && fields.size() == 3) {
+            w.nameIds.insert(fields.at(1) + '\t' + ProcessSnapshot::foldName(fields.at(2)), id);
+            w.nextNameId = qMax(w.nextNameId, id + 1);
+        }
+    }
+    return true;
+}
+
+bool readNames(const QString &path, QHash<quint32, SweepJournal::Name> &names)
+{
+    QFile file(namesPath(path));
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return false;
+    }
+    while (!file.atEnd()) {
+        const QStringList fields = QString::fromUtf8(file.readLine()).trimmed().split('\t');
+        bool ok = false;
+        const quint32 id = fields.value(0).toUInt(&ok);
+        if (ok && fields.size() == 3) {
+            names.insert(id, SweepJournal::Name{fields.at(1), fields.at(2)});
+        }
+    }
+    return true;
+}
+
+bool readFile(const QString &path, QList<SweepJournal::Record> &records)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly) || file.size() < kHeaderSize) {
+        return false;
+    }
+    const uchar *map = file.map(0, file.size());
+    if (!map) {
+        return false;
+    }
+    const FileHeader *header = reinterpret_cast<const FileHeader *>(map);
+    const bool valid = isValidHeader(header);
+    if (valid) {
+        const quint64 available = quint64(file.size() - kHeaderSize) / sizeof(SweepJournal::Record);
+        const quint64 count = qMin(header->count, available);
+        const qsizetype offset = records.size();
+        records.resize(offset + qsizetype(count));
+        std::memcpy(records.data() + offset, map + kHeaderSize, size_t(count) * sizeof(SweepJournal::Record));
+    }
+    file.unmap(const_cast<uchar *>(map));
+    return valid;
+}
+
+struct ProductStats
+{
+    qint64 detected = 0;
+    qint64 respawned = 0;
+    qint64 signalled = 0;
+    qint64 exited = 0;
+    qint64 failed = 0;
+    qint64 suspended = 0;
+    qint64 resumed = 0;
+    double latencySumUs = 0;
+    quint32 latencyMaxUs = 0;
+};
+
+} // namespace
+
+std::atomic<bool> SweepJournal::s_enabled{false};
+
+bool SweepJournal::open(const QString &path, const Options &options, QString *errorString)
+{
+    close();
+    QMutexLocker locker(&openMutex);
+    auto w = std::make_unique<Writer>();
+    w->path = path;
+    w->options.recordsPerFile = qMax(1, options.recordsPerFile);
+    w->options.maxFiles = qMax(1, options.maxFiles);
+    w->options.flushIntervalMs = qMax(1, options.flushIntervalMs);
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    if (!loadNames(*w, errorString) || !mapFile(*w, errorString)) {
+        return false;
+    }
+
+    writer = std::move(w);
+    Writer *raw = writer.get();
+    writer->thread = std::thread([raw]() {
+        runWriter(raw);
+    });
+    s_enabled.store(true, std::memory_order_release);
+    return true;
+}
+
+void SweepJournal::close()
+{
+    QMutexLocker locker(&openMutex);
+    if (!writer) {
+        return;
+    }
+    s_enabled.store(false, std::memory_order_seq_cst);
+    // 生产者只做几次原子操作与一次 32 字节拷贝，自旋等待即可
+    while (activeProducers.load(std::memory_order_acquire) != 0) {
+        std::this_thread::yield();
+    }
+    {
+        QMutexLocker wakeLocker(&writer->wakeMutex);
+        writer->stopping = true;
+        writer->wake.wakeAll();
+    }
+    writer->thread.join();  // 写出队列中剩余的记录
+    unmapFile(*writer);
+    writer->namesFile.close();
+    writer.reset();
+}
+
+quint32 SweepJournal::nameId(const QString &product, const QString &imageName)
+{
+    if (!isEnabled()) {
+        return 0;
+    }
+    const QString cleanProduct = sanitizeName(product);
+    const QString key = cleanProduct + '\t' + ProcessSnapshot::foldName(sanitizeName(imageName));
+    QMutexLocker locker(&openMutex);
+    if (!writer) {
+        return 0;
+    }
+    const auto existing = writer->nameIds.constFind(key);
+    if (existing != writer->nameIds.constEnd()) {
+        return existing.value();
+    }
+    const quint32 id = writer->nextNameId++;
+    writer->nameIds.insert(key, id);
+    writer->namesFile.write(QString("%1\t%2\t%3\n").arg(id).arg(cleanProduct, sanitizeName(imageName)).toUtf8());
+    writer->namesFile.flush();
+    return id;
+}
+
+void SweepJournal::record(Action action, qint64 pid, quint32 nameId, int round, quint32 latencyUs, int errorCode, bool failed)
+{
+    if (!isEnabled()) {
+        return;
+    }
+    // 登记后再确认一次：与 close() 的 s_enabled 写入、计数读取构成顺序一致的配对，
+    // 两者至少有一方看到对方（要么这里看到已关闭，要么 close() 等到本次写入完成）
+    const ProducerGuard guard;
+    if (!s_enabled.load(std::memory_order_seq_cst)) {
+        return;
+    }
+    quint64 position = enqueuePosition.load(std::memory_order_relaxed);
+    for (;;) {
+        Cell &cell = queueCells[position & (kQueueCapacity - 1)];
+        const quint64 sequence = cell.sequence.load(std::memory_order_acquire);
+        const qint64 difference = qint64(sequence) - qint64(position);
+        if (difference == 0) {
+            if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                Record &record = cell.record;
+                record.timestampUs = nowUs();
+                record.pid = quint32(pid);
+                record.nameId = nameId;
+                record.latencyUs = latencyUs;
+                record.errorCode = errorCode;
+                record.round = quint16(qBound(0, round, 0xFFFF));
+                record.action = action;
+                record.result = failed ? 1 : 0;
+                record.reserved = 0;
+                cell.sequence.store(position + 1, std::memory_order_release);
+                return;
+            }
+        } else if (difference < 0) {
+            // 队列已满（写入线程跟不上或磁盘卡顿）：日志不应反向阻塞关闭流程
+            droppedRecords.fetch_add(1, std::memory_order_relaxed);
+            return;
+        } else {
+            position = enqueuePosition.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+quint64 SweepJournal::droppedCount()
+{
+    return droppedRecords.load(std::memory_order_relaxed);
+}
+
+bool SweepJournal::readAll(const QString &path, QList<Record> &records, QHash<quint32, Name> &names, QString *errorString)
+{
+    records.clear();
+    names.clear();
+    // 从最旧的轮转文件读到当前文件
+    QStringList files;
+    for (int i = kMaxRotatedFiles; i >= 1; --i) {
+        if (QFile::exists(rotatedPath(path, i))) {
+            files.append(rotatedPath(path, i));
+        }
+    }
+    if (QFile::exists(path)) {
+        files.append(path);
+    }
+    if (files.isEmpty()) {
+        if (errorString) {
+            *errorString = QString("日志文件不存在：%1").arg(path);
+        }
+        return false;
+    }
+    for (const QString &file : files) {
+        if (!readFile(file, records)) {
+            qWarning("忽略无法识别的日志文件：%s", qPrintable(file));
+        }
+    }
+    readNames(path, names);
+    return true;
+}
+
+QJsonObject SweepJournal::summarize(const QList<Record> &records, const QHash<quint32, Name> &names, int hotspotCount)
+{
+    QHash<QString, ProductStats> products;
+    QHash<QString, int> failures;  // "产品\t映像名\t错误码" -> 次数
+    qint64 firstUs = 0;
+    qint64 lastUs = 0;
+    for (const Record &record : records) {
+        firstUs = firstUs == 0 ? record.timestampUs : qMin(firstUs, record.timestampUs);
+        lastUs = qMax(lastUs, record.timestampUs);
+        const Name name = names.value(record.nameId, Name{QStringLiteral("未知"), QString()});
+        ProductStats &stats = products[name.product];
+        switch (record.action) {
+        case Detected:
+            ++stats.detected;
+            break;
+        case Respawned:
+            ++stats.respawned;
+            break;
+        case Signalled:
+            ++stats.signalled;
+            break;
+        case Exited:
+            ++stats.exited;
+            stats.latencySumUs += record.latencyUs;
+            stats.latencyMaxUs = qMax(stats.latencyMaxUs, record.latencyUs);
+            break;
+        case Suspended:
+            ++stats.suspended;
+            break;
+        case Resumed:
+            ++stats.resumed;
+            break;
+        case Failed:
+            ++stats.failed;
+            ++failures[QString("%1\t%2\t%3").arg(name.product, name.imageName).arg(record.errorCode)];
+            break;
+        default:
+            break;
+        }
+    }
+
+    // 时间跨度不足一秒时按一秒计，避免频率被放大
+    const double spanSeconds = qMax(1.0, (lastUs - firstUs) / 1e6);
+    QList<QPair<QString, ProductStats>> sortedProducts;
+    for (auto it = products.constBegin(); it != products.constEnd(); ++it) {
+        sortedProducts.append(qMakePair(it.key(), it.value()));
+    }
+    std::sort(sortedProducts.begin(), sortedProducts.end(), [](const auto &left, const auto &right) {
+        return left.second.respawned != right.second.respawned ? left.second.respawned > right.second.respawned
+                                                               : left.first < right.first;
+    });
+    QJsonArray productArray;
+    for (const auto &entry : sortedProducts) {
+        const ProductStats &stats = entry.second;
+        QJsonObject object;
+        object.insert("product", entry.first);
+        object.insert("detected", stats.detected);
+        object.insert("respawned", stats.respawned);
+        object.insert("respawnsPerHour", stats.respawned * 3600.0 / spanSeconds);
+        object.insert("signalled", stats.signalled);
+        object.insert("exited", stats.exited);
+        object.insert("failed", stats.failed);
+        object.insert("suspended", stats.suspended);
+        object.insert("resumed", stats.resumed);
+        object.insert("meanTimeToKillMs", stats.exited ? stats.latencySumUs / stats.exited / 1000.0 : 0.0);
+        object.insert("maxTimeToKillMs", stats.latencyMaxUs / 1000.0);
+        productArray.append(object);
+    }
+
+    QList<QPair<QString, int>> sortedFailures;
+    for (auto it = failures.constBegin(); it != failures.constEnd(); ++it) {
+        sortedFailures.append(qMakePair(it.key(), it.value()));
+    }
+    std::sort(sortedFailures.begin(), sortedFailures.end(), [](const auto &left, const auto &right) {
+        return left.second != right.second ? left.second > right.second : left.first < right.first;
+    });
+    QJsonArray hotspots;
+    for (int i = 0; i < sortedFailures.size() && i < hotspotCount; ++i) {
+        const QStringList fields = sortedFailures.at(i).first.split('\t');
+        const int errorCode = fields.value(2).toInt();
+        QJsonObject object;
+        object.insert("product", fields.value(0));
+        object.insert("imageName", fields.value(1));
+        object.insert("errorCode", errorCode);
+        object.insert("error", errorCode ? qt_error_string(errorCode) : QString());
+        object.insert("failures", sortedFailures.at(i).second);
+        hotspots.append(object);
+    }
+
+    QJsonObject summary;
+    summary.insert("records", int(records.size()));
+    summary.insert("firstUs", firstUs);
+    summary.insert("lastUs", lastUs);
+    summary.insert("spanSeconds", (lastUs - firstUs) / 1e6);
+    summary.insert("products", productArray);
+    summary.insert("hotspots", hotspots);
+    return summary;
+}
@@ -0,0 +1,76 @@
+#ifndef SWEEPJOURNAL_H
+#define SWEEPJOURNAL_H
+
+#include <QHash>
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+#include <atomic>
+
+// 关闭流程的持久化日志：每个事件一条 32 字节的定长二进制记录
+// 写入方只把记录放入无锁队列（一次原子操作 + 一次拷贝），后台线程按批写入内存映射的只追加文件，写满后轮转
+// 文件布局：64 字节文件头 + 记录；映像名在旁边的 .names 文本文件中登记为 ID
+// 与 KillTrace 一样是进程级单例，未打开时每个记录点只有一次原子读取
+class SweepJournal
+{
+public:
+    enum Action : quint8 {
+        Detected = 1,   // 排入关闭（全量关闭第 1 轮、守护模式启动时已在运行）
+        Respawned = 2,  // 被重新拉起后再次排入关闭（全量关闭后续轮次、守护模式发现的新进程）
+        Signalled = 3,  // 已发送终止信号
+        Exited = 4,     // 已确认退出；latencyUs 为从开始关闭该目标到确认退出的耗时
+        Failed = 5,     // 放弃（终止调用失败或未在时限内退出）；errorCode 为最后一次的错误码
+        Suspended = 6,  // 守护进程或冻结目标已挂起；latencyUs 为从开始挂起该目标到挂起成功的耗时
+        Resumed = 7     // 冻结目标已恢复
+    };
+
+    // 磁盘上的记录格式（小端）
+    struct Record
+    {
+        qint64 timestampUs = 0;   // 自纪元起的微秒数
+        quint32 pid = 0;
+        quint32 nameId = 0;       // 见 nameId()，0 表示未知
+        quint32 latencyUs = 0;
+        qint32 errorCode = 0;
+        quint16 round = 0;
+        quint8 action = 0;
+        quint8 result = 0;        // 0 成功，1 失败
+        quint32 reserved = 0;
+    };
+
+    struct Options
+    {
+        int recordsPerFile = 65536;   // 每个文件的记录数（2 MB）
+        int maxFiles = 4;             // 保留的文件数（含当前文件）
+        int flushIntervalMs = 50;     // 后台线程的批量写入间隔
+    };
+
+    // 打开（或续写）日志；已打开时先关闭之前的日志
+    static bool open(const QString &path, const Options &options = Options(), QString *errorString = nullptr);
+    // 写出队列中剩余的记录并关闭
+    static void close();
+    static bool isEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+    // 教室软件名称 + 映像名对应的 ID（首次出现时登记到名称表）；未打开时返回 0
+    static quint32 nameId(const QString &product, const QString &imageName);
+    // 任意线程调用，无锁；队列满时丢弃并计数
+    static void record(Action action, qint64 pid, quint32 nameId, int round = 0, quint32 latencyUs = 0,
+                       int errorCode = 0, bool failed = false);
+    static quint64 droppedCount();
+
+    // 查询：读取 path 及其轮转文件中的全部记录（按时间顺序）与名称表
+    struct Name
+    {
+        QString product;
+        QString imageName;
+    };
+    static bool readAll(const QString &path, QList<Record> &records, QHash<quint32, Name> &names,
+                        QString *errorString = nullptr);
+    // 按产品统计被重新拉起的频率（次/小时）、平均关闭耗时，并列出失败最多的 (产品, 映像名, 错误码)
+    static QJsonObject summarize(const QList<Record> &records, const QHash<quint32, Name> &names, int hotspotCount = 10);
+
+private:
+    static std::atomic<bool> s_enabled;
+};
+
+#endif // SWEEPJOURNAL_H
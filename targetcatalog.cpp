@@ -0,0 +1,365 @@
+#include "targetcatalog.h"
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+
+namespace {
+
+QStringList toStringList(const QJsonValue &value)
+{
+    QStringList list;
+    const QJsonArray array = value.toArray();
+    for (const QJsonValue &item : array) {
+        if (!item.toString().isEmpty()) {
+            list.append(item.toString());
+        }
+    }
+    return list;
+}
+
+} // namespace
+
+TargetCatalog TargetCatalog::builtin()
+{
+    // 与早期版本内置的进程列表一致（进程名 -> 教室软件名称）
+    static const struct {
+        const char *processName;
+        const char *product;
+    } kBuiltinTargets[] = {
+        {"StudentMain.exe", "极域电子教室"},
+        {"Student.exe", "红蜘蛛电子教室"},
+        {"RedSpiderStudent.exe", "红蜘蛛电子教室"},
+        {"LanStarStudent.exe", "蓝星电子教室"},
+        {"NetOpStudent.exe", "NetOp电子教室"},
+        {"ClassInStudent.exe", "ClassIn电子教室"},
+        {"SmartClassroomStudent.exe", "智慧教室学生端"},
+        {"e-LearningStudent.exe", "易乐学电子教室"},
+        {"MultimediaClassroom.exe", "多媒体电子教室"}
+    };
+    // 负责重新拉起客户端的守护进程（映像名 -> 教室软件名称）
+    static const struct {
+        const char *processName;
+        const char *product;
+    } kBuiltinGuardians[] = {
+        {"MasterHelper.exe", "极域电子教室"},
+        {"GATESRV.exe", "极域电子教室"}
+    };
+
+    TargetCatalog catalog;
+    for (const auto &target : kBuiltinTargets) {
+        const QString product = QString::fromUtf8(target.product);
+        // 同一产品的多个映像名合并为一条规则
+        TargetRule *existing = nullptr;
+        for (TargetRule &rule : catalog.m_rules) {
+            if (rule.product == product) {
+                existing = &rule;
+                break;
+            }
+        }
+        if (!existing) {
+            catalog.m_rules.append(TargetRule());
+            existing = &catalog.m_rules.last();
+            existing->product = product;
+        }
+        existing->names.append(QString::fromUtf8(target.processName));
+    }
+    for (const auto &guardian : kBuiltinGuardians) {
+        for (TargetRule &rule : catalog.m_rules) {
+            if (rule.product == QString::fromUtf8(guardian.product)) {
+                rule.guardians.append(QString::fromUtf8(guardian.processName));
+            }
+        }
+    }
+    return catalog;
+}
+
+TargetCatalog TargetCatalog::load(const QString &path, QString *errorString)
+{
+    TargetCatalog catalog;
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (errorString) {
+            *errorString = file.errorString();
+        }
+        return catalog;
+    }
+
+    QJsonParseError parseError;
+    const QJsonDocument document = QJsonDocument::fromJson(file.readAll(), &parseError);
+    if (parseError.error != QJsonParseError::NoError || !document.isObject()) {
+        if (errorString) {
+            *errorString = parseError.errorString();
+        }
+        return catalog;
+    }
+
+    const QJsonArray targets = document.object().value("targets").toArray();
+    for (const QJsonValue &value : targets) {
+        const QJsonObject object = value.toObject();
+        TargetRule rule;
+        rule.product = object.value("product").toString();
+        rule.names = toStringList(object.value("names"));
+        rule.patterns = toStringList(object.value("patterns"));
+        rule.parentServices = toStringList(object.value("parentServices"));
+        rule.guardians = toStringList(object.value("guardians"));
+        const QString guardianAction = object.value("guardianAction").toString("suspend");
+        if (guardianAction == "kill") {
+            rule.guardianAction = TargetRule::KillGuardian;
+        } else if (guardianAction != "suspend") {
+            qWarning() << "未知的守护进程处理方式，按挂起处理：" << rule.product << guardianAction;
+        }
+        rule.hashPaths = toStringList(object.value("hashPaths"));
+        const QJsonArray hashes = object.value("hashes").toArray();
+        for (const QJsonValue &hashValue : hashes) {
+            const QJsonObject hashObject = hashValue.toObject();
+            ExecutableHash hash;
+            hash.sha256 = hashObject.value("sha256").toString().toLower().toLatin1();
+            hash.size = hashObject.value("size").toInteger(-1);
+            if (hash.sha256.size() == 64) {
+                rule.hashes.append(hash);
+            }
+        }
+
+        if (!rule.hashes.isEmpty() && rule.hashPaths.isEmpty()) {
+            // 没有候选路径时每次匹配都要读取全部进程的可执行文件，不接受
+            qWarning() << "指纹规则缺少 hashPaths，忽略其指纹：" << rule.product;
+            rule.hashes.clear();
+        }
+        if (rule.product.isEmpty()
+            || (rule.names.isEmpty() && rule.patterns.isEmpty() && rule.hashes.isEmpty() && rule.parentServices.isEmpty())) {
+            qWarning() << "忽略无效的目标规则：" << object;
+            continue;
+        }
+        catalog.m_rules.append(rule);
+    }
+
+    if (catalog.isEmpty() && errorString) {
+        *errorString = "目录中没有有效的目标规则";
+    }
+    return catalog;
+}
+
+QString TargetCatalog::defaultPath()
+{
+    return QDir(QCoreApplication::applicationDirPath()).filePath("targets.json");
+}
+
+TargetCatalog TargetCatalog::loadDefault()
+{
+    const QString path = defaultPath();
+    if (QFile::exists(path)) {
+        QString errorString;
+        const TargetCatalog catalog = load(path, &errorString);
+        if (!catalog.isEmpty()) {
+            return catalog;
+        }
+        qWarning() << "目标目录加载失败，使用内置目录：" << path << errorString;
+    }
+    return builtin();
+}
+
+TargetMatcher::TargetMatcher(const TargetCatalog &catalog)
+    : m_catalog(catalog)
+{
+    QStringList alternatives;
+    QStringList hashPaths;
+    const QList<TargetRule> &rules = m_catalog.rules();
+    for (int i = 0; i < rules.size(); ++i) {
+        const TargetRule &rule = rules.at(i);
+        // 同名冲突时以靠前的规则为准
+        for (const QString &name : rule.names) {
+            const QString key = ProcessSnapshot::foldName(name);
+            if (!m_exactNames.contains(key)) {
+                m_exactNames.insert(key, i);
+            }
+        }
+        for (const QString &service : rule.parentServices) {
+            const QString key = ProcessSnapshot::foldName(service);
+            if (!m_parentServices.contains(key)) {
+                m_parentServices.insert(key, i);
+            }
+        }
+        for (const QString &guardian : rule.guardians) {
+            const QString key = ProcessSnapshot::foldName(guardian);
+            if (!m_guardians.contains(key)) {
+                m_guardians.insert(key, i);
+            }
+        }
+        for (const ExecutableHash &hash : rule.hashes) {
+            m_hashes.insert(hash.sha256, i);
+            m_hashSizes.insert(hash.size);
+        }
+        if (!rule.hashes.isEmpty()) {
+            for (const QString &path : rule.hashPaths) {
+                hashPaths.append(QRegularExpression::wildcardToRegularExpression(
+                    QDir::fromNativeSeparators(path), QRegularExpression::UnanchoredWildcardConversion | QRegularExpression::NonPathWildcardConversion));
+            }
+        }
+        for (int j = 0; j < rule.patterns.size(); ++j) {
+            const QString &pattern = rule.patterns.at(j);
+            const QString expression = pattern.startsWith("re:")
+                ? pattern.mid(3)
+                : QRegularExpression::wildcardToRegularExpression(
+                      pattern, QRegularExpression::UnanchoredWildcardConversion | QRegularExpression::NonPathWildcardConversion);
+            // 逐条校验，避免一条错误的模式使整个合并正则失效
+            if (!QRegularExpression(expression).isValid()) {
+                qWarning() << "忽略无效的匹配模式：" << rule.product << pattern;
+                continue;
+            }
+            alternatives.append(QString("(?<p%1_%2>%3)").arg(i).arg(j).arg(expression));
+        }
+    }
+
+    if (!hashPaths.isEmpty()) {
+        m_hashPaths.setPattern(QString("^(?:%1)$").arg(hashPaths.join('|')));
+        m_hashPaths.setPatternOptions(QRegularExpression::CaseInsensitiveOption);
+        m_hashPaths.optimize();
+    }
+
+    if (alternatives.isEmpty()) {
+        return;
+    }
+    m_patterns.setPattern(QString("^(?:%1)$").arg(alternatives.join('|')));
+    m_patterns.setPatternOptions(QRegularExpression::CaseInsensitiveOption);
+    if (!m_patterns.isValid()) {
+        qWarning() << "匹配模式合并失败：" << m_patterns.errorString();
+        return;
+    }
+    m_patterns.optimize();
+
+    // 用户正则中可能自带捕获组，按组名而不是序号还原规则
+    const QStringList groups = m_patterns.namedCaptureGroups();
+    m_groupRules.fill(-1, groups.size());
+    for (int group = 1; group < groups.size(); ++group) {
+        const QString &groupName = groups.at(group);
+        const int separator = groupName.indexOf('_');
+        if (groupName.startsWith('p') && separator > 1) {
+            bool ok = false;
+            const int rule = groupName.mid(1, separator - 1).toInt(&ok);
+            if (ok) {
+                m_groupRules[group] = rule;
+            }
+        }
+    }
+}
+
+int TargetMatcher::match(const ProcessEntry &process, const QString &parentName) const
+{
+    const int exact = m_exactNames.value(ProcessSnapshot::foldName(process.name), -1);
+    if (exact >= 0) {
+        return exact;
+    }
+
+    if (!m_groupRules.isEmpty()) {
+        const QRegularExpressionMatch result = m_patterns.match(process.name);
+        if (result.hasMatch()) {
+            for (int group = 1; group <= result.lastCapturedIndex(); ++group) {
+                if (m_groupRules.value(group, -1) >= 0 && result.hasCaptured(group)) {
+                    return m_groupRules.at(group);
+                }
+            }
+        }
+    }
+
+    if (!parentName.isEmpty() && !m_parentServices.isEmpty()) {
+        const int service = m_parentServices.value(ProcessSnapshot::foldName(parentName), -1);
+        if (service >= 0) {
+            return service;
+        }
+    }
+
+    return m_hashes.isEmpty() || m_hashPaths.pattern().isEmpty() ? -1 : matchHash(process);
+}
+
+QList<TargetMatch> TargetMatcher::matchAll(const ProcessSnapshot &snapshot) const
+{
+    QList<TargetMatch> matches;
+    const QList<ProcessEntry> processes = snapshot.entries();
+    for (const ProcessEntry &process : processes) {
+        QString parentName;
+        if (!m_parentServices.isEmpty()) {
+            if (const ProcessEntry *parent = snapshot.parentOf(process)) {
+                parentName = parent->name;
+            }
+        }
+        const int rule = match(process, parentName);
+        if (rule >= 0) {
+            TargetMatch match;
+            match.rule = rule;
+            match.process = process;
+            matches.append(match);
+        }
+    }
+    if (!m_hashes.isEmpty()) {
+        // 已退出进程的指纹结果不再需要（PID 被复用时也不会误用：结果按启动时间与映像名核对）
+        QMutexLocker locker(&m_hashCacheMutex);
+        m_verdicts.removeIf([&snapshot](QHash<qint64, HashVerdict>::iterator it) {
+            return !snapshot.process(it.key());
+        });
+    }
+    return matches;
+}
+
+int TargetMatcher::matchGuardian(const ProcessEntry &process) const
+{
+    return m_guardians.isEmpty() ? -1 : m_guardians.value(ProcessSnapshot::foldName(process.name), -1);
+}
+
+int TargetMatcher::matchHash(const ProcessEntry &process) const
+{
+    {
+        QMutexLocker locker(&m_hashCacheMutex);
+        const auto verdict = m_verdicts.constFind(process.pid);
+        if (verdict != m_verdicts.constEnd() && verdict->startTime == process.startTime && verdict->name == process.name) {
+            return verdict->rule;
+        }
+    }
+    HashVerdict verdict;
+    verdict.startTime = process.startTime;
+    verdict.name = process.name;
+    verdict.rule = hashExecutable(process);
+    QMutexLocker locker(&m_hashCacheMutex);
+    m_verdicts.insert(process.pid, verdict);
+    return verdict.rule;
+}
+
+int TargetMatcher::hashExecutable(const ProcessEntry &process) const
+{
+    const QString path = ProcessSnapshot::executablePath(process.pid);
+    // 先按候选路径筛选，绝大多数进程在这里就被排除，不读取文件
+    if (path.isEmpty() || !m_hashPaths.match(QDir::fromNativeSeparators(path)).hasMatch()) {
+        return -1;
+    }
+    // 先按文件大小预筛选，只有大小吻合的文件才需要计算哈希
+    const QFileInfo info(path);
+    if (!m_hashSizes.contains(-1) && !m_hashSizes.contains(info.size())) {
+        return -1;
+    }
+
+    const QString key = QString("%1|%2|%3").arg(path).arg(info.size()).arg(info.lastModified().toMSecsSinceEpoch());
+    QByteArray digest;
+    {
+        QMutexLocker locker(&m_hashCacheMutex);
+        digest = m_hashCache.value(key);
+    }
+    if (digest.isEmpty()) {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly)) {
+            return -1;
+        }
+        QCryptographicHash hash(QCryptographicHash::Sha256);
+        hash.addData(&file);
+        digest = hash.result().toHex();
+        QMutexLocker locker(&m_hashCacheMutex);
+        m_hashCache.insert(key, digest);
+    }
+    return m_hashes.value(digest, -1);
+}
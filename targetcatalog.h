@@ -0,0 +1,116 @@
+#ifndef TARGETCATALOG_H
+#define TARGETCATALOG_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QRegularExpression>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include "processsnapshot.h"
+
+// 可执行文件指纹（文件大小用于预筛选，避免对每个进程都计算哈希）
+struct ExecutableHash
+{
+    QByteArray sha256;   // 小写十六进制
+    qint64 size = -1;    // -1 表示不限大小
+};
+
+// 一款电子教室产品的识别规则
+struct TargetRule
+{
+    // 关闭客户端之前对守护进程的处理方式
+    enum GuardianAction {
+        SuspendGuardian,  // 挂起（默认）：不再拉起客户端，服务管理器也不会因其退出而触发重启
+        KillGuardian      // 终止
+    };
+
+    QString product;                  // 教室软件名称
+    QStringList names;                // 精确映像名（大小写不敏感）
+    QStringList patterns;             // 通配符模式；以 "re:" 开头的按正则处理
+    QList<ExecutableHash> hashes;     // 可执行文件 SHA-256（改名后仍可识别）
+    QStringList hashPaths;            // 指纹的候选路径（通配符，匹配可执行文件完整路径，分隔符统一为 /）：只对命中的进程计算指纹
+    QStringList parentServices;       // 父进程（守护服务）映像名：其子进程视为该产品
+    QStringList guardians;            // 守护进程映像名：负责重新拉起客户端，全量关闭时先于客户端处理
+    GuardianAction guardianAction = SuspendGuardian;
+};
+
+// 目标目录：启动时从外部 JSON 文件加载，新增产品无需重新编译
+class TargetCatalog
+{
+public:
+    TargetCatalog() = default;
+
+    // 内置默认目录（外部文件缺失或损坏时使用）
+    static TargetCatalog builtin();
+    // 从 JSON 文件加载；失败返回空目录并给出错误信息
+    static TargetCatalog load(const QString &path, QString *errorString = nullptr);
+    // 程序目录下的 targets.json
+    static QString defaultPath();
+    // 优先加载 defaultPath()，失败时退回内置目录
+    static TargetCatalog loadDefault();
+
+    const QList<TargetRule> &rules() const { return m_rules; }
+    bool isEmpty() const { return m_rules.isEmpty(); }
+    void addRule(const TargetRule &rule) { m_rules.append(rule); }
+
+private:
+    QList<TargetRule> m_rules;
+};
+
+// 一次命中
+struct TargetMatch
+{
+    int rule = -1;           // TargetCatalog::rules() 下标
+    ProcessEntry process;
+};
+
+// 编译后的匹配器：精确名走哈希表（Qt 6 的 QHash 为开放寻址），所有模式合并为一个 JIT 正则，
+// 指纹只对路径命中 hashPaths 的进程计算：结果按进程（PID、启动时间、映像名）缓存，摘要按 (路径, 大小, 修改时间) 缓存，
+// 重复匹配同一批进程时不再查询路径或读取文件；可在多个线程中共享同一实例
+class TargetMatcher
+{
+public:
+    explicit TargetMatcher(const TargetCatalog &catalog = TargetCatalog());
+
+    const TargetCatalog &catalog() const { return m_catalog; }
+    const TargetRule &rule(int index) const { return m_catalog.rules().at(index); }
+
+    // 匹配单个进程，返回规则下标，未命中返回 -1；parentName 用于父服务规则
+    int match(const ProcessEntry &process, const QString &parentName = QString()) const;
+    // 对整份快照匹配（父进程名从同一快照中查找）
+    QList<TargetMatch> matchAll(const ProcessSnapshot &snapshot) const;
+    // 守护进程匹配（仅按 guardians 中的精确映像名），返回规则下标，未命中返回 -1
+    int matchGuardian(const ProcessEntry &process) const;
+    bool hasGuardians() const { return !m_guardians.isEmpty(); }
+
+private:
+    TargetCatalog m_catalog;
+    QHash<QString, int> m_exactNames;       // 折叠后的映像名 -> 规则
+    QHash<QString, int> m_parentServices;   // 折叠后的父进程映像名 -> 规则
+    QHash<QString, int> m_guardians;        // 折叠后的守护进程映像名 -> 规则
+    QRegularExpression m_patterns;          // ^(?:(?<p0>...)|(?<p1>...)|...)$
+    QList<int> m_groupRules;                // 捕获组序号 -> 规则（非本匹配器生成的组为 -1）
+    QHash<QByteArray, int> m_hashes;        // SHA-256 -> 规则
+    QSet<qint64> m_hashSizes;               // 需要计算指纹的文件大小（含 -1 表示全部）
+    QRegularExpression m_hashPaths;         // 所有规则的 hashPaths 合并后的正则
+
+    // 单个进程的指纹匹配结果
+    struct HashVerdict
+    {
+        quint64 startTime = 0;
+        QString name;
+        int rule = -1;
+    };
+
+    mutable QMutex m_hashCacheMutex;
+    mutable QHash<QString, QByteArray> m_hashCache;  // "路径|大小|修改时间" -> SHA-256
+    mutable QHash<qint64, HashVerdict> m_verdicts;   // PID -> 匹配结果（matchAll 时剔除已退出的进程）
+
+    int matchHash(const ProcessEntry &process) const;
+    int hashExecutable(const ProcessEntry &process) const;
+};
+
+#endif // TARGETCATALOG_H
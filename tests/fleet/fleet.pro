@@ -0,0 +1,11 @@
+# 机房协同：FleetProtocol 命令认证，回环地址上的协调端 → 节点往返与多节点并发汇总
+QT       = core network testlib
+CONFIG  += c++17 console testcase
+CONFIG  -= app_bundle
+
+TARGET = tst_fleet
+
+include(../../engine.pri)
+
+SOURCES += \
+    tst_fleet.cpp
@@ -0,0 +1,205 @@
+#include <QtTest>
+#include <QTcpServer>
+#include <memory>
+#include <vector>
+#include "fleet.h"
+
+namespace {
+
+const QByteArray kKey = "classroom-key";
+constexpr int kRunTimeoutMs = 5000;
+constexpr int kNodeCount = 4;
+
+QByteArray sampleNonce()
+{
+    return QByteArray(16, '\x5A');
+}
+
+} // namespace
+
+class FleetTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void macAcceptsMatchingCommand();
+    void macRejectsTampering();
+    void macRejectsEmpty();
+    void nodeWithoutKeyListensOnlyOnLoopback();
+    void loopbackDetect();
+    void loopbackRejectsWrongKey();
+    void loopbackRejectsMissingKey();
+    void aggregatesSeveralNodes();
+
+private:
+    // 在回环地址上启动一个节点并让协调端下发一条命令，返回该节点的结果
+    FleetNodeResult runOnLoopback(const QByteArray &nodeKey, const QByteArray &coordinatorKey, FleetCommand command);
+};
+
+void FleetTest::macAcceptsMatchingCommand()
+{
+    FleetCommandOptions options;
+    options.maxRounds = 7;
+    const QByteArray mac = FleetProtocol::commandMac(kKey, sampleNonce(), FleetCommand::Sweep, options);
+    QCOMPARE(mac.size(), 32);  // HMAC-SHA256
+    QVERIFY(FleetProtocol::verifyCommand(kKey, sampleNonce(), FleetCommand::Sweep, options, mac));
+}
+
+void FleetTest::macRejectsTampering()
+{
+    FleetCommandOptions options;
+    const QByteArray mac = FleetProtocol::commandMac(kKey, sampleNonce(), FleetCommand::Detect, options);
+
+    // 换了命令、参数、随机数或密钥都不能通过
+    QVERIFY(!FleetProtocol::verifyCommand(kKey, sampleNonce(), FleetCommand::Sweep, options, mac));
+    FleetCommandOptions changed = options;
+    changed.quietPeriodMs += 1;
+    QVERIFY(!FleetProtocol::verifyCommand(kKey, sampleNonce(), FleetCommand::Detect, changed, mac));
+    QVERIFY(!FleetProtocol::verifyCommand(kKey, QByteArray(16, '\x00'), FleetCommand::Detect, options, mac));
+    QVERIFY(!FleetProtocol::verifyCommand("other-key", sampleNonce(), FleetCommand::Detect, options, mac));
+
+    QByteArray flipped = mac;
+    flipped[flipped.size() - 1] = char(flipped.back() ^ 0x01);
+    QVERIFY(!FleetProtocol::verifyCommand(kKey, sampleNonce(), FleetCommand::Detect, options, flipped));
+    QVERIFY(!FleetProtocol::verifyCommand(kKey, sampleNonce(), FleetCommand::Detect, options, mac.left(16)));
+}
+
+void FleetTest::macRejectsEmpty()
+{
+    // 节点设置了密钥时，空认证码（未设置密钥的协调端）必须被拒绝
+    QVERIFY(!FleetProtocol::verifyCommand(kKey, sampleNonce(), FleetCommand::Detect, FleetCommandOptions(), QByteArray()));
+    // 节点未设置密钥时只接受空认证码
+    QVERIFY(FleetProtocol::verifyCommand(QByteArray(), sampleNonce(), FleetCommand::Detect, FleetCommandOptions(), QByteArray()));
+    const QByteArray mac = FleetProtocol::commandMac(kKey, sampleNonce(), FleetCommand::Detect, FleetCommandOptions());
+    QVERIFY(!FleetProtocol::verifyCommand(QByteArray(), sampleNonce(), FleetCommand::Detect, FleetCommandOptions(), mac));
+}
+
+void FleetTest::nodeWithoutKeyListensOnlyOnLoopback()
+{
+    {
+        FleetNode node{TargetCatalog()};
+        QString errorString;
+        QVERIFY(!node.listen("0.0.0.0", 0, &errorString));
+        QVERIFY(!errorString.isEmpty());
+    }
+    {
+        FleetNode node{TargetCatalog()};
+        QVERIFY(node.listen(QString(), 0));  // 默认改为回环地址
+    }
+    {
+        FleetNode node{TargetCatalog()};
+        node.setInsecure(true);
+        QVERIFY(node.listen("0.0.0.0", 0));
+    }
+    {
+        FleetNode node{TargetCatalog()};
+        node.setKey(kKey);
+        QVERIFY(node.listen("0.0.0.0", 0));
+    }
+}
+
+FleetNodeResult FleetTest::runOnLoopback(const QByteArray &nodeKey, const QByteArray &coordinatorKey, FleetCommand command)
+{
+    FleetNode node{TargetCatalog()};  // 空目录：检测结果为 0，不会触碰本机进程
+    node.setKey(nodeKey);
+    QString errorString;
+    if (!node.listen("127.0.0.1", 0, &errorString)) {
+        QTest::qFail(qPrintable(errorString), __FILE__, __LINE__);
+        return FleetNodeResult();
+    }
+
+    FleetCoordinator coordinator;
+    coordinator.setKey(coordinatorKey);
+    coordinator.setTimeout(kRunTimeoutMs);
+    QSignalSpy finished(&coordinator, &FleetCoordinator::finished);
+    FleetEndpoint endpoint;
+    endpoint.host = "127.0.0.1";
+    endpoint.port = node.port();
+    coordinator.run(QList<FleetEndpoint>{endpoint}, command);
+    if (!finished.wait(kRunTimeoutMs * 2) || coordinator.results().size() != 1) {
+        QTest::qFail("协调端未在时限内结束", __FILE__, __LINE__);
+        return FleetNodeResult();
+    }
+    return coordinator.results().first();
+}
+
+void FleetTest::loopbackDetect()
+{
+    const FleetNodeResult result = runOnLoopback(kKey, kKey, FleetCommand::Detect);
+    QVERIFY2(result.error.isEmpty(), qPrintable(result.error));
+    QVERIFY(result.completed);
+    QCOMPARE(int(result.status.state), int(FleetStatus::Finished));
+    QCOMPARE(result.status.found, quint32(0));
+    QVERIFY(!result.status.watching);
+    QVERIFY(!result.hostName.isEmpty());
+}
+
+void FleetTest::loopbackRejectsWrongKey()
+{
+    const FleetNodeResult result = runOnLoopback(kKey, "wrong-key", FleetCommand::Detect);
+    QVERIFY(result.completed);
+    QCOMPARE(int(result.status.state), int(FleetStatus::Rejected));
+    QVERIFY(!result.error.isEmpty());
+}
+
+void FleetTest::loopbackRejectsMissingKey()
+{
+    const FleetNodeResult result = runOnLoopback(kKey, QByteArray(), FleetCommand::Detect);
+    QVERIFY(result.completed);
+    QCOMPARE(int(result.status.state), int(FleetStatus::Rejected));
+}
+
+void FleetTest::aggregatesSeveralNodes()
+{
+    // 多个节点同时在回环地址上监听，另有一个无人监听的端口（连接被拒绝）
+    std::vector<std::unique_ptr<FleetNode>> nodes;
+    QList<FleetEndpoint> endpoints;
+    for (int i = 0; i < kNodeCount; ++i) {
+        nodes.push_back(std::make_unique<FleetNode>(TargetCatalog()));
+        nodes.back()->setKey(kKey);
+        QVERIFY(nodes.back()->listen("127.0.0.1", 0));
+        FleetEndpoint endpoint;
+        endpoint.host = "127.0.0.1";
+        endpoint.port = nodes.back()->port();
+        endpoints.append(endpoint);
+    }
+    FleetEndpoint dead;
+    dead.host = "127.0.0.1";
+    {
+        QTcpServer placeholder;
+        QVERIFY(placeholder.listen(QHostAddress::LocalHost, 0));
+        dead.port = placeholder.serverPort();
+    }
+    const int deadIndex = kNodeCount / 2;
+    endpoints.insert(deadIndex, dead);
+
+    FleetCoordinator coordinator;
+    coordinator.setKey(kKey);
+    coordinator.setTimeout(kRunTimeoutMs);
+    QSignalSpy finished(&coordinator, &FleetCoordinator::finished);
+    QElapsedTimer timer;
+    timer.start();
+    coordinator.run(endpoints, FleetCommand::Detect);
+    QVERIFY(finished.wait(kRunTimeoutMs * 2));
+    // 失败的节点不拖慢其他节点：整条命令远早于时限结束
+    QVERIFY2(timer.elapsed() < kRunTimeoutMs, qPrintable(QString("耗时 %1 毫秒").arg(timer.elapsed())));
+
+    const QList<FleetNodeResult> &results = coordinator.results();
+    QCOMPARE(results.size(), endpoints.size());
+    for (int i = 0; i < results.size(); ++i) {
+        const FleetNodeResult &result = results.at(i);
+        QCOMPARE(result.endpoint.port, endpoints.at(i).port);
+        if (i == deadIndex) {
+            QVERIFY(!result.completed);
+            QVERIFY(!result.error.isEmpty());
+            continue;
+        }
+        QVERIFY2(result.error.isEmpty(), qPrintable(result.error));
+        QVERIFY(result.completed);
+        QCOMPARE(int(result.status.state), int(FleetStatus::Finished));
+        QVERIFY(result.latencyMs < kRunTimeoutMs);
+    }
+}
+
+QTEST_GUILESS_MAIN(FleetTest)
+#include "tst_fleet.moc"
@@ -0,0 +1,12 @@
+# 特权助手协议：MessageFrame 分帧与 ElevatedHelper 请求/响应编解码；
+# Linux 上以同一用户在临时套接字启动助手，核对目录授权、PID 复用与助手后端的转交合并
+QT       = core network testlib
+CONFIG  += c++17 console testcase
+CONFIG  -= app_bundle
+
+TARGET = tst_helperprotocol
+
+include(../../engine.pri)
+
+SOURCES += \
+    tst_helperprotocol.cpp
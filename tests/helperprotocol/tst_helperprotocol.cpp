@@ -0,0 +1,395 @@
+#include <QtTest>
+#include <QDataStream>
+#include <QMutex>
+#include <QProcess>
+#include <QSemaphore>
+#include <QTemporaryDir>
+#include <memory>
+#include "elevatedhelper.h"
+#include "messageframe.h"
+
+#if defined(Q_OS_LINUX)
+#include <cerrno>
+#include <csignal>
+#endif
+
+namespace {
+
+// 请求头各字段的偏移：magic(4) version(2) operation(1) count(4)
+constexpr int kVersionOffset = 4;
+constexpr int kCountOffset = 7;
+
+QList<ProcessEntry> sampleProcesses()
+{
+    QList<ProcessEntry> processes;
+    for (qint64 pid : {qint64(1), qint64(4242), qint64(0x7FFFFFFF)}) {
+        ProcessEntry process;
+        process.pid = pid;
+        process.startTime = quint64(pid) * 1000003ULL + 133500000000000000ULL;  // 覆盖 FILETIME 量级
+        processes.append(process);
+    }
+    return processes;
+}
+
+void writeUInt32(QByteArray &payload, int offset, quint32 value)
+{
+    QByteArray bytes;
+    QDataStream stream(&bytes, QIODevice::WriteOnly);
+    stream << value;
+    payload.replace(offset, bytes.size(), bytes);
+}
+
+constexpr int kHelperTimeoutMs = 3000;
+
+// 在独立线程中运行助手服务端：ElevatedHelper::request 会阻塞调用线程
+class HelperServerThread : public QThread
+{
+public:
+    HelperServerThread(const TargetCatalog &catalog, const QString &name)
+        : m_catalog(catalog)
+        , m_name(name)
+    {
+    }
+
+    ~HelperServerThread() override
+    {
+        quit();
+        wait();
+    }
+
+    bool waitListening()
+    {
+        m_ready.acquire();
+        return m_listening;
+    }
+
+    QStringList logs() const
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_logs;
+    }
+
+protected:
+    void run() override
+    {
+        ElevatedHelperServer server(m_catalog);
+        QObject::connect(&server, &ElevatedHelperServer::logUpdated, [this](const QString &log) {
+            QMutexLocker locker(&m_mutex);
+            m_logs.append(log);
+        });
+        m_listening = server.listen(m_name) == ElevatedHelperServer::Listening;
+        m_ready.release();
+        if (m_listening) {
+            exec();
+        }
+    }
+
+private:
+    TargetCatalog m_catalog;
+    QString m_name;
+    QSemaphore m_ready;
+    bool m_listening = false;
+    mutable QMutex m_mutex;
+    QStringList m_logs;
+};
+
+// 只把 sleep 当作目标的目录：测试中以 sleep 子进程充当电子教室
+TargetCatalog sleepCatalog()
+{
+    TargetRule rule;
+    rule.product = QStringLiteral("测试目标");
+    rule.names = QStringList{QStringLiteral("sleep")};
+    TargetCatalog catalog;
+    catalog.addRule(rule);
+    return catalog;
+}
+
+} // namespace
+
+class HelperProtocolTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void frameRoundTrip();
+    void frameAcrossChunks();
+    void frameRejectsOversized();
+    void requestRoundTrip_data();
+    void requestRoundTrip();
+    void requestRejectsBadMagic();
+    void requestRejectsBadVersion();
+    void requestRejectsBadOperation();
+    void requestRejectsBadCount();
+    void requestRejectsTrailingBytes();
+    void responseRoundTrip();
+    void initTestCase();
+    void cleanupTestCase();
+    void serverActsOnlyOnTargets();
+    void terminatorForwardsOnlyDeniedProcesses();
+
+private:
+    QTemporaryDir m_socketDirectory;
+    std::unique_ptr<HelperServerThread> m_server;
+};
+
+void HelperProtocolTest::frameRoundTrip()
+{
+    const QByteArray payload = ElevatedHelper::encodeRequest(ElevatedHelper::Terminate, sampleProcesses());
+    QByteArray buffer = MessageFrame::wrap(payload) + MessageFrame::wrap(QByteArray("second"));
+    QByteArray taken;
+    bool invalid = false;
+    QVERIFY(MessageFrame::take(buffer, taken, invalid));
+    QVERIFY(!invalid);
+    QCOMPARE(taken, payload);
+    QVERIFY(MessageFrame::take(buffer, taken, invalid));
+    QCOMPARE(taken, QByteArray("second"));
+    QVERIFY(buffer.isEmpty());
+    QVERIFY(!MessageFrame::take(buffer, taken, invalid));
+    QVERIFY(!invalid);
+}
+
+void HelperProtocolTest::frameAcrossChunks()
+{
+    const QByteArray frame = MessageFrame::wrap(QByteArray(300, 'x'));
+    QByteArray buffer;
+    QByteArray taken;
+    bool invalid = false;
+    // 逐字节到达：直到最后一个字节之前都不应取出
+    for (int i = 0; i < frame.size() - 1; ++i) {
+        buffer.append(frame.at(i));
+        QVERIFY(!MessageFrame::take(buffer, taken, invalid));
+        QVERIFY(!invalid);
+    }
+    buffer.append(frame.back());
+    QVERIFY(MessageFrame::take(buffer, taken, invalid));
+    QCOMPARE(taken, QByteArray(300, 'x'));
+}
+
+void HelperProtocolTest::frameRejectsOversized()
+{
+    QByteArray buffer = MessageFrame::wrap(QByteArray(64, 'x'));
+    QByteArray taken;
+    bool invalid = false;
+    QVERIFY(!MessageFrame::take(buffer, taken, invalid, 16));
+    QVERIFY(invalid);
+}
+
+void HelperProtocolTest::requestRoundTrip_data()
+{
+    QTest::addColumn<int>("operation");
+    QTest::addColumn<int>("count");
+    QTest::newRow("terminate") << int(ElevatedHelper::Terminate) << 3;
+    QTest::newRow("suspend") << int(ElevatedHelper::Suspend) << 1;
+    QTest::newRow("resume-empty") << int(ElevatedHelper::Resume) << 0;
+}
+
+void HelperProtocolTest::requestRoundTrip()
+{
+    QFETCH(int, operation);
+    QFETCH(int, count);
+    const QList<ProcessEntry> processes = sampleProcesses().mid(0, count);
+    const QByteArray payload = ElevatedHelper::encodeRequest(ElevatedHelper::Operation(operation), processes);
+
+    ElevatedHelper::Operation decodedOperation = ElevatedHelper::Terminate;
+    QList<ProcessEntry> decoded;
+    QVERIFY(ElevatedHelper::decodeRequest(payload, decodedOperation, decoded));
+    QCOMPARE(int(decodedOperation), operation);
+    QCOMPARE(decoded.size(), processes.size());
+    for (int i = 0; i < processes.size(); ++i) {
+        QCOMPARE(decoded.at(i).pid, processes.at(i).pid);
+        QCOMPARE(decoded.at(i).startTime, processes.at(i).startTime);
+    }
+}
+
+void HelperProtocolTest::requestRejectsBadMagic()
+{
+    QByteArray payload = ElevatedHelper::encodeRequest(ElevatedHelper::Terminate, sampleProcesses());
+    payload[0] = char(payload.at(0) ^ 0x01);
+    ElevatedHelper::Operation operation;
+    QList<ProcessEntry> processes;
+    QVERIFY(!ElevatedHelper::decodeRequest(payload, operation, processes));
+}
+
+void HelperProtocolTest::requestRejectsBadVersion()
+{
+    QByteArray payload = ElevatedHelper::encodeRequest(ElevatedHelper::Terminate, sampleProcesses());
+    payload[kVersionOffset + 1] = char(payload.at(kVersionOffset + 1) + 1);
+    ElevatedHelper::Operation operation;
+    QList<ProcessEntry> processes;
+    QVERIFY(!ElevatedHelper::decodeRequest(payload, operation, processes));
+}
+
+void HelperProtocolTest::requestRejectsBadOperation()
+{
+    QByteArray payload = ElevatedHelper::encodeRequest(ElevatedHelper::Terminate, sampleProcesses());
+    ElevatedHelper::Operation operation;
+    QList<ProcessEntry> processes;
+    for (char code : {char(0), char(ElevatedHelper::Resume + 1), char(0xFF)}) {
+        payload[kCountOffset - 1] = code;
+        QVERIFY(!ElevatedHelper::decodeRequest(payload, operation, processes));
+    }
+}
+
+void HelperProtocolTest::requestRejectsBadCount()
+{
+    const QByteArray valid = ElevatedHelper::encodeRequest(ElevatedHelper::Terminate, sampleProcesses());
+    ElevatedHelper::Operation operation;
+    QList<ProcessEntry> processes;
+
+    // 声明的数量多于实际携带的条目
+    QByteArray payload = valid;
+    writeUInt32(payload, kCountOffset, 4);
+    QVERIFY(!ElevatedHelper::decodeRequest(payload, operation, processes));
+
+    // 超过单批上限：不应按声明的数量预分配
+    payload = valid;
+    writeUInt32(payload, kCountOffset, 0xFFFFFFFF);
+    QVERIFY(!ElevatedHelper::decodeRequest(payload, operation, processes));
+
+    // 截断在条目中间
+    QVERIFY(!ElevatedHelper::decodeRequest(valid.left(valid.size() - 3), operation, processes));
+}
+
+void HelperProtocolTest::requestRejectsTrailingBytes()
+{
+    const QByteArray payload = ElevatedHelper::encodeRequest(ElevatedHelper::Suspend, sampleProcesses()) + QByteArray(1, '\0');
+    ElevatedHelper::Operation operation;
+    QList<ProcessEntry> processes;
+    QVERIFY(!ElevatedHelper::decodeRequest(payload, operation, processes));
+}
+
+void HelperProtocolTest::responseRoundTrip()
+{
+    QList<KillResult> results;
+    KillResult done;
+    done.pid = 4242;
+    done.success = true;
+    done.exitStatus = 0;
+    results.append(done);
+    KillResult denied;
+    denied.pid = 7;
+    denied.errorCode = 5;
+    results.append(denied);
+
+    QList<KillResult> decoded;
+    QVERIFY(ElevatedHelper::decodeResponse(ElevatedHelper::encodeResponse(results), decoded));
+    QCOMPARE(decoded.size(), 2);
+    QCOMPARE(decoded.at(0).pid, qint64(4242));
+    QVERIFY(decoded.at(0).success);
+    QCOMPARE(decoded.at(1).pid, qint64(7));
+    QVERIFY(!decoded.at(1).success);
+    QCOMPARE(decoded.at(1).errorCode, 5);
+
+    QByteArray corrupted = ElevatedHelper::encodeResponse(results);
+    corrupted[0] = char(corrupted.at(0) ^ 0x01);
+    QVERIFY(!ElevatedHelper::decodeResponse(corrupted, decoded));
+}
+
+void HelperProtocolTest::initTestCase()
+{
+#if defined(Q_OS_LINUX)
+    // 同一用户的助手：临时目录下的套接字，客户端与服务端走与部署时相同的连接与身份校验
+    QVERIFY(m_socketDirectory.isValid());
+    const QString name = m_socketDirectory.filePath("helper");
+    ElevatedHelper::setServerName(name);
+    m_server = std::make_unique<HelperServerThread>(sleepCatalog(), name);
+    m_server->start();
+    QVERIFY(m_server->waitListening());
+#endif
+}
+
+void HelperProtocolTest::cleanupTestCase()
+{
+    m_server.reset();
+    ElevatedHelper::setServerName(QString());
+}
+
+void HelperProtocolTest::serverActsOnlyOnTargets()
+{
+#if !defined(Q_OS_LINUX)
+    QSKIP("回环测试只在 Linux 上以同一用户运行助手");
+#else
+    QProcess target;
+    target.start("sleep", {"30"});
+    QProcess unrelated;  // 父进程是测试程序本身，不是目标的子孙
+    unrelated.start("cat", QStringList());
+    QVERIFY(target.waitForStarted(kHelperTimeoutMs));
+    QVERIFY(unrelated.waitForStarted(kHelperTimeoutMs));
+    // 等 exec 完成，映像名变为 sleep/cat
+    QTest::qWait(50);
+
+    ProcessEntry targetEntry;
+    ProcessEntry unrelatedEntry;
+    QVERIFY(ProcessSnapshot::readProcess(target.processId(), targetEntry));
+    QVERIFY(ProcessSnapshot::readProcess(unrelated.processId(), unrelatedEntry));
+    QCOMPARE(targetEntry.name, QString("sleep"));
+    ProcessEntry stale = targetEntry;
+    stale.startTime += 1;  // PID 已被复用的情形
+
+    QString errorString;
+    const QList<KillResult> results = ElevatedHelper::request(ElevatedHelper::Terminate, {stale, unrelatedEntry, targetEntry},
+                                                              kHelperTimeoutMs, CancellationToken(), &errorString);
+    QVERIFY2(results.size() == 3, qPrintable(errorString));
+
+    // 启动时间不符：按进程不存在处理，不触碰当前占用该 PID 的进程
+    QCOMPARE(results.at(0).pid, stale.pid);
+    QCOMPARE(results.at(0).errorCode, ESRCH);
+    // 非目标进程：拒绝
+    QCOMPARE(results.at(1).pid, unrelatedEntry.pid);
+    QVERIFY(!results.at(1).success);
+    QCOMPARE(results.at(1).errorCode, EPERM);
+    QVERIFY(ElevatedHelper::isPermissionError(results.at(1)));
+    // 目标进程：终止
+    QCOMPARE(results.at(2).pid, targetEntry.pid);
+    QVERIFY(results.at(2).success);
+    QCOMPARE(results.at(2).errorCode, 0);
+
+    QVERIFY(target.waitForFinished(kHelperTimeoutMs));
+    QCOMPARE(unrelated.state(), QProcess::Running);
+    unrelated.kill();
+    unrelated.waitForFinished(kHelperTimeoutMs);
+#endif
+}
+
+void HelperProtocolTest::terminatorForwardsOnlyDeniedProcesses()
+{
+#if !defined(Q_OS_LINUX)
+    QSKIP("回环测试只在 Linux 上以同一用户运行助手");
+#else
+    // 需要一个本进程无权发送信号的进程：非 root 时 PID 1 属于 root
+    if (::kill(1, 0) == 0 || errno != EPERM) {
+        QSKIP("以 root 运行或 PID 1 属于当前用户，无法构造权限不足的进程");
+    }
+    QProcess own;
+    own.start("sleep", {"30"});
+    QVERIFY(own.waitForStarted(kHelperTimeoutMs));
+    QTest::qWait(50);
+    ProcessEntry ownEntry;
+    ProcessEntry initEntry;
+    QVERIFY(ProcessSnapshot::readProcess(own.processId(), ownEntry));
+    QVERIFY(ProcessSnapshot::readProcess(1, initEntry));
+
+    // 恢复（SIGCONT）对运行中的进程没有副作用：本进程的子进程直接成功，PID 1 权限不足后整批转交助手，
+    // 助手按目录拒绝，结果按原顺序合并回来
+    HelperProcessTerminator terminator;
+    const int logsBefore = int(m_server->logs().size());
+    const QList<KillResult> results = terminator.resumeAll({ownEntry, initEntry});
+    QCOMPARE(results.size(), 2);
+    QCOMPARE(results.at(0).pid, ownEntry.pid);
+    QVERIFY(results.at(0).success);
+    QCOMPARE(results.at(1).pid, qint64(1));
+    QVERIFY(!results.at(1).success);
+    QCOMPARE(results.at(1).errorCode, EPERM);
+
+    // 只有 PID 1 到达了助手
+    const QStringList logs = m_server->logs().mid(logsBefore);
+    QCOMPARE(logs.size(), 1);
+    QVERIFY2(logs.first().contains("PID：1）"), qPrintable(logs.first()));
+
+    own.kill();
+    own.waitForFinished(kHelperTimeoutMs);
+#endif
+}
+
+QTEST_GUILESS_MAIN(HelperProtocolTest)
+#include "tst_helperprotocol.moc"
@@ -0,0 +1,11 @@
+# 进程表缓存：增量刷新只解析变化的进程，守护模式轮询的稳态开销不超出预算
+QT       = core testlib
+CONFIG  += c++17 console testcase
+CONFIG  -= app_bundle
+
+TARGET = tst_processsnapshot
+
+include(../../engine.pri)
+
+SOURCES += \
+    tst_processsnapshot.cpp
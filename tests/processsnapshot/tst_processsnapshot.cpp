@@ -0,0 +1,137 @@
+#include <QtTest>
+#include <QProcess>
+#include "processsnapshot.h"
+#include "processwatchdog.h"
+
+namespace {
+
+// 守护模式增量比对的 CPU 预算（单核百分比）
+constexpr double kBudgetPercent = 0.5;
+constexpr int kSamples = 50;
+constexpr int kChildTimeoutMs = 3000;
+
+bool containsPid(const QList<ProcessEntry> &processes, qint64 pid, const QString &name = QString())
+{
+    for (const ProcessEntry &process : processes) {
+        if (process.pid == pid && (name.isEmpty() || process.name == name)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+double medianUs(ProcessTableCache &cache, int samples)
+{
+    QList<double> durations;
+    QElapsedTimer timer;
+    for (int i = 0; i < samples; ++i) {
+        timer.start();
+        cache.refresh();
+        durations.append(timer.nsecsElapsed() / 1000.0);
+    }
+    std::sort(durations.begin(), durations.end());
+    return durations.at(durations.size() / 2);
+}
+
+} // namespace
+
+class ProcessSnapshotTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void refreshParsesOnlyNewProcesses();
+    void refreshReportsAddedAndRemoved();
+    void refreshNoticesExecOfNewProcess();
+    void pollingWithinBudget();
+};
+
+void ProcessSnapshotTest::refreshParsesOnlyNewProcesses()
+{
+    ProcessTableCache cache;
+    const ProcessSnapshot initial = cache.refresh();
+    QVERIFY(!initial.isEmpty());
+
+    // 已知进程不再读取 stat：读取次数只等于新出现的进程数
+    QList<ProcessEntry> added;
+    cache.refresh(&added);
+    QCOMPARE(cache.lastParsed(), int(added.size()));
+}
+
+void ProcessSnapshotTest::refreshReportsAddedAndRemoved()
+{
+#if !defined(Q_OS_LINUX)
+    QSKIP("需要 sleep 命令");
+#endif
+    ProcessTableCache cache;
+    cache.refresh();
+
+    QProcess child;
+    child.start("sleep", {"30"});
+    QVERIFY(child.waitForStarted(kChildTimeoutMs));
+    QList<ProcessEntry> added;
+    cache.refresh(&added);
+    QVERIFY(containsPid(added, child.processId()));
+    QVERIFY(cache.snapshot().process(child.processId()));
+
+    const qint64 pid = child.processId();
+    child.kill();
+    QVERIFY(child.waitForFinished(kChildTimeoutMs));
+    QList<ProcessEntry> removed;
+    cache.refresh(nullptr, &removed);
+    QVERIFY(containsPid(removed, pid));
+    QVERIFY(!cache.snapshot().process(pid));
+}
+
+void ProcessSnapshotTest::refreshNoticesExecOfNewProcess()
+{
+#if !defined(Q_OS_LINUX)
+    QSKIP("只有 Linux 的 exec 不改变 /proc/<pid> 的 inode");
+#endif
+    ProcessTableCache cache;
+    cache.setRevalidateInterval(60 * 60 * 1000);  // 排除全量复核，只验证新进程的逐次复核
+    cache.refresh();
+
+    // exec 之后 PID 不变、映像名变为 sleep（与 Wine 启动后改名相同）
+    QProcess child;
+    child.start("sh", {"-c", "sleep 0.2; exec sleep 30"});
+    QVERIFY(child.waitForStarted(kChildTimeoutMs));
+    QList<ProcessEntry> added;
+    cache.refresh(&added);
+    QVERIFY(containsPid(added, child.processId(), "sh"));
+
+    bool renamed = false;
+    QElapsedTimer timer;
+    timer.start();
+    while (!renamed && timer.elapsed() < 900) {
+        QTest::qWait(20);
+        added.clear();
+        cache.refresh(&added);
+        renamed = containsPid(added, child.processId(), "sleep");
+    }
+    child.kill();
+    child.waitForFinished(kChildTimeoutMs);
+    QVERIFY(renamed);
+}
+
+void ProcessSnapshotTest::pollingWithinBudget()
+{
+    ProcessTableCache cache;
+    cache.refresh();
+    const double refreshUs = medianUs(cache, kSamples);
+    cache.setRevalidateInterval(0);
+    const double revalidateUs = medianUs(cache, kSamples / 5);
+
+    // 稳态每次轮询只读一次目录，已知进程的复核按默认间隔摊入
+    const double percent = refreshUs / (ProcessWatchdog::kPollIntervalMs * 10.0)
+        + revalidateUs / (ProcessTableCache::kDefaultRevalidateIntervalMs * 10.0);
+    QVERIFY2(percent < kBudgetPercent,
+             qPrintable(QString("稳态开销 %1%（刷新 %2 微秒，复核 %3 微秒，进程数 %4）")
+                            .arg(percent, 0, 'f', 3)
+                            .arg(refreshUs, 0, 'f', 1)
+                            .arg(revalidateUs, 0, 'f', 1)
+                            .arg(cache.snapshot().size())));
+}
+
+QTEST_GUILESS_MAIN(ProcessSnapshotTest)
+#include "tst_processsnapshot.moc"
@@ -0,0 +1,9 @@
+# 单元测试（QtTest）：qmake tests.pro && make && make check
+# 每个子目录一个测试程序，与 jiyu、jiyu-cli 一样直接编译被测源码（引擎部分通过 engine.pri）
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    fleet \
+    helperprotocol \
+    processsnapshot \
+    versionchecker
@@ -0,0 +1,202 @@
+#include <QtTest>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTemporaryDir>
+#include "versionchecker.h"
+
+namespace {
+
+constexpr int kSignalTimeoutMs = 5000;
+
+// 最小的 HTTP 服务器：每个连接读完请求头后按预设状态应答，记录收到的请求头
+class VersionServer
+{
+public:
+    VersionServer()
+    {
+        QObject::connect(&m_server, &QTcpServer::newConnection, &m_server, [this]() {
+            while (QTcpSocket *socket = m_server.nextPendingConnection()) {
+                QObject::connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+                QObject::connect(socket, &QTcpSocket::readyRead, socket, [this, socket]() {
+                    m_buffer[socket] += socket->readAll();
+                    if (!m_buffer.value(socket).contains("\r\n\r\n")) {
+                        return;
+                    }
+                    requests.append(m_buffer.take(socket));
+                    socket->write(response());
+                    socket->disconnectFromHost();
+                });
+            }
+        });
+    }
+
+    bool listen() { return m_server.listen(QHostAddress::LocalHost, 0); }
+    void close() { m_server.close(); }
+    QUrl url() const { return QUrl(QString("http://127.0.0.1:%1/jiyu.txt").arg(m_server.serverPort())); }
+
+    int status = 200;
+    QByteArray body;
+    QByteArray etag;
+    QList<QByteArray> requests;
+
+private:
+    QTcpServer m_server;
+    QHash<QTcpSocket *, QByteArray> m_buffer;
+
+    QByteArray response() const
+    {
+        const QByteArray content = status == 200 ? body : QByteArray();
+        QByteArray reply = "HTTP/1.1 " + QByteArray::number(status) + (status == 200 ? " OK" : status == 304 ? " Not Modified" : " Not Found");
+        reply += "\r\nContent-Length: " + QByteArray::number(content.size());
+        if (!etag.isEmpty()) {
+            reply += "\r\nETag: " + etag;
+        }
+        reply += "\r\nConnection: close\r\n\r\n" + content;
+        return reply;
+    }
+};
+
+} // namespace
+
+class VersionCheckerTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void environmentOverridesUrl();
+    void reportsNewerVersion();
+    void reportsNoUpdate();
+    void revalidatesWithEtag();
+    void treatsHttpErrorAsOnline();
+    void reportsOffline();
+
+private:
+    QTemporaryDir m_cacheDirectory;
+    QString cachePath() const { return m_cacheDirectory.filePath("versioncheck.json"); }
+};
+
+void VersionCheckerTest::init()
+{
+    QVERIFY(m_cacheDirectory.isValid());
+    QFile::remove(cachePath());
+}
+
+void VersionCheckerTest::environmentOverridesUrl()
+{
+    qputenv("JIYU_UPDATE_URL", "http://127.0.0.1:1/override.txt");
+    VersionChecker checker;
+    qunsetenv("JIYU_UPDATE_URL");
+    QCOMPARE(checker.updateUrl(), QUrl("http://127.0.0.1:1/override.txt"));
+}
+
+void VersionCheckerTest::reportsNewerVersion()
+{
+    VersionServer server;
+    QVERIFY(server.listen());
+    server.body = "2.5.0\n";
+    server.etag = "\"v250\"";
+
+    // 与部署时一样通过环境变量指向本地服务器
+    qputenv("JIYU_UPDATE_URL", server.url().toEncoded());
+    VersionChecker checker;
+    qunsetenv("JIYU_UPDATE_URL");
+    checker.setCachePath(cachePath());
+    QSignalSpy online(&checker, &VersionChecker::serverOnline);
+    QSignalSpy newer(&checker, &VersionChecker::newVersionAvailable);
+    checker.check("2.4.1");
+
+    QVERIFY(newer.wait(kSignalTimeoutMs));
+    QCOMPARE(newer.first().first().toString(), QString("2.5.0"));
+    QCOMPARE(online.size(), 1);
+    QCOMPARE(server.requests.size(), 1);
+    QVERIFY(QFile::exists(cachePath()));
+}
+
+void VersionCheckerTest::reportsNoUpdate()
+{
+    VersionServer server;
+    QVERIFY(server.listen());
+    server.body = "2.4.1";
+
+    VersionChecker checker;
+    checker.setUpdateUrl(server.url());
+    checker.setCachePath(cachePath());
+    QSignalSpy noUpdate(&checker, &VersionChecker::noUpdatesAvailable);
+    QSignalSpy newer(&checker, &VersionChecker::newVersionAvailable);
+    checker.check("2.4.1");
+
+    QVERIFY(noUpdate.wait(kSignalTimeoutMs));
+    QCOMPARE(newer.size(), 0);
+}
+
+void VersionCheckerTest::revalidatesWithEtag()
+{
+    VersionServer server;
+    QVERIFY(server.listen());
+    server.body = "3.0";
+    server.etag = "\"v300\"";
+    {
+        VersionChecker first;
+        first.setUpdateUrl(server.url());
+        first.setCachePath(cachePath());
+        QSignalSpy newer(&first, &VersionChecker::newVersionAvailable);
+        first.check("2.0");
+        QVERIFY(newer.wait(kSignalTimeoutMs));
+    }
+
+    // 缓存已过期：先按缓存应答，再带 If-None-Match 重新验证；304 不再重复发出版本信号
+    server.status = 304;
+    VersionChecker second;
+    second.setUpdateUrl(server.url());
+    second.setCachePath(cachePath());
+    second.setCacheTtl(0);
+    QSignalSpy newer(&second, &VersionChecker::newVersionAvailable);
+    QSignalSpy online(&second, &VersionChecker::serverOnline);
+    second.check("2.0");
+    QTRY_COMPARE_WITH_TIMEOUT(server.requests.size(), 2, kSignalTimeoutMs);
+    QVERIFY(server.requests.at(1).toLower().contains("if-none-match: \"v300\""));
+    QTest::qWait(200);  // 让 304 应答处理完
+    QCOMPARE(newer.size(), 1);
+    QCOMPARE(newer.first().first().toString(), QString("3.0"));
+    QCOMPARE(online.size(), 1);
+}
+
+void VersionCheckerTest::treatsHttpErrorAsOnline()
+{
+    VersionServer server;
+    QVERIFY(server.listen());
+    server.status = 404;
+
+    VersionChecker checker;
+    checker.setUpdateUrl(server.url());
+    checker.setCachePath(cachePath());
+    QSignalSpy online(&checker, &VersionChecker::serverOnline);
+    QSignalSpy offline(&checker, &VersionChecker::serverOffline);
+    checker.check("1.0");
+
+    QVERIFY(online.wait(kSignalTimeoutMs));
+    QCOMPARE(offline.size(), 0);
+}
+
+void VersionCheckerTest::reportsOffline()
+{
+    VersionServer server;
+    QVERIFY(server.listen());
+    const QUrl url = server.url();
+    server.close();  // 端口不再监听：连接被拒绝
+
+    VersionChecker checker;
+    checker.setUpdateUrl(url);
+    checker.setCachePath(cachePath());
+    checker.setTransferTimeout(2000);
+    QSignalSpy offline(&checker, &VersionChecker::serverOffline);
+    QSignalSpy online(&checker, &VersionChecker::serverOnline);
+    checker.check("1.0");
+
+    QVERIFY(offline.wait(kSignalTimeoutMs));
+    QCOMPARE(online.size(), 0);
+}
+
+QTEST_GUILESS_MAIN(VersionCheckerTest)
+#include "tst_versionchecker.moc"
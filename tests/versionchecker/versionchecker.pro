@@ -0,0 +1,16 @@
+# 版本检查：对接本机 QTcpServer 模拟的版本服务器（条件 GET、缓存、离线）
+# VersionChecker 属于图形界面源码（只依赖 QtCore 与 QtNetwork），不经 engine.pri
+QT       = core network testlib
+CONFIG  += c++17 console testcase
+CONFIG  -= app_bundle
+
+TARGET = tst_versionchecker
+
+INCLUDEPATH += $$PWD/../..
+
+SOURCES += \
+    $$PWD/../../versionchecker.cpp \
+    tst_versionchecker.cpp
+
+HEADERS += \
+    $$PWD/../../versionchecker.h
@@ -1,12 +1,28 @@
 #include "versionchecker.h"
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
 #include <QNetworkReply>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QTimer>
 #include <QVersionNumber>
 
 VersionChecker::VersionChecker(QObject *parent) :
     QObject(parent),
     m_networkManager(new QNetworkAccessManager(this)),
-    m_currentVersion()
+    m_currentVersion(),
+    m_updateUrl(QUrl("https://qingfangcomputer.top/cloud/up file/jiyu.txt")),
+    m_cachePath(QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)).filePath("versioncheck.json"))
 {
+    const QByteArray overrideUrl = qgetenv("JIYU_UPDATE_URL");
+    if (!overrideUrl.isEmpty()) {
+        m_updateUrl = QUrl(QString::fromUtf8(overrideUrl));
+    }
 }
 
 VersionChecker::~VersionChecker()
@@ -14,52 +30,151 @@ VersionChecker::~VersionChecker()
     delete m_networkManager;
 }
 
-void VersionChecker::checkForUpdates(const QString &currentVersion)
+void VersionChecker::setUpdateUrl(const QUrl &url)
 {
-    m_currentVersion = QVersionNumber::fromString(currentVersion);
-    QNetworkRequest request(QUrl("https://qingfangcomputer.top/cloud/up file/jiyu.txt"));
-    QNetworkReply *reply = m_networkManager->get(request);
-    connect(reply, &QNetworkReply::finished, this, &VersionChecker::handleNetworkReply);
+    m_updateUrl = url;
+}
+
+void VersionChecker::setCachePath(const QString &path)
+{
+    m_cachePath = path;
+}
+
+void VersionChecker::setCacheTtl(int seconds)
+{
+    m_cacheTtlSecs = seconds;
+}
+
+void VersionChecker::setTransferTimeout(int msecs)
+{
+    m_transferTimeoutMs = msecs;
 }
 
-// 新增：检查服务器可用性
-void VersionChecker::checkServerAvailability()
+void VersionChecker::check(const QString &currentVersion)
 {
-    QNetworkRequest request(QUrl("https://qingfangcomputer.com"));
-    // 设置超时时间
-    request.setTransferTimeout(5000);
-    QNetworkReply *reply = m_networkManager->get(request);
-    connect(reply, &QNetworkReply::finished, this, &VersionChecker::handleServerCheckReply);
+    m_currentVersion = QVersionNumber::fromString(currentVersion);
+    m_state = readCache();
+
+    if (m_state.valid) {
+        // 排队发出，调用方在 check() 之后连接的信号也能收到
+        const CachedState cached = m_state;
+        QTimer::singleShot(0, this, [this, cached]() {
+            emitState(cached, CachedState());
+        });
+        // 离线结果有效期较短，网络恢复后能尽快重新检查
+        const int ttlSecs = m_state.online ? m_cacheTtlSecs : qMin(m_cacheTtlSecs, kOfflineTtlSecs);
+        const qint64 age = QDateTime::currentMSecsSinceEpoch() - m_state.checkedAt;
+        if (age >= 0 && age < qint64(ttlSecs) * 1000) {
+            return;  // 缓存仍在有效期内，不访问网络
+        }
+    }
+
+    if (m_pendingReply) {
+        return;
+    }
+    QNetworkRequest request(m_updateUrl);
+    request.setTransferTimeout(m_transferTimeoutMs);
+    if (!m_state.etag.isEmpty()) {
+        request.setRawHeader("If-None-Match", m_state.etag);
+    }
+    if (!m_state.lastModified.isEmpty()) {
+        request.setRawHeader("If-Modified-Since", m_state.lastModified);
+    }
+    m_pendingReply = m_networkManager->get(request);
+    connect(m_pendingReply, &QNetworkReply::finished, this, &VersionChecker::handleNetworkReply);
 }
 
 void VersionChecker::handleNetworkReply()
 {
     QNetworkReply *reply = qobject_cast<QNetworkReply*>(sender());
-    if (reply && reply->error() == QNetworkReply::NoError) {
-        QByteArray data = reply->readAll();
-        QString version = data.data();
-        QVersionNumber serverVersion = QVersionNumber::fromString(version);
-        if (serverVersion > m_currentVersion) {
-            emit newVersionAvailable(version);
-        } else {
-            emit noUpdatesAvailable();
-        }
-    } else if (reply) {
-        emit noUpdatesAvailable();
+    if (!reply) {
+        return;
     }
+    m_pendingReply = nullptr;
     reply->deleteLater();
+
+    const CachedState previous = m_state;
+    CachedState state = m_state;
+    state.valid = true;
+    state.checkedAt = QDateTime::currentMSecsSinceEpoch();
+
+    const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (reply->error() == QNetworkReply::NoError && status == 304) {
+        // 未修改：服务器在线，版本沿用缓存
+        state.online = true;
+    } else if (reply->error() == QNetworkReply::NoError) {
+        state.online = true;
+        state.version = QString::fromUtf8(reply->readAll()).trimmed();
+        state.etag = reply->rawHeader("ETag");
+        state.lastModified = reply->rawHeader("Last-Modified");
+    } else if (status > 0) {
+        // 有 HTTP 响应（如 404）说明服务器在线，只是版本文件不可用
+        state.online = true;
+    } else {
+        qDebug() << "版本检查失败：" << reply->errorString();
+        state.online = false;
+    }
+
+    m_state = state;
+    writeCache(state);
+    emitState(state, previous);
 }
 
-// 新增：处理服务器检查响应
-void VersionChecker::handleServerCheckReply()
+VersionChecker::CachedState VersionChecker::readCache() const
 {
-    QNetworkReply *reply = qobject_cast<QNetworkReply*>(sender());
-    if (reply) {
-        if (reply->error() == QNetworkReply::NoError) {
+    CachedState state;
+    QFile file(m_cachePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return state;
+    }
+    const QJsonObject object = QJsonDocument::fromJson(file.readAll()).object();
+    if (object.isEmpty()) {
+        return state;
+    }
+    state.valid = true;
+    state.checkedAt = object.value("checkedAt").toInteger();
+    state.online = object.value("online").toBool();
+    state.version = object.value("version").toString();
+    state.etag = object.value("etag").toString().toLatin1();
+    state.lastModified = object.value("lastModified").toString().toLatin1();
+    return state;
+}
+
+void VersionChecker::writeCache(const CachedState &state) const
+{
+    QDir().mkpath(QFileInfo(m_cachePath).absolutePath());
+    QSaveFile file(m_cachePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "无法写入版本检查缓存：" << m_cachePath << file.errorString();
+        return;
+    }
+    QJsonObject object;
+    object.insert("checkedAt", state.checkedAt);
+    object.insert("online", state.online);
+    object.insert("version", state.version);
+    object.insert("etag", QString::fromLatin1(state.etag));
+    object.insert("lastModified", QString::fromLatin1(state.lastModified));
+    file.write(QJsonDocument(object).toJson(QJsonDocument::Compact));
+    file.commit();
+}
+
+void VersionChecker::emitState(const CachedState &state, const CachedState &previous)
+{
+    if (!previous.valid || previous.online != state.online) {
+        if (state.online) {
             emit serverOnline();
         } else {
             emit serverOffline();
         }
-        reply->deleteLater();
+    }
+
+    if (state.version.isEmpty() || (previous.valid && previous.version == state.version)) {
+        return;
+    }
+    const QVersionNumber serverVersion = QVersionNumber::fromString(state.version);
+    if (serverVersion > m_currentVersion) {
+        emit newVersionAvailable(state.version);
+    } else {
+        emit noUpdatesAvailable();
     }
 }
@@ -7,6 +7,9 @@
 #include <QUrl>
 #include <QVersionNumber>
 
+// 版本/服务器可用性检查：一次条件 GET（ETag / If-Modified-Since）同时得出在线状态和最新版本
+// 上次结果缓存在磁盘上：启动时立即按缓存发出信号，超过有效期才在后台刷新，
+// 刷新结果与缓存不同时才再次发出信号
 class VersionChecker : public QObject
 {
     Q_OBJECT
@@ -15,22 +18,53 @@ public:
     explicit VersionChecker(QObject *parent = nullptr);
     ~VersionChecker();
 
-    void checkForUpdates(const QString &currentVersion);
-    void checkServerAvailability(); // 新增：检查服务器可用性
+    // 版本文件地址（默认官方地址，可用环境变量 JIYU_UPDATE_URL 覆盖，便于对接本地测试服务器）
+    void setUpdateUrl(const QUrl &url);
+    QUrl updateUrl() const { return m_updateUrl; }
+    // 缓存文件路径（默认位于系统缓存目录）与有效期
+    void setCachePath(const QString &path);
+    QString cachePath() const { return m_cachePath; }
+    void setCacheTtl(int seconds);
+    void setTransferTimeout(int msecs);
+
+    // 先按缓存应答，缓存过期时再发起网络请求（不会阻塞调用方）
+    void check(const QString &currentVersion);
 
 signals:
     void newVersionAvailable(QString version);
     void noUpdatesAvailable();
-    void serverOnline(); // 新增：服务器在线信号
-    void serverOffline(); // 新增：服务器离线信号
+    void serverOnline(); // 服务器在线信号
+    void serverOffline(); // 服务器离线信号
 
-public slots:
+private slots:
     void handleNetworkReply();
-    void handleServerCheckReply(); // 新增：处理服务器检查响应
 
 private:
+    struct CachedState
+    {
+        bool valid = false;       // 是否有缓存（或本次已得出结果）
+        qint64 checkedAt = 0;     // 上次检查时间（自纪元起的毫秒数）
+        bool online = false;
+        QString version;          // 服务器上的最新版本
+        QByteArray etag;
+        QByteArray lastModified;
+    };
+
+    static const int kOfflineTtlSecs = 10 * 60;
+
     QNetworkAccessManager *m_networkManager;
     QVersionNumber m_currentVersion;
+    QUrl m_updateUrl;
+    QString m_cachePath;
+    int m_cacheTtlSecs = 6 * 60 * 60;
+    int m_transferTimeoutMs = 5000;
+    CachedState m_state;
+    QNetworkReply *m_pendingReply = nullptr;
+
+    CachedState readCache() const;
+    void writeCache(const CachedState &state) const;
+    // 按状态发出信号；previous 有效时只发出发生变化的部分
+    void emitState(const CachedState &state, const CachedState &previous);
 };
 
 #endif // VERSIONCHECKER_H
@@ -0,0 +1,107 @@
+#include "wallpapercache.h"
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QRandomGenerator>
+
+WallpaperLoader::WallpaperLoader(const QString &resourcePath, QObject *parent)
+    : QThread(parent)
+    , m_resourcePath(resourcePath)
+{
+}
+
+void WallpaperLoader::run()
+{
+    QDir dir(m_resourcePath);
+    if (!dir.exists()) {
+        qWarning() << "资源路径不存在：" << m_resourcePath;
+    }
+
+    dir.setNameFilters({"*.jpg", "*.png", "*.bmp", "*.jpeg", "*.gif"});
+    dir.setFilter(QDir::Files | QDir::NoDotAndDotDot);
+    const QFileInfoList fileList = dir.entryInfoList();
+    if (fileList.isEmpty()) {
+        emit failed(QString("未找到背景图片资源，请检查 %1 路径").arg(m_resourcePath));
+        return;
+    }
+
+    const QString selectedImagePath = fileList.at(QRandomGenerator::global()->bounded(fileList.size())).filePath();
+    QImageReader reader(selectedImagePath);
+    reader.setAutoTransform(true);
+    QImage image = reader.read();
+    if (image.isNull()) {
+        emit failed("背景图片加载失败：" + selectedImagePath);
+        return;
+    }
+    // 统一为预乘格式，后续缩放和绘制都走快速路径
+    image.convertTo(image.hasAlphaChannel() ? QImage::Format_ARGB32_Premultiplied : QImage::Format_RGB32);
+    emit loaded(selectedImagePath, image);
+}
+
+WallpaperCache::WallpaperCache(const QString &resourcePath, QObject *parent)
+    : QObject(parent)
+    , m_resourcePath(resourcePath)
+    , m_scaled(kCacheCostKb)
+{
+}
+
+WallpaperCache::~WallpaperCache()
+{
+    if (m_loader) {
+        m_loader->wait();
+    }
+}
+
+void WallpaperCache::load()
+{
+    if (m_loader) {
+        return;
+    }
+    m_loader = new WallpaperLoader(m_resourcePath, this);
+    connect(m_loader, &WallpaperLoader::loaded, this, &WallpaperCache::onLoaded);
+    connect(m_loader, &WallpaperLoader::failed, this, &WallpaperCache::failed);
+    m_loader->start(QThread::LowPriority);
+}
+
+void WallpaperCache::onLoaded(const QString &path, const QImage &image)
+{
+    m_imagePath = path;
+    m_image = image;
+    m_scaled.clear();
+    emit ready();
+}
+
+QPixmap WallpaperCache::pixmap(const QSize &size, Qt::TransformationMode mode)
+{
+    if (m_image.isNull() || size.isEmpty()) {
+        return QPixmap();
+    }
+
+    const QSize bucket = bucketSize(size);
+    if (const QPixmap *smooth = m_scaled.object(cacheKey(bucket, Qt::SmoothTransformation))) {
+        return *smooth;
+    }
+    const quint64 key = cacheKey(bucket, mode);
+    if (const QPixmap *cached = m_scaled.object(key)) {
+        return *cached;
+    }
+
+    auto *scaled = new QPixmap(QPixmap::fromImage(m_image.scaled(bucket, Qt::KeepAspectRatioByExpanding, mode)));
+    const QPixmap result = *scaled;
+    m_scaled.insert(key, scaled, qMax<qsizetype>(1, qsizetype(scaled->width()) * scaled->height() * 4 / 1024));
+    return result;
+}
+
+QSize WallpaperCache::bucketSize(const QSize &size)
+{
+    auto roundUp = [](int value) {
+        return (value + kBucketStep - 1) / kBucketStep * kBucketStep;
+    };
+    return QSize(roundUp(size.width()), roundUp(size.height()));
+}
+
+quint64 WallpaperCache::cacheKey(const QSize &bucket, Qt::TransformationMode mode)
+{
+    return (quint64(quint32(bucket.width())) << 33) | (quint64(quint32(bucket.height())) << 1) | quint64(mode == Qt::SmoothTransformation);
+}
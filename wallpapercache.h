@@ -0,0 +1,71 @@
+#ifndef WALLPAPERCACHE_H
+#define WALLPAPERCACHE_H
+
+#include <QObject>
+#include <QThread>
+#include <QCache>
+#include <QImage>
+#include <QPixmap>
+#include <QSize>
+#include <QString>
+
+// 后台线程：枚举壁纸资源、随机选取一张并解码（整个会话只执行一次）
+class WallpaperLoader : public QThread
+{
+    Q_OBJECT
+
+public:
+    explicit WallpaperLoader(const QString &resourcePath, QObject *parent = nullptr);
+
+signals:
+    void loaded(const QString &path, const QImage &image);
+    void failed(const QString &message);
+
+protected:
+    void run() override;
+
+private:
+    QString m_resourcePath;
+};
+
+// 主窗口背景壁纸缓存：原图只解码一次，缩放结果按尺寸分档放入 LRU 缓存
+// 窗口拖动过程中用快速缩放，停止调整后再用平滑缩放（同一分档只做一次）
+class WallpaperCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit WallpaperCache(const QString &resourcePath = ":/wallpaper/", QObject *parent = nullptr);
+    ~WallpaperCache() override;
+
+    // 启动后台加载（重复调用无效）；完成后发送 ready()
+    void load();
+    bool isReady() const { return !m_image.isNull(); }
+    QString imagePath() const { return m_imagePath; }
+
+    // 返回覆盖 size 的缩放结果（按分档向上取整，可能比窗口略大）；未就绪时返回空图
+    // 请求快速缩放时若该分档已有平滑结果，直接返回平滑结果
+    QPixmap pixmap(const QSize &size, Qt::TransformationMode mode);
+
+signals:
+    void ready();
+    void failed(const QString &message);
+
+private slots:
+    void onLoaded(const QString &path, const QImage &image);
+
+private:
+    static const int kBucketStep = 64;            // 尺寸分档步长（像素）
+    static const int kCacheCostKb = 64 * 1024;    // 缩放结果缓存上限（KB）
+
+    static QSize bucketSize(const QSize &size);
+    static quint64 cacheKey(const QSize &bucket, Qt::TransformationMode mode);
+
+    WallpaperLoader *m_loader = nullptr;
+    QString m_resourcePath;
+    QString m_imagePath;
+    QImage m_image;
+    QCache<quint64, QPixmap> m_scaled;  // (分档宽, 分档高, 缩放方式) -> 缩放结果
+};
+
+#endif // WALLPAPERCACHE_H